@@ -0,0 +1,255 @@
+/**
+ * @file AtEngine.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Event-driven AT command engine for the SIM800L
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "AtEngine.h"
+
+AtEngine::AtEngine(Stream* serial) {
+  this->serial = serial;
+  this->head = 0;
+  this->count = 0;
+  this->state = ST_IDLE;
+  this->deadline = 0;
+  this->gotCmgs = false;
+  this->lastResult = AT_PENDING;
+  this->info[0] = '\0';
+  this->lastError = -1;
+  this->rssi = -1;
+  this->nextHandle = 1;
+  this->smsLatency = 0;
+  this->historyPos = 0;
+  this->smsCallback = nullptr;
+  this->smsCallbackCtx = nullptr;
+  this->urcCallback = nullptr;
+  this->urcCallbackCtx = nullptr;
+
+  for (uint8_t i = 0; i < HISTORY_SIZE; i++) {
+    history[i].handle = 0;
+    history[i].status = SMS_UNKNOWN;
+  }
+}
+
+bool AtEngine::push(const Job& job) {
+  if (count >= QUEUE_SIZE) return false;
+  queue[(head + count) % QUEUE_SIZE] = job;
+  count++;
+  return true;
+}
+
+bool AtEngine::sendCommand(const char* cmd, unsigned long timeout) {
+  Job job;
+  job.type = JOB_COMMAND;
+  job.handle = 0;
+  job.timeout = timeout;
+  job.pduLength = 0;
+  job.number[0] = '\0';
+  strncpy(job.text, cmd, PAYLOAD_MAX);
+  job.text[PAYLOAD_MAX] = '\0';
+  return push(job);
+}
+
+AtResult AtEngine::runCommand(const char* cmd, unsigned long timeout) {
+  while (!isIdle()) poll();
+  if (!sendCommand(cmd, timeout)) return AT_ERROR;
+  do {
+    poll();
+  } while (!isIdle());
+  return lastResult;
+}
+
+SmsHandle AtEngine::sendSMS(const char* number, const char* text) {
+  Job job;
+  job.pduLength = 0;
+  strncpy(job.number, number, NUMBER_MAX - 1);
+  job.number[NUMBER_MAX - 1] = '\0';
+  strncpy(job.text, text, SMS_BODY_MAX);
+  job.text[SMS_BODY_MAX] = '\0';
+  return pushSms(job);
+}
+
+SmsHandle AtEngine::sendPdu(uint8_t tpduLength, const char* hex) {
+  Job job;
+  job.pduLength = tpduLength;
+  job.number[0] = '\0';
+  strncpy(job.text, hex, PAYLOAD_MAX);
+  job.text[PAYLOAD_MAX] = '\0';
+  return pushSms(job);
+}
+
+SmsHandle AtEngine::pushSms(Job& job) {
+  job.type = JOB_SMS;
+  job.handle = nextHandle;
+  job.timeout = SEND_TIMEOUT;
+  job.queuedAt = micros();
+
+  if (!push(job)) return 0;
+
+  nextHandle++;
+  if (nextHandle == 0) nextHandle = 1;
+  return job.handle;
+}
+
+SmsStatus AtEngine::smsStatus(SmsHandle handle) const {
+  if (handle == 0) return SMS_UNKNOWN;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const Job& job = queue[(head + i) % QUEUE_SIZE];
+    if (job.type == JOB_SMS && job.handle == handle) {
+      return (i == 0 && state != ST_IDLE) ? SMS_SENDING : SMS_QUEUED;
+    }
+  }
+  for (uint8_t i = 0; i < HISTORY_SIZE; i++) {
+    if (history[i].handle == handle) return history[i].status;
+  }
+  return SMS_UNKNOWN;
+}
+
+void AtEngine::setSmsCallback(SmsCallback cb, void* ctx) {
+  smsCallback = cb;
+  smsCallbackCtx = ctx;
+}
+
+void AtEngine::setUrcCallback(UrcCallback cb, void* ctx) {
+  urcCallback = cb;
+  urcCallbackCtx = ctx;
+}
+
+bool AtEngine::isIdle() const {
+  return count == 0 && state == ST_IDLE;
+}
+
+void AtEngine::poll() {
+  parser.pump(serial);
+
+  AtResponse response;
+  while (parser.next(response)) {
+    handleResponse(response);
+  }
+
+  if (state != ST_IDLE && (long)(millis() - deadline) >= 0) {
+    if (state == ST_WAIT_PROMPT) {
+      serial->write(27);  // ESC aborts a pending AT+CMGS
+      parser.armPrompt(false);
+    }
+    finishJob(AT_TIMEOUT);
+  }
+
+  if (state == ST_IDLE && count > 0) {
+    startJob();
+  }
+}
+
+void AtEngine::startJob() {
+  Job& job = queue[head];
+  gotCmgs = false;
+  lastResult = AT_PENDING;
+
+  if (job.type == JOB_SMS) {
+    if (job.pduLength > 0) {
+      serial->print("AT+CMGS=");
+      serial->print(job.pduLength);
+      serial->print("\r");
+    } else {
+      serial->print("AT+CMGS=\"");
+      serial->print(job.number);
+      serial->print("\"\r");
+    }
+    parser.armPrompt(true);
+    state = ST_WAIT_PROMPT;
+    deadline = millis() + PROMPT_TIMEOUT;
+  } else {
+    info[0] = '\0';
+    serial->print(job.text);
+    serial->print("\r\n");
+    state = ST_WAIT_RESULT;
+    deadline = millis() + job.timeout;
+  }
+}
+
+void AtEngine::handlePrompt() {
+  Job& job = queue[head];
+  serial->print(job.text);
+  serial->write(26);  // Ctrl+Z to send
+  state = ST_WAIT_CMGS;
+  deadline = millis() + job.timeout;
+}
+
+void AtEngine::handleResponse(const AtResponse& r) {
+  switch (r.code) {
+    case AT_CODE_CMT:
+    case AT_CODE_SMS_BODY:
+    case AT_CODE_CMTI:
+    case AT_CODE_CMGR:
+    case AT_CODE_RING:
+      if (urcCallback) urcCallback(r, urcCallbackCtx);
+      return;
+    case AT_CODE_CSQ:
+      rssi = r.value;
+      break;
+    default:
+      break;
+  }
+
+  if (state == ST_IDLE) return;
+
+  if (r.code == AT_CODE_ERROR || r.code == AT_CODE_CMS_ERROR || r.code == AT_CODE_CME_ERROR) {
+    lastError = r.value;
+    finishJob(AT_ERROR);
+    return;
+  }
+
+  switch (state) {
+    case ST_WAIT_PROMPT:
+      if (r.code == AT_CODE_PROMPT) handlePrompt();
+      break;
+
+    case ST_WAIT_RESULT:
+      if (r.code == AT_CODE_OK) {
+        finishJob(AT_OK);
+      } else {
+        strncpy(info, r.line, INFO_MAX - 1);
+        info[INFO_MAX - 1] = '\0';
+      }
+      break;
+
+    case ST_WAIT_CMGS:
+      if (r.code == AT_CODE_CMGS) {
+        gotCmgs = true;
+      } else if (r.code == AT_CODE_OK && gotCmgs) {
+        finishJob(AT_OK);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void AtEngine::finishJob(AtResult result) {
+  Job& job = queue[head];
+  lastResult = result;
+  state = ST_IDLE;
+
+  if (job.type == JOB_SMS) {
+    SmsStatus status = (result == AT_OK) ? SMS_SENT : SMS_FAILED;
+    history[historyPos].handle = job.handle;
+    history[historyPos].status = status;
+    historyPos = (historyPos + 1) % HISTORY_SIZE;
+    SmsHandle handle = job.handle;
+    smsLatency = micros() - job.queuedAt;
+
+    head = (head + 1) % QUEUE_SIZE;
+    count--;
+    if (smsCallback) smsCallback(handle, status, smsCallbackCtx);
+    return;
+  }
+
+  head = (head + 1) % QUEUE_SIZE;
+  count--;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file AtEngine.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Event-driven AT command engine for the SIM800L
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef AT_ENGINE_H
+#define AT_ENGINE_H
+
+#include <Arduino.h>
+#include "SmsPdu.h"
+#include "AtParser.h"
+
+// Handle returned by AtEngine::sendSMS (0 = not queued)
+typedef uint16_t SmsHandle;
+
+enum SmsStatus : uint8_t {
+  SMS_UNKNOWN = 0,  // Handle never issued or already forgotten
+  SMS_QUEUED,       // Waiting for the modem to become free
+  SMS_SENDING,      // AT+CMGS in progress
+  SMS_SENT,         // Modem answered +CMGS
+  SMS_FAILED        // ERROR, +CMS ERROR or timeout
+};
+
+enum AtResult : uint8_t {
+  AT_PENDING = 0,
+  AT_OK,
+  AT_ERROR,
+  AT_TIMEOUT
+};
+
+typedef void (*SmsCallback)(SmsHandle handle, SmsStatus status, void* ctx);
+// Unsolicited result codes: +CMT (followed by AT_CODE_SMS_BODY), +CMTI, RING.
+// The +CMGR header and body of a stored message read with AT+CMGR come the
+// same way, so one handler decodes pushed and stored messages.
+typedef void (*UrcCallback)(const AtResponse& response, void* ctx);
+
+class AtEngine {
+  public:
+    static const uint8_t QUEUE_SIZE = 4;
+    static const uint16_t SMS_BODY_MAX = 160;
+    static const uint16_t PAYLOAD_MAX = SMS_PDU_HEX_MAX;
+    static const uint8_t NUMBER_MAX = 20;
+    static const uint8_t INFO_MAX = 96;
+    static const uint8_t HISTORY_SIZE = 8;
+
+    static const unsigned long PROMPT_TIMEOUT = 5000;   // AT+CMGS -> '>'
+    static const unsigned long SEND_TIMEOUT = 60000;    // Ctrl+Z -> +CMGS (SIM800 worst case)
+
+    AtEngine(Stream* serial);
+
+    // Drive the engine; call from loop() as often as possible. Never blocks.
+    void poll();
+    bool isIdle() const;
+
+    // Queue a command that only needs OK/ERROR. Returns false if the queue is full.
+    bool sendCommand(const char* cmd, unsigned long timeout = 1000);
+    // Blocking helper for setup code: queues the command and pumps poll() until done.
+    AtResult runCommand(const char* cmd, unsigned long timeout = 1000);
+    // Last informational line (e.g. "+CSQ: 18,0") seen by the most recent command
+    const char* lastInfo() const { return info; }
+    // Error code from the last +CMS/+CME ERROR, -1 for a bare ERROR
+    int16_t lastErrorCode() const { return lastError; }
+    // RSSI from the most recent +CSQ (0-31, 99 = unknown, -1 = never seen)
+    int16_t signalQuality() const { return rssi; }
+
+    // Queue a text-mode SMS. Returns immediately; 0 if the queue is full.
+    SmsHandle sendSMS(const char* number, const char* text);
+    // Queue a PDU-mode SMS (modem must be in AT+CMGF=0). `hex` includes the
+    // SMSC prefix; tpduLength is the value smsEncodePdu returned.
+    SmsHandle sendPdu(uint8_t tpduLength, const char* hex);
+    SmsStatus smsStatus(SmsHandle handle) const;
+    // Jobs that can still be queued (every part of a concatenated SMS is one)
+    uint8_t freeSlots() const { return QUEUE_SIZE - count; }
+    // Microseconds the last finished SMS took from sendSMS()/sendPdu() to its
+    // result, queueing included. Read it from the SMS callback.
+    uint32_t lastSmsLatency() const { return smsLatency; }
+    void setSmsCallback(SmsCallback cb, void* ctx);
+    void setUrcCallback(UrcCallback cb, void* ctx);
+    // Match AT+CMGF: in text mode (with AT+CSDH=1) SMS bodies are read by length
+    void setTextMode(bool enabled) { parser.setTextMode(enabled); }
+
+  private:
+    enum JobType : uint8_t { JOB_COMMAND, JOB_SMS };
+    enum State : uint8_t { ST_IDLE, ST_WAIT_RESULT, ST_WAIT_PROMPT, ST_WAIT_CMGS };
+
+    struct Job {
+      JobType type;
+      SmsHandle handle;
+      unsigned long timeout;
+      uint8_t pduLength;  // 0 for text mode
+      unsigned long queuedAt;  // micros() when an SMS was queued
+      char number[NUMBER_MAX];
+      char text[PAYLOAD_MAX + 1];
+    };
+
+    struct Outcome {
+      SmsHandle handle;
+      SmsStatus status;
+    };
+
+    Stream* serial;
+    Job queue[QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    State state;
+    unsigned long deadline;
+    bool gotCmgs;
+    AtResult lastResult;
+
+    AtParser parser;
+    char info[INFO_MAX];
+    int16_t lastError;
+    int16_t rssi;
+
+    SmsHandle nextHandle;
+    uint32_t smsLatency;
+    Outcome history[HISTORY_SIZE];
+    uint8_t historyPos;
+    SmsCallback smsCallback;
+    void* smsCallbackCtx;
+    UrcCallback urcCallback;
+    void* urcCallbackCtx;
+
+    bool push(const Job& job);
+    SmsHandle pushSms(Job& job);
+    void startJob();
+    void finishJob(AtResult result);
+    void handleResponse(const AtResponse& r);
+    void handlePrompt();
+};
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * @file AtParser.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Zero-allocation streaming parser for SIM800L responses
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "AtParser.h"
+
+struct AtPattern {
+  const char* text;
+  uint8_t len;
+  AtCode code;
+  bool exact;  // Whole line must match (otherwise a prefix)
+};
+
+static const AtPattern PATTERNS[] = {
+  {"OK",          2,  AT_CODE_OK,        true},
+  {"ERROR",       5,  AT_CODE_ERROR,     true},
+  {"+CMS ERROR:", 11, AT_CODE_CMS_ERROR, false},
+  {"+CME ERROR:", 11, AT_CODE_CME_ERROR, false},
+  {"+CMGS:",      6,  AT_CODE_CMGS,      false},
+  {"+CMGR:",      6,  AT_CODE_CMGR,      false},
+  {"+CMT:",       5,  AT_CODE_CMT,       false},
+  {"+CMTI:",      6,  AT_CODE_CMTI,      false},
+  {"+CSQ:",       5,  AT_CODE_CSQ,       false},
+  {"RING",        4,  AT_CODE_RING,      true},
+};
+
+static const uint8_t PATTERN_COUNT = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+static const uint16_t ALL_PATTERNS = (1U << PATTERN_COUNT) - 1;
+
+AtParser::AtParser() {
+  this->overflows = 0;
+  this->promptArmed = false;
+  this->textMode = false;
+  reset();
+}
+
+void AtParser::reset() {
+  ringHead = 0;
+  ringTail = 0;
+  bodyNext = false;
+  inBody = false;
+  bodyLeft = 0;
+  skipSpace = false;
+  startLine();
+}
+
+void AtParser::startLine() {
+  lineLen = 0;
+  column = 0;
+  candidates = ALL_PATTERNS;
+  matched = -1;
+  numbers = 0;
+  values[0] = -1;
+  values[1] = -1;
+  number = 0;
+  lastNumber = -1;
+  inNumber = false;
+  inQuotes = false;
+}
+
+bool AtParser::push(uint8_t c) {
+  if ((uint16_t)(ringHead - ringTail) >= RING_SIZE) {
+    overflows++;
+    return false;
+  }
+  ring[ringHead & (RING_SIZE - 1)] = c;
+  ringHead++;
+  return true;
+}
+
+void AtParser::pump(Stream* serial) {
+  // Leave bytes in the UART FIFO rather than drop them when the ring is full
+  while ((uint16_t)(ringHead - ringTail) < RING_SIZE && serial->available()) {
+    ring[ringHead & (RING_SIZE - 1)] = (uint8_t)serial->read();
+    ringHead++;
+  }
+}
+
+void AtParser::feed(char c) {
+  if (lineLen < LINE_MAX - 1) {
+    line[lineLen++] = c;
+  }
+
+  // Advance every pattern that is still a candidate at this column
+  if (candidates) {
+    uint16_t still = 0;
+    for (uint8_t k = 0; k < PATTERN_COUNT; k++) {
+      uint16_t bit = 1U << k;
+      if (!(candidates & bit)) continue;
+      const AtPattern& p = PATTERNS[k];
+      if (column < p.len && p.text[column] == c) {
+        if (column + 1 == p.len) {
+          matched = k;
+        } else {
+          still |= bit;
+        }
+      }
+    }
+    candidates = still;
+  } else if (matched >= 0 && PATTERNS[matched].exact) {
+    // Trailing text after "OK", "ERROR" or "RING" makes it a plain line
+    matched = -1;
+  } else if (matched >= 0) {
+    // Capture the first two integers and the last one after a prefix,
+    // ignoring quoted fields
+    if (c == '"') {
+      inQuotes = !inQuotes;
+    } else if (!inQuotes && c >= '0' && c <= '9') {
+      if (!inNumber) {
+        number = 0;
+        inNumber = true;
+      }
+      if (number < 3000) number = number * 10 + (c - '0');
+      if (numbers < 2) values[numbers] = number;
+    } else if (inNumber) {
+      inNumber = false;
+      lastNumber = number;
+      numbers++;
+    }
+  }
+
+  column++;
+}
+
+void AtParser::finishLine(AtResponse& out) {
+  line[lineLen] = '\0';
+  out.line = line;
+  out.length = lineLen;
+  out.value = values[0];
+  out.value2 = values[1];
+  if (inNumber) lastNumber = number;
+
+  if (bodyNext) {
+    out.code = AT_CODE_SMS_BODY;
+    bodyNext = false;
+  } else if (matched >= 0) {
+    out.code = PATTERNS[matched].code;
+    if (out.code == AT_CODE_CMT || out.code == AT_CODE_CMGR) {
+      if (textMode && lastNumber >= 0) {
+        // <length> closes the header; the text is read by count, not by line
+        inBody = true;
+        bodyLeft = lastNumber;
+      } else {
+        bodyNext = true;  // PDU, or a text header without AT+CSDH=1
+      }
+    }
+  } else {
+    out.code = AT_CODE_LINE;
+  }
+
+  startLine();
+}
+
+void AtParser::finishBody(AtResponse& out) {
+  line[lineLen] = '\0';
+  out.code = AT_CODE_SMS_BODY;
+  out.value = -1;
+  out.value2 = -1;
+  out.line = line;
+  out.length = lineLen;
+  inBody = false;
+  startLine();
+}
+
+bool AtParser::next(AtResponse& out) {
+  if (inBody && bodyLeft == 0) {
+    finishBody(out);  // Empty message
+    return true;
+  }
+
+  while (ringTail != ringHead) {
+    char c = (char)ring[ringTail & (RING_SIZE - 1)];
+    ringTail++;
+
+    if (inBody) {
+      // Message text, line breaks and all; what does not fit is dropped
+      if (lineLen < LINE_MAX - 1) line[lineLen++] = c;
+      if (--bodyLeft == 0) {
+        finishBody(out);
+        return true;
+      }
+      continue;
+    }
+
+    if (skipSpace) {
+      skipSpace = false;
+      if (c == ' ') continue;
+    }
+
+    if (c == '>' && column == 0 && promptArmed) {
+      promptArmed = false;
+      skipSpace = true;
+      out.code = AT_CODE_PROMPT;
+      out.value = -1;
+      out.value2 = -1;
+      out.line = ">";
+      out.length = 1;
+      return true;
+    }
+
+    if (c == '\r') continue;
+    if (c == '\n') {
+      if (column == 0) continue;  // Blank line between responses
+      finishLine(out);
+      return true;
+    }
+    feed(c);
+  }
+  return false;
+}
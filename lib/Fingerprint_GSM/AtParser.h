@@ -0,0 +1,103 @@
+/**
+ * @file AtParser.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Zero-allocation streaming parser for SIM800L responses
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Bytes from the UART go into a fixed ring buffer; next() turns them into
+ * structured responses one line at a time. All result codes are matched
+ * in a single pass over each line, and nothing touches the heap.
+ *
+ * The text of an SMS is whatever its sender typed, blank lines and "OK"
+ * included, so it is never split into lines. In text mode (AT+CSDH=1) the
+ * +CMT / +CMGR header ends with the body length and exactly that many
+ * characters come back as one AT_CODE_SMS_BODY. In PDU mode the body is a
+ * single line of hex, which cannot hold a line break.
+ */
+#ifndef AT_PARSER_H
+#define AT_PARSER_H
+
+#include <Arduino.h>
+
+enum AtCode : uint8_t {
+  AT_CODE_LINE = 0,     // Any other text line (echo, ...)
+  AT_CODE_OK,
+  AT_CODE_ERROR,
+  AT_CODE_CMS_ERROR,    // value = error code
+  AT_CODE_CME_ERROR,    // value = error code
+  AT_CODE_PROMPT,       // "> " after AT+CMGS (only while armed)
+  AT_CODE_CMGS,         // value = message reference
+  AT_CODE_CMT,          // Pushed SMS header; the body follows as AT_CODE_SMS_BODY
+  AT_CODE_CMTI,         // value = storage index
+  AT_CODE_CMGR,         // Stored SMS header (AT+CMGR); the body follows as AT_CODE_SMS_BODY
+  AT_CODE_CSQ,          // value = RSSI (0-31, 99 unknown), value2 = BER
+  AT_CODE_RING,
+  AT_CODE_SMS_BODY      // Text after +CMT: or +CMGR: (line breaks kept in text mode)
+};
+
+struct AtResponse {
+  AtCode code;
+  int16_t value;
+  int16_t value2;
+  const char* line;     // Valid until the next call to next()
+  uint16_t length;
+};
+
+class AtParser {
+  public:
+    static const uint16_t RING_SIZE = 256;  // Power of two
+    static const uint16_t LINE_MAX = 360;   // Fits a PDU-mode +CMT body in hex
+
+    AtParser();
+
+    // Move everything the UART has buffered into the ring
+    void pump(Stream* serial);
+    // Or push bytes one at a time (tests, other transports)
+    bool push(uint8_t c);
+
+    // Parse buffered bytes; true when `out` holds a complete response
+    bool next(AtResponse& out);
+
+    // Report a '>' at the start of a line as AT_CODE_PROMPT
+    void armPrompt(bool armed) { promptArmed = armed; }
+    // Text mode: SMS headers end with the body length (needs AT+CSDH=1)
+    void setTextMode(bool enabled) { textMode = enabled; }
+    void reset();
+
+    uint16_t buffered() const { return (uint16_t)(ringHead - ringTail); }
+    uint32_t overflowCount() const { return overflows; }
+
+  private:
+    uint8_t ring[RING_SIZE];
+    uint16_t ringHead;  // Write position (free-running)
+    uint16_t ringTail;  // Read position (free-running)
+    uint32_t overflows;
+
+    char line[LINE_MAX];
+    uint16_t lineLen;
+    uint16_t column;        // Characters seen on this line (may exceed LINE_MAX)
+    uint16_t candidates;    // Patterns still matching at this column
+    int8_t matched;         // Longest pattern fully matched so far, -1 none
+    uint8_t numbers;        // Integers captured after the matched prefix
+    int16_t values[2];
+    int16_t number;         // Integer being read
+    int16_t lastNumber;     // Last integer on the line, -1 none
+    bool inNumber;
+    bool inQuotes;
+    bool promptArmed;
+    bool textMode;
+    bool bodyNext;          // PDU mode: the next line is the body
+    bool inBody;            // Text mode: bodyLeft characters of SMS text to come
+    uint16_t bodyLeft;
+    bool skipSpace;
+
+    void startLine();
+    void feed(char c);
+    void finishLine(AtResponse& out);
+    void finishBody(AtResponse& out);
+};
+
+#endif
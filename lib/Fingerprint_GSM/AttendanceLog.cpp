@@ -0,0 +1,273 @@
+/**
+ * @file AttendanceLog.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Append-only binary attendance log in a dedicated flash partition
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "AttendanceLog.h"
+
+static const uint32_t LOG_MAGIC = 0x474C5441;  // "ATLG"
+static const uint8_t ATTLOG_SUBTYPE = 0x40;
+
+AttendanceLog::AttendanceLog() {
+  this->partition = nullptr;
+  this->sectors = 0;
+  this->usedSectors = 0;
+  this->oldest = 0;
+  this->head = 0;
+  this->headFill = 0;
+  this->headSeq = 0;
+  this->sectorFirst = nullptr;
+  this->stageHead = 0;
+  this->staged = 0;
+  this->dropped = 0;
+  memset(this->headUsers, 0xFF, sizeof(this->headUsers));
+}
+
+AttendanceLog::~AttendanceLog() {
+  delete[] sectorFirst;
+}
+
+uint8_t AttendanceLog::checkByte(const AccessLog& record) {
+  const uint8_t* b = (const uint8_t*)&record;
+  uint8_t x = 0x5A;
+  for (uint8_t i = 0; i < sizeof(AccessLog) - 1; i++) x ^= b[i];
+  return x;
+}
+
+bool AttendanceLog::begin(const char* label) {
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)ATTLOG_SUBTYPE, label);
+  if (partition == nullptr) {
+    Serial.println("[LOG] ERROR: Attendance log partition not found");
+    return false;
+  }
+
+  sectors = partition->size / SECTOR_SIZE;
+  sectorFirst = new uint32_t[sectors];
+
+  // The sector with the lowest sequence number is the oldest, the highest is the head
+  uint32_t lowSeq = 0xFFFFFFFF;
+  usedSectors = 0;
+  headSeq = 0;
+  for (uint16_t s = 0; s < sectors; s++) {
+    SectorHeader header;
+    esp_partition_read(partition, (uint32_t)s * SECTOR_SIZE, &header, sizeof(header));
+    sectorFirst[s] = 0xFFFFFFFF;
+    if (header.magic != LOG_MAGIC) continue;
+
+    esp_partition_read(partition, (uint32_t)s * SECTOR_SIZE + HEADER_SIZE, &sectorFirst[s], sizeof(uint32_t));
+    usedSectors++;
+    if (header.seq < lowSeq) {
+      lowSeq = header.seq;
+      oldest = s;
+    }
+    if (header.seq >= headSeq) {
+      headSeq = header.seq;
+      head = s;
+      memcpy(headUsers, header.users, sizeof(headUsers));
+    }
+  }
+
+  if (usedSectors == 0) {
+    headFill = 0;
+    Serial.println("[LOG] Attendance log is empty");
+    return true;
+  }
+
+  // Records are written in order, so the first erased slot is found by bisection
+  uint16_t lo = 0;
+  uint16_t hi = RECORDS_PER_SECTOR;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    AccessLog record;
+    esp_partition_read(partition, (uint32_t)head * SECTOR_SIZE + HEADER_SIZE + mid * sizeof(AccessLog),
+                       &record, sizeof(record));
+    const uint8_t* b = (const uint8_t*)&record;
+    bool erased = true;
+    for (uint8_t i = 0; i < sizeof(record); i++) erased &= (b[i] == 0xFF);
+    if (erased) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  headFill = lo;
+
+  Serial.print("[LOG] Attendance log: ");
+  Serial.print(flashCount());
+  Serial.print(" records in ");
+  Serial.print(usedSectors);
+  Serial.print("/");
+  Serial.print(sectors);
+  Serial.println(" sectors");
+  return true;
+}
+
+uint32_t AttendanceLog::flashCount() const {
+  if (usedSectors == 0) return 0;
+  return (uint32_t)(usedSectors - 1) * RECORDS_PER_SECTOR + headFill;
+}
+
+uint32_t AttendanceLog::offsetOf(uint32_t index) const {
+  uint16_t sector = physical(index / RECORDS_PER_SECTOR);
+  return (uint32_t)sector * SECTOR_SIZE + HEADER_SIZE + (index % RECORDS_PER_SECTOR) * sizeof(AccessLog);
+}
+
+bool AttendanceLog::append(uint32_t epoch, uint16_t userId, uint8_t flags) {
+  if (staged >= STAGE_SIZE) {
+    dropped++;
+    return false;
+  }
+  AccessLog& record = stage[(uint8_t)(stageHead + staged) % STAGE_SIZE];
+  record.epoch = epoch;
+  record.userId = userId;
+  record.flags = flags;
+  record.check = checkByte(record);
+  staged++;
+  return true;
+}
+
+bool AttendanceLog::openSector() {
+  uint16_t next = usedSectors == 0 ? 0 : (head + 1) % sectors;
+
+  // Reusing the oldest sector drops its records from the front of the log
+  if (usedSectors == sectors) {
+    oldest = (oldest + 1) % sectors;
+    usedSectors--;
+  }
+  if (esp_partition_erase_range(partition, (uint32_t)next * SECTOR_SIZE, SECTOR_SIZE) != ESP_OK) {
+    return false;
+  }
+
+  SectorHeader header;
+  memset(&header, 0xFF, sizeof(header));
+  header.magic = LOG_MAGIC;
+  header.seq = usedSectors == 0 ? 1 : headSeq + 1;
+  if (esp_partition_write(partition, (uint32_t)next * SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) {
+    return false;
+  }
+
+  if (usedSectors == 0) oldest = next;
+  head = next;
+  headSeq = header.seq;
+  headFill = 0;
+  memset(headUsers, 0xFF, sizeof(headUsers));
+  sectorFirst[head] = 0xFFFFFFFF;
+  usedSectors++;
+  return true;
+}
+
+bool AttendanceLog::writeRecord(const AccessLog& record) {
+  if (usedSectors == 0 || headFill >= RECORDS_PER_SECTOR) {
+    if (!openSector()) return false;
+  }
+
+  uint32_t base = (uint32_t)head * SECTOR_SIZE;
+  if (esp_partition_write(partition, base + HEADER_SIZE + headFill * sizeof(AccessLog),
+                          &record, sizeof(record)) != ESP_OK) {
+    return false;
+  }
+  if (headFill == 0) sectorFirst[head] = record.epoch;
+  headFill++;
+
+  // Flash bits can be cleared without an erase, so the header bitmap grows in place
+  uint16_t bit = userBit(record.userId);
+  uint16_t byte = bit >> 3;
+  uint8_t mask = 1 << (bit & 7);
+  if (headUsers[byte] & mask) {
+    headUsers[byte] &= ~mask;
+    esp_partition_write(partition, base + offsetof(SectorHeader, users) + byte, &headUsers[byte], 1);
+  }
+  return true;
+}
+
+void AttendanceLog::poll() {
+  if (partition == nullptr) return;
+  while (staged > 0) {
+    if (!writeRecord(stage[stageHead])) return;  // Keep it staged and retry next time
+    stageHead = (stageHead + 1) % STAGE_SIZE;
+    staged--;
+  }
+}
+
+bool AttendanceLog::read(uint32_t index, AccessLog& record) {
+  uint32_t inFlash = flashCount();
+  if (index < inFlash) {
+    if (esp_partition_read(partition, offsetOf(index), &record, sizeof(record)) != ESP_OK) return false;
+  } else if (index - inFlash < staged) {
+    record = stage[(uint8_t)(stageHead + (index - inFlash)) % STAGE_SIZE];
+  } else {
+    return false;
+  }
+  return record.check == checkByte(record);
+}
+
+uint32_t AttendanceLog::epochAt(uint32_t index) {
+  AccessLog record;
+  read(index, record);
+  return record.epoch;
+}
+
+uint32_t AttendanceLog::seek(uint32_t epoch) {
+  // Sparse index first: the answer is in the last sector that starts before `epoch`
+  uint16_t lo = 0;
+  uint16_t hi = usedSectors;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (sectorFirst[physical(mid)] < epoch) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  // Then the records of that sector (and the RAM stage after the head)
+  uint32_t first = lo == 0 ? 0 : (uint32_t)(lo - 1) * RECORDS_PER_SECTOR;
+  uint32_t last = lo >= usedSectors ? count() : (uint32_t)lo * RECORDS_PER_SECTOR;
+  while (first < last) {
+    uint32_t mid = first + (last - first) / 2;
+    if (epochAt(mid) < epoch) {
+      first = mid + 1;
+    } else {
+      last = mid;
+    }
+  }
+  return first;
+}
+
+uint32_t AttendanceLog::findDay(uint32_t day, uint32_t* first) {
+  *first = seek(day * 86400UL);
+  return seek((day + 1) * 86400UL) - *first;
+}
+
+uint32_t AttendanceLog::findUser(uint16_t userId, uint32_t from, uint32_t end, AccessLog& record) {
+  uint16_t bit = userBit(userId);
+  uint16_t byte = bit >> 3;
+  uint8_t mask = 1 << (bit & 7);
+  uint32_t inFlash = flashCount();
+  if (end > count()) end = count();
+
+  uint32_t i = from;
+  while (i < end) {
+    if (i < inFlash && (i == from || i % RECORDS_PER_SECTOR == 0)) {
+      // Check the user's byte of the sector bitmap before reading its records
+      uint16_t sector = physical(i / RECORDS_PER_SECTOR);
+      uint8_t users = headUsers[byte];
+      if (sector != head) {
+        esp_partition_read(partition, (uint32_t)sector * SECTOR_SIZE + offsetof(SectorHeader, users) + byte,
+                           &users, 1);
+      }
+      if (users & mask) {
+        i = (i / RECORDS_PER_SECTOR + 1) * RECORDS_PER_SECTOR;
+        continue;
+      }
+    }
+    if (read(i, record) && record.userId == userId) return i;
+    i++;
+  }
+  return NOT_FOUND;
+}
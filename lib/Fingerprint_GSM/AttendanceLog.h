@@ -0,0 +1,106 @@
+/**
+ * @file AttendanceLog.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Append-only binary attendance log in a dedicated flash partition
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The "attlog" partition is a ring of 4 KB sectors. Each sector has a header
+ * (magic, sequence number, a bitmap of the user IDs in it) followed by fixed
+ * 8-byte AccessLog records in time order. Sectors are reused strictly
+ * round-robin, so every sector is erased equally often. append() only copies into RAM;
+ * poll() writes staged records to flash.
+ *
+ * A RAM table of each sector's first epoch is the sparse index: finding a
+ * date is a binary search over sectors, then over records in one sector.
+ * Finding a user reads one bitmap byte per sector and only the records of
+ * sectors that hold the user. IDs 1..2047 have a bit each, so a sector full
+ * of different students still rules out everyone else.
+ */
+#ifndef ATTENDANCE_LOG_H
+#define ATTENDANCE_LOG_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#define ACCESS_GRANTED 0x01
+
+// One attendance event, stored as-is in flash
+struct AccessLog {
+  uint32_t epoch;   // RTC unixtime (local time)
+  uint16_t userId;
+  uint8_t flags;    // ACCESS_GRANTED
+  uint8_t check;    // Detects a record torn by a power cut
+};
+
+class AttendanceLog {
+  public:
+    static const uint16_t SECTOR_SIZE = 4096;
+    static const uint16_t USER_BITS = 2048;  // Bitmap bits; larger IDs share them
+    static const uint16_t HEADER_SIZE = 272;
+    static const uint16_t RECORDS_PER_SECTOR = (SECTOR_SIZE - HEADER_SIZE) / sizeof(AccessLog);
+    static const uint8_t STAGE_SIZE = 64;   // Records held in RAM between polls
+    static const uint32_t NOT_FOUND = 0xFFFFFFFF;
+
+    AttendanceLog();
+    ~AttendanceLog();
+
+    // Find the partition and recover the write position
+    bool begin(const char* label = "attlog");
+
+    // Stage one record in RAM (no flash access). False when the stage is full.
+    bool append(uint32_t epoch, uint16_t userId, uint8_t flags);
+    // Write staged records to flash
+    void poll();
+
+    // Records are numbered from 0 (oldest still in flash) to count() - 1
+    uint32_t count() const { return flashCount() + staged; }
+    bool read(uint32_t index, AccessLog& record);
+    // Index of the first record at or after `epoch`, count() if none
+    uint32_t seek(uint32_t epoch);
+    // Records of one day (epoch / 86400); returns how many, `first` gets the index
+    uint32_t findDay(uint32_t day, uint32_t* first);
+    // Next record of `userId` in [from, end), NOT_FOUND if none. Sectors whose
+    // user bitmap rules the user out are skipped without reading their records.
+    uint32_t findUser(uint16_t userId, uint32_t from, uint32_t end, AccessLog& record);
+
+    uint32_t droppedCount() const { return dropped; }
+    uint8_t stagedCount() const { return staged; }  // Waiting for poll()
+    uint16_t sectorCount() const { return sectors; }
+
+  private:
+    struct SectorHeader {
+      uint32_t magic;
+      uint32_t seq;
+      uint8_t users[USER_BITS / 8];  // Bit cleared (never set) when a user is added
+      uint8_t reserved[8];
+    };
+
+    const esp_partition_t* partition;
+    uint16_t sectors;
+    uint16_t usedSectors;
+    uint16_t oldest;         // Physical sector holding record 0
+    uint16_t head;           // Physical sector being filled
+    uint16_t headFill;       // Records already in the head sector
+    uint32_t headSeq;
+    uint8_t headUsers[USER_BITS / 8];
+    uint32_t* sectorFirst;   // Epoch of each sector's first record (sparse index)
+
+    AccessLog stage[STAGE_SIZE];
+    uint8_t stageHead;
+    uint8_t staged;
+    uint32_t dropped;
+
+    uint32_t flashCount() const;
+    uint32_t offsetOf(uint32_t index) const;
+    uint16_t physical(uint16_t logicalSector) const { return (oldest + logicalSector) % sectors; }
+    uint32_t epochAt(uint32_t index);
+    bool openSector();
+    bool writeRecord(const AccessLog& record);
+    static uint8_t checkByte(const AccessLog& record);
+    static uint16_t userBit(uint16_t userId) { return userId & (USER_BITS - 1); }
+};
+
+#endif
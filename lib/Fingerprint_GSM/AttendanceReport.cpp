@@ -0,0 +1,253 @@
+/**
+ * @file AttendanceReport.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Daily absentee and late-arrival summary per grade, sent by SMS
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "AttendanceReport.h"
+
+// Room kept at the end of a message for " +nnn more\n"
+static const uint8_t MORE_RESERVE = 12;
+
+AttendanceReport::AttendanceReport(PresenceIndex* presence, SmsOutbox* outbox, UserLookup lookup, void* ctx) {
+  this->presence = presence;
+  this->outbox = outbox;
+  this->lookup = lookup;
+  this->ctx = ctx;
+  this->cutoffMinute = 9 * 60;  // 09:00
+  this->lateMinute = 7 * 60 + 30;  // 07:30
+  this->recipientCount = 0;
+  this->state = IDLE;
+  this->day = 0;
+  this->lastDay = 0;
+  this->cursor = 0;
+  this->gradeCount = 0;
+  this->composed = false;
+  this->absentBits = new uint32_t[presence->words()];
+  this->nextId = new uint16_t[presence->words() * 32];
+}
+
+AttendanceReport::~AttendanceReport() {
+  delete[] absentBits;
+  delete[] nextId;
+}
+
+bool AttendanceReport::begin() {
+  if (!prefs.begin("report", false)) {
+    Serial.println("[REPORT] ERROR: Cannot open report state");
+    return false;
+  }
+  lastDay = prefs.getUInt("day", 0);
+  return true;
+}
+
+void AttendanceReport::setCutoff(uint8_t hour, uint8_t minute) {
+  cutoffMinute = hour * 60 + minute;
+}
+
+void AttendanceReport::setLateTime(uint8_t hour, uint8_t minute) {
+  lateMinute = hour * 60 + minute;
+}
+
+bool AttendanceReport::addRecipient(const char* number, const char* grade) {
+  if (recipientCount >= MAX_RECIPIENTS) return false;
+
+  Recipient& recipient = recipients[recipientCount++];
+  strncpy(recipient.number, number, sizeof(recipient.number) - 1);
+  recipient.number[sizeof(recipient.number) - 1] = '\0';
+  strncpy(recipient.grade, grade != nullptr ? grade : "", sizeof(recipient.grade) - 1);
+  recipient.grade[sizeof(recipient.grade) - 1] = '\0';
+  return true;
+}
+
+void AttendanceReport::start(uint32_t day) {
+  this->day = day;
+  presence->absent(day, absentBits);
+  gradeCount = 0;
+  strcpy(grades[OTHER].name, "Other");
+  resetRow(grades[OTHER]);
+  cursor = 0;
+  composed = false;
+  state = COUNTING;
+}
+
+void AttendanceReport::runNow(uint32_t epoch) {
+  if (state == IDLE) start(epoch / 86400UL);
+}
+
+// Row of a grade already in the table, OTHER if it is not
+uint8_t AttendanceReport::findGrade(const char* grade) const {
+  for (uint8_t g = 0; g < gradeCount; g++) {
+    if (strcmp(grades[g].name, grade) == 0) return g;
+  }
+  return OTHER;
+}
+
+uint8_t AttendanceReport::tally(const char* grade) {
+  uint8_t g = findGrade(grade);
+  // Grades beyond the table are lumped into the "Other" row
+  if (g != OTHER || gradeCount == MAX_GRADES) return g;
+
+  GradeTally& row = grades[gradeCount];
+  strncpy(row.name, grade, sizeof(row.name) - 1);
+  row.name[sizeof(row.name) - 1] = '\0';
+  resetRow(row);
+  return gradeCount++;
+}
+
+void AttendanceReport::resetRow(GradeTally& row) {
+  row.enrolled = 0;
+  row.absent = 0;
+  row.late = 0;
+  row.absentHead = row.absentTail = 0;
+  row.lateHead = row.lateTail = 0;
+}
+
+// IDs arrive in increasing order, so each list stays sorted
+void AttendanceReport::addToList(uint16_t& head, uint16_t& tail, uint16_t id) {
+  nextId[id] = 0;
+  if (head == 0) {
+    head = id;
+  } else {
+    nextId[tail] = id;
+  }
+  tail = id;
+}
+
+void AttendanceReport::countWord(uint16_t word) {
+  for (uint32_t bits = presence->roster()[word]; bits != 0; bits &= bits - 1) {
+    uint16_t id = word * 32 + __builtin_ctz(bits);
+    uint32_t mask = 1UL << (id & 31);
+    const char* name;
+    const char* grade;
+    if (!lookup(id, &name, &grade, ctx)) continue;
+
+    GradeTally& row = grades[tally(grade != nullptr ? grade : "")];
+    row.enrolled++;
+    if (absentBits[word] & mask) {
+      row.absent++;
+      addToList(row.absentHead, row.absentTail, id);
+      continue;
+    }
+
+    uint16_t first;
+    uint16_t last;
+    if (presence->minutes(id, day, &first, &last) && first > lateMinute) {
+      row.late++;
+      addToList(row.lateHead, row.lateTail, id);
+    }
+  }
+}
+
+uint16_t AttendanceReport::appendNames(uint16_t len, const char* label, uint16_t id, uint16_t total, bool late) {
+  uint16_t limit = sizeof(message) - MORE_RESERVE;
+  uint16_t listed = 0;
+  uint16_t more = 0;
+
+  for (uint16_t seen = 0; id != 0; id = nextId[id], seen++) {
+    const char* name;
+    const char* grade;
+    if (!lookup(id, &name, &grade, ctx)) continue;
+
+    char entry[48];
+    uint16_t first;
+    uint16_t last;
+    if (late && presence->minutes(id, day, &first, &last)) {
+      snprintf(entry, sizeof(entry), "%s%s %02u:%02u", listed == 0 ? label : ", ", name,
+               first / 60, first % 60);
+    } else {
+      snprintf(entry, sizeof(entry), "%s%s", listed == 0 ? label : ", ", name);
+    }
+
+    uint16_t n = strlen(entry);
+    if (len + n >= limit) {
+      // The rest are only counted; their names are never read
+      more = total - seen;
+      break;
+    }
+    memcpy(message + len, entry, n);
+    len += n;
+    listed++;
+  }
+
+  if (more > 0) len += snprintf(message + len, sizeof(message) - len, " +%u more", more);
+  if (listed > 0 || more > 0) message[len++] = '\n';
+  message[len] = '\0';
+  return len;
+}
+
+uint16_t AttendanceReport::compose(const Recipient& recipient) {
+  DateTime date(day * 86400UL);
+  uint16_t len = snprintf(message, sizeof(message), "Attendance %02u/%02u\n", date.month(), date.day());
+  bool any = false;
+
+  for (uint8_t g = 0; g <= OTHER; g++) {
+    if (g == gradeCount) g = OTHER;
+    const GradeTally& row = grades[g];
+    if (row.enrolled == 0) continue;
+    if (recipient.grade[0] != '\0' && findGrade(recipient.grade) != g) continue;
+    any = true;
+
+    if ((size_t)len + 40 < sizeof(message) - MORE_RESERVE) {
+      len += snprintf(message + len, sizeof(message) - len, "%s: %u/%u in, %u late\n",
+                      row.name[0] != '\0' ? row.name : "No grade",
+                      row.enrolled - row.absent, row.enrolled, row.late);
+    }
+    len = appendNames(len, "Absent: ", row.absentHead, row.absent, false);
+    len = appendNames(len, "Late: ", row.lateHead, row.late, true);
+  }
+
+  if (!any) return 0;
+  if (len > 0 && message[len - 1] == '\n') message[--len] = '\0';
+  return len;
+}
+
+void AttendanceReport::poll(uint32_t epoch) {
+  switch (state) {
+    case IDLE: {
+      uint32_t today = epoch / 86400UL;
+      if (epoch == 0 || today == lastDay || (epoch % 86400UL) / 60 < cutoffMinute) return;
+      start(today);
+      return;
+    }
+
+    case COUNTING:
+      // One roster word (32 IDs) per call
+      countWord(cursor++);
+      if (cursor >= presence->words()) {
+        cursor = 0;
+        state = SENDING;
+      }
+      return;
+
+    case SENDING:
+      // One recipient per call
+      if (cursor < recipientCount) {
+        const Recipient& recipient = recipients[cursor];
+        if (!composed) {
+          if (compose(recipient) == 0) {
+            cursor++;
+            return;
+          }
+          composed = true;
+        }
+        // A full outbox keeps this recipient pending; try again on a later call
+        if (outbox->size() >= outbox->capacity() || !outbox->append(recipient.number, message)) return;
+        composed = false;
+        cursor++;
+        return;
+      }
+
+      Serial.print("[REPORT] Daily report queued for ");
+      Serial.print(recipientCount);
+      Serial.println(" recipient(s)");
+      lastDay = day;
+      prefs.putUInt("day", lastDay);
+      state = IDLE;
+      return;
+  }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file AttendanceReport.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Daily absentee and late-arrival summary per grade, sent by SMS
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Once a day, at the cut-off time, every recipient gets one SMS with the
+ * head count of each grade followed by who is absent and who came after the
+ * late time. The work is spread over poll() calls (one roster word, then one
+ * recipient per call) so the scan loop never waits on it. Counting also
+ * threads each absent or late ID onto a list for its grade, so a message
+ * only looks up the names it prints. A recipient whose message does not
+ * fit in the outbox stays pending, and the day is only marked sent once
+ * every recipient's message is queued.
+ */
+#ifndef ATTENDANCE_REPORT_H
+#define ATTENDANCE_REPORT_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <RTClib.h>
+#include "PresenceIndex.h"
+#include "SmsOutbox.h"
+
+class AttendanceReport {
+  public:
+    static const uint8_t MAX_RECIPIENTS = 4;
+    static const uint8_t MAX_GRADES = 8;
+    static const uint8_t OTHER = MAX_GRADES;  // Row for students of any grade beyond the table
+    static const uint8_t GRADE_MAX = 16;
+
+    // Fills in the name and grade of a registered ID; false if there is none
+    typedef bool (*UserLookup)(uint16_t id, const char** name, const char** grade, void* ctx);
+
+    AttendanceReport(PresenceIndex* presence, SmsOutbox* outbox, UserLookup lookup, void* ctx);
+    ~AttendanceReport();
+
+    // Load the day of the last report, so a reboot does not send it again
+    bool begin();
+
+    // The report goes out at cut-off; first scans after `late` count as late
+    void setCutoff(uint8_t hour, uint8_t minute);
+    void setLateTime(uint8_t hour, uint8_t minute);
+    // grade == nullptr (or "") means every grade
+    bool addRecipient(const char* number, const char* grade = nullptr);
+
+    // `epoch` is the local RTC time. Does a small, bounded step of work.
+    void poll(uint32_t epoch);
+    // Build and send today's report now, regardless of the cut-off
+    void runNow(uint32_t epoch);
+    bool busy() const { return state != IDLE; }
+
+  private:
+    enum State { IDLE, COUNTING, SENDING };
+
+    struct Recipient {
+      char number[AtEngine::NUMBER_MAX];
+      char grade[GRADE_MAX];
+    };
+
+    struct GradeTally {
+      char name[GRADE_MAX];
+      uint16_t enrolled;
+      uint16_t absent;
+      uint16_t late;
+      uint16_t absentHead, absentTail;  // ID lists through nextId, 0 = empty
+      uint16_t lateHead, lateTail;
+    };
+
+    PresenceIndex* presence;
+    SmsOutbox* outbox;
+    UserLookup lookup;
+    void* ctx;
+    Preferences prefs;
+
+    uint16_t cutoffMinute;
+    uint16_t lateMinute;
+    Recipient recipients[MAX_RECIPIENTS];
+    uint8_t recipientCount;
+
+    State state;
+    uint32_t day;            // Day being reported
+    uint32_t lastDay;        // Day of the last report sent
+    uint16_t cursor;         // Roster word (COUNTING) or recipient (SENDING)
+    uint32_t* absentBits;
+    uint16_t* nextId;        // Next ID on the same grade list, 0 = last
+    GradeTally grades[MAX_GRADES + 1];  // grades[OTHER] is "Other"
+    uint8_t gradeCount;
+    char message[OUTBOX_TEXT_MAX + 1];
+    bool composed;           // message holds recipients[cursor]'s report
+
+    void start(uint32_t day);
+    void countWord(uint16_t word);
+    uint8_t findGrade(const char* grade) const;
+    uint8_t tally(const char* grade);
+    void resetRow(GradeTally& row);
+    void addToList(uint16_t& head, uint16_t& tail, uint16_t id);
+    uint16_t compose(const Recipient& recipient);
+    uint16_t appendNames(uint16_t len, const char* label, uint16_t id, uint16_t total, bool late);
+};
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file AttendanceState.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Per-user in/out state and scan cooldown, indexed by fingerprint ID
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "AttendanceState.h"
+
+AttendanceState::AttendanceState(uint16_t maxIds) {
+  this->maxIds = maxIds;
+  this->cooldownMs = 10000;
+  this->entries = new Entry[maxIds];
+  reset();
+}
+
+AttendanceState::~AttendanceState() {
+  delete[] entries;
+}
+
+void AttendanceState::reset() {
+  for (uint16_t i = 0; i < maxIds; i++) {
+    entries[i].lastEvent = 0;
+    entries[i].flags = 0;
+  }
+}
+
+ScanDecision AttendanceState::decide(uint16_t id, unsigned long now) {
+  if (id >= maxIds) return SCAN_DUPLICATE;
+
+  Entry& entry = entries[id];
+  if ((entry.flags & FLAG_SEEN) && now - entry.lastEvent < cooldownMs) {
+    return SCAN_DUPLICATE;
+  }
+
+  entry.lastEvent = now;
+  entry.flags = (entry.flags ^ FLAG_IN) | FLAG_SEEN;
+  return (entry.flags & FLAG_IN) ? SCAN_CHECK_IN : SCAN_CHECK_OUT;
+}
+
+bool AttendanceState::isIn(uint16_t id) const {
+  return id < maxIds && (entries[id].flags & FLAG_IN);
+}
@@ -0,0 +1,55 @@
+/**
+ * @file AttendanceState.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Per-user in/out state and scan cooldown, indexed by fingerprint ID
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Every scan is classified with one table lookup: a check-in, a check-out,
+ * or a duplicate of the same user's last event within the cooldown. Users
+ * have their own entries, so one student's scan never suppresses another's.
+ */
+#ifndef ATTENDANCE_STATE_H
+#define ATTENDANCE_STATE_H
+
+#include <Arduino.h>
+
+enum ScanDecision {
+  SCAN_DUPLICATE,   // Same user again within the cooldown: do nothing
+  SCAN_CHECK_IN,
+  SCAN_CHECK_OUT
+};
+
+class AttendanceState {
+  public:
+    // IDs 0..maxIds-1 are tracked
+    AttendanceState(uint16_t maxIds = 128);
+    ~AttendanceState();
+
+    // Minimum time between two events of the same user
+    void setCooldown(unsigned long ms) { cooldownMs = ms; }
+
+    // Classify a scan of `id` at `now` (millis) and record it
+    ScanDecision decide(uint16_t id, unsigned long now);
+
+    bool isIn(uint16_t id) const;
+    // Start a new day: everyone is out, cooldowns are cleared
+    void reset();
+
+  private:
+    static const uint8_t FLAG_SEEN = 0x01;
+    static const uint8_t FLAG_IN = 0x02;
+
+    struct Entry {
+      unsigned long lastEvent;
+      uint8_t flags;
+    };
+
+    Entry* entries;
+    uint16_t maxIds;
+    unsigned long cooldownMs;
+};
+
+#endif
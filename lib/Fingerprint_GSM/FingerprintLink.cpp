@@ -0,0 +1,167 @@
+/**
+ * @file FingerprintLink.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Raw R30x/AS608 packet layer for template transfer and ranged search
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "FingerprintLink.h"
+
+// Instruction codes not exposed by Adafruit_Fingerprint
+#define FP_CMD_MATCH     0x03
+#define FP_CMD_UPCHAR    0x08
+#define FP_CMD_DOWNCHAR  0x09
+
+FingerprintLink::FingerprintLink(Stream* serial, uint32_t address) {
+  this->serial = serial;
+  this->address = address;
+  this->packetSize = 128;
+}
+
+void FingerprintLink::writePacket(uint8_t type, const uint8_t* data, uint16_t length) {
+  uint8_t header[9] = {
+    (uint8_t)(FINGERPRINT_STARTCODE >> 8), (uint8_t)(FINGERPRINT_STARTCODE & 0xFF),
+    (uint8_t)(address >> 24), (uint8_t)(address >> 16), (uint8_t)(address >> 8), (uint8_t)address,
+    type, (uint8_t)((length + 2) >> 8), (uint8_t)((length + 2) & 0xFF)
+  };
+  serial->write(header, sizeof(header));
+  serial->write(data, length);
+
+  uint16_t sum = type + header[7] + header[8];
+  for (uint16_t i = 0; i < length; i++) sum += data[i];
+  serial->write((uint8_t)(sum >> 8));
+  serial->write((uint8_t)(sum & 0xFF));
+}
+
+uint8_t FingerprintLink::readPacket(uint8_t* type, uint8_t* data, uint16_t cap, uint16_t* length, uint16_t timeout) {
+  uint8_t header[9];
+  uint16_t idx = 0;
+  uint16_t payload = 0;
+  uint16_t sum = 0;
+  unsigned long start = millis();
+
+  for (;;) {
+    if (!serial->available()) {
+      if (millis() - start >= timeout) return FINGERPRINT_TIMEOUT;
+      delay(1);
+      continue;
+    }
+    uint8_t c = (uint8_t)serial->read();
+
+    if (idx < sizeof(header)) {
+      // Resynchronise on the start code
+      if ((idx == 0 && c != (FINGERPRINT_STARTCODE >> 8)) ||
+          (idx == 1 && c != (FINGERPRINT_STARTCODE & 0xFF))) {
+        idx = 0;
+        continue;
+      }
+      header[idx++] = c;
+      if (idx == sizeof(header)) {
+        payload = ((uint16_t)header[7] << 8) | header[8];
+        if (payload < 2 || payload - 2 > cap) return FINGERPRINT_BADPACKET;
+        payload -= 2;
+        sum = header[6] + header[7] + header[8];
+      }
+    } else if (idx < sizeof(header) + payload) {
+      data[idx - sizeof(header)] = c;
+      sum += c;
+      idx++;
+    } else if (idx == sizeof(header) + payload) {
+      if (c != (uint8_t)(sum >> 8)) return FINGERPRINT_BADPACKET;
+      idx++;
+    } else {
+      if (c != (uint8_t)(sum & 0xFF)) return FINGERPRINT_BADPACKET;
+      *type = header[6];
+      *length = payload;
+      return FINGERPRINT_OK;
+    }
+  }
+}
+
+uint8_t FingerprintLink::command(const uint8_t* data, uint16_t length, uint8_t* reply,
+                                 uint16_t replyCap, uint16_t timeout) {
+  writePacket(FINGERPRINT_COMMANDPACKET, data, length);
+
+  uint8_t ack[16];
+  uint8_t type;
+  uint16_t ackLength;
+  uint8_t rc = readPacket(&type, ack, sizeof(ack), &ackLength, timeout);
+  if (rc != FINGERPRINT_OK) return rc;
+  if (type != FINGERPRINT_ACKPACKET || ackLength < 1) return FINGERPRINT_BADPACKET;
+
+  if (reply != nullptr) {
+    uint16_t n = ackLength - 1 < replyCap ? ackLength - 1 : replyCap;
+    memcpy(reply, ack + 1, n);
+  }
+  return ack[0];
+}
+
+uint8_t FingerprintLink::uploadChar(uint8_t buffer, uint8_t* out, uint16_t cap, uint16_t* length) {
+  uint8_t cmd[] = {FP_CMD_UPCHAR, buffer};
+  uint8_t rc = command(cmd, sizeof(cmd));
+  if (rc != FINGERPRINT_OK) return rc;
+
+  // The template follows as data packets; the last one has its own type
+  uint16_t total = 0;
+  uint8_t type = FINGERPRINT_DATAPACKET;
+  while (type == FINGERPRINT_DATAPACKET) {
+    uint16_t n;
+    rc = readPacket(&type, out + total, cap - total, &n, 1000);
+    if (rc != FINGERPRINT_OK) return rc;
+    if (type != FINGERPRINT_DATAPACKET && type != FINGERPRINT_ENDDATAPACKET) return FINGERPRINT_BADPACKET;
+    total += n;
+  }
+  *length = total;
+  return FINGERPRINT_OK;
+}
+
+uint8_t FingerprintLink::downloadChar(uint8_t buffer, const uint8_t* data, uint16_t length) {
+  uint8_t cmd[] = {FP_CMD_DOWNCHAR, buffer};
+  uint8_t rc = command(cmd, sizeof(cmd));
+  if (rc != FINGERPRINT_OK) return rc;
+
+  for (uint16_t sent = 0; sent < length; sent += packetSize) {
+    uint16_t n = length - sent < packetSize ? length - sent : packetSize;
+    bool last = sent + n >= length;
+    writePacket(last ? FINGERPRINT_ENDDATAPACKET : FINGERPRINT_DATAPACKET, data + sent, n);
+  }
+  serial->flush();
+  return FINGERPRINT_OK;
+}
+
+uint8_t FingerprintLink::loadChar(uint8_t buffer, uint16_t slot) {
+  uint8_t cmd[] = {FINGERPRINT_LOAD, buffer, (uint8_t)(slot >> 8), (uint8_t)(slot & 0xFF)};
+  return command(cmd, sizeof(cmd));
+}
+
+uint8_t FingerprintLink::storeChar(uint8_t buffer, uint16_t slot) {
+  uint8_t cmd[] = {FINGERPRINT_STORE, buffer, (uint8_t)(slot >> 8), (uint8_t)(slot & 0xFF)};
+  return command(cmd, sizeof(cmd));
+}
+
+uint8_t FingerprintLink::deleteChar(uint16_t slot, uint16_t count) {
+  uint8_t cmd[] = {FINGERPRINT_DELETE, (uint8_t)(slot >> 8), (uint8_t)(slot & 0xFF),
+                   (uint8_t)(count >> 8), (uint8_t)(count & 0xFF)};
+  return command(cmd, sizeof(cmd));
+}
+
+uint8_t FingerprintLink::match(uint16_t* score) {
+  uint8_t cmd[] = {FP_CMD_MATCH};
+  uint8_t reply[2] = {0, 0};
+  uint8_t rc = command(cmd, sizeof(cmd), reply, sizeof(reply));
+  *score = ((uint16_t)reply[0] << 8) | reply[1];
+  return rc;
+}
+
+uint8_t FingerprintLink::search(uint8_t buffer, uint16_t start, uint16_t count, uint16_t* slot, uint16_t* score) {
+  uint8_t cmd[] = {FINGERPRINT_SEARCH, buffer, (uint8_t)(start >> 8), (uint8_t)(start & 0xFF),
+                   (uint8_t)(count >> 8), (uint8_t)(count & 0xFF)};
+  uint8_t reply[4] = {0, 0, 0, 0};
+  uint8_t rc = command(cmd, sizeof(cmd), reply, sizeof(reply), 2000);
+  *slot = ((uint16_t)reply[0] << 8) | reply[1];
+  *score = ((uint16_t)reply[2] << 8) | reply[3];
+  return rc;
+}
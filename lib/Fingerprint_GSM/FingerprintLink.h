@@ -0,0 +1,54 @@
+/**
+ * @file FingerprintLink.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Raw R30x/AS608 packet layer for template transfer and ranged search
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Adafruit_Fingerprint caps packets at 64 data bytes and has no DownChar,
+ * Match or ranged Search. This class speaks the same wire protocol on the
+ * same UART, so the two can be used side by side.
+ */
+#ifndef FINGERPRINT_LINK_H
+#define FINGERPRINT_LINK_H
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+
+class FingerprintLink {
+  public:
+    static const uint16_t TEMPLATE_SIZE = 512;   // One CharBuffer / library template
+    static const uint16_t PACKET_MAX = 256;      // Largest data packet the sensor supports
+
+    FingerprintLink(Stream* serial, uint32_t address = 0xFFFFFFFF);
+
+    // Data packet size agreed with the sensor (32, 64, 128 or 256)
+    void setPacketSize(uint16_t bytes) { packetSize = bytes; }
+    uint16_t getPacketSize() const { return packetSize; }
+
+    // All calls return the sensor's confirmation code (FINGERPRINT_OK, ...)
+    // or FINGERPRINT_TIMEOUT / FINGERPRINT_BADPACKET for link errors.
+    uint8_t uploadChar(uint8_t buffer, uint8_t* out, uint16_t cap, uint16_t* length);
+    uint8_t downloadChar(uint8_t buffer, const uint8_t* data, uint16_t length);
+    uint8_t loadChar(uint8_t buffer, uint16_t slot);
+    uint8_t storeChar(uint8_t buffer, uint16_t slot);
+    uint8_t deleteChar(uint16_t slot, uint16_t count = 1);
+    // Compare CharBuffer1 with CharBuffer2
+    uint8_t match(uint16_t* score);
+    // Search `count` library slots starting at `start`
+    uint8_t search(uint8_t buffer, uint16_t start, uint16_t count, uint16_t* slot, uint16_t* score);
+
+  private:
+    Stream* serial;
+    uint32_t address;
+    uint16_t packetSize;
+
+    void writePacket(uint8_t type, const uint8_t* data, uint16_t length);
+    uint8_t readPacket(uint8_t* type, uint8_t* data, uint16_t cap, uint16_t* length, uint16_t timeout);
+    uint8_t command(const uint8_t* data, uint16_t length, uint8_t* reply = nullptr,
+                    uint16_t replyCap = 0, uint16_t timeout = 1000);
+};
+
+#endif
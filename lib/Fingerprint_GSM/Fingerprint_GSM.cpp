@@ -9,47 +9,125 @@
  * 
  */
 #include "Fingerprint_GSM.h"
+
+// SMS templates. They are printf formats used with TextBuffer::format(),
+// so the compiler checks every argument against them.
+#define MSG_ACCESS_GRANTED  "ACCESS GRANTED\nUser: %s\nID: %u\nTime: %s"
+#define MSG_ACCESS_DENIED   "ACCESS DENIED\nUnknown fingerprint detected!\nTime: %s"
+#define MSG_USER_ACCESS     "Hello %s, you accessed the system."
+#define MSG_USER_ACCESS_AT  "Hello %s, you accessed the system at %s."
+#define MSG_ENROLLMENT      "NEW ENROLLMENT\nUser: %s\nID: %u"
+#define MSG_ENROLLMENT_TIME "\nTime: %s"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
 FingerprintGSM::FingerprintGSM(HardwareSerial* fpSerial, HardwareSerial* gsmSerial) {
   this->fingerprintSerial = fpSerial;
   this->gsmSerial = gsmSerial;
   this->finger = new Adafruit_Fingerprint(fpSerial);
+  this->link = new FingerprintLink(fpSerial);
+  this->templates = new TemplateStore();
+  this->pager = new TemplatePager(link, templates);
+  this->pagingEnabled = false;
+  this->hotSearch = new HotSearch(link);
+  this->modem = new AtEngine(gsmSerial);
+  this->modem->setSmsCallback(onSmsResult, this);
+  this->outbox = new SmsOutbox(modem);
+  this->digest = new SmsDigest(outbox);
   this->lcd = nullptr;
+  this->lcdFrame = nullptr;
+  this->screens = nullptr;
   this->rtc = nullptr;
-  this->userCount = 0;
+  this->accessLog = new AttendanceLog();
+  this->logEnabled = false;
+  this->presence = nullptr;
+  this->report = nullptr;
+  this->epochBase = 0;
+  this->epochBaseMs = 0;
+#ifdef ARDUINO_ARCH_ESP32
+  this->epochLock = xSemaphoreCreateMutex();
+#endif
+  this->users = new UserStore(TemplateStore::MAX_TEMPLATES);
+  this->commands = new SmsCommands(modem, outbox, users);
   this->gsmReady = false;
+  this->adminPhone[0] = '\0';
+  this->digestMode = false;
+  this->pduMode = false;
+  this->pduRef = 0;
   this->lcdEnabled = false;
   this->rtcEnabled = false;
   this->lcdCols = 16;
   this->lcdRows = 2;
   this->showTimeOnLCD = false;
   this->lastTimeUpdate = 0;
-  
-  // Initialize user array
-  for (int i = 0; i < 127; i++) {
-    users[i].id = 0;
-    users[i].name[0] = '\0';
-    users[i].phoneNumber[0] = '\0';
-    users[i].notifyOnAccess = false;
-  }
+  this->tasksRunning = false;
+  this->fingerDown = false;
+  this->scanInterval = 20;
+  this->scanTaskHandle = nullptr;
+  this->linkNegotiation = false;
+  this->touchWake = false;
+  this->touchWired = false;
+  this->touchPin = -1;
+  this->fingerPresent = false;
+  this->touchPending = false;
+  this->touchAtUs = 0;
+  this->lastCaptureMs = 0;
+  this->pollInterval = POLL_MIN;
+  memset(&this->touchStats, 0, sizeof(this->touchStats));
+  this->latency = new LatencyStats();
+  this->consoleEnabled = false;
+  this->consoleLength = 0;
+  memset(&this->lookupScratch, 0, sizeof(this->lookupScratch));
+}
+
+FingerprintGSM::~FingerprintGSM() {
+  if (touchPin >= 0) detachInterrupt(digitalPinToInterrupt(touchPin));
+  // Users of an object go before it: report and commands read presence,
+  // outbox and users; the pager works through link and templates
+  delete report;
+  delete commands;
+  delete presence;
+  delete digest;
+  delete outbox;
+  delete modem;
+  delete users;
+  delete accessLog;
+  delete screens;
+  delete lcdFrame;
+  delete lcd;
+  delete rtc;
+  delete hotSearch;
+  delete pager;
+  delete templates;
+  delete link;
+  delete finger;
+  delete latency;
+#ifdef ARDUINO_ARCH_ESP32
+  vSemaphoreDelete(epochLock);
+#endif
 }
 
 bool FingerprintGSM::beginFingerprint(long baudRate, uint8_t rxPin, uint8_t txPin) {
   fingerprintSerial->begin(baudRate, SERIAL_8N1, rxPin, txPin);
   delay(100);
   
-  if (finger->verifyPassword()) {
+  bool found = linkNegotiation ? negotiateLink(baudRate) : finger->verifyPassword();
+  if (found) {
     Serial.println("[FP] Fingerprint sensor initialized");
     if (lcdEnabled) {
-      lcdShowStatus("Fingerprint", "Ready!");
-      delay(1500);
+      lcdToast(1500, "Fingerprint", "Ready!");
     }
     finger->getParameters();
+    hotSearch->begin(finger->capacity);
     return true;
   } else {
     Serial.println("[FP] ERROR: Fingerprint sensor not found");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "FP Sensor", "Not Found!");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "FP Sensor", "Not Found!");
     }
     return false;
   }
@@ -61,43 +139,56 @@ bool FingerprintGSM::beginGSM(long baudRate, uint8_t rxPin, uint8_t txPin) {
   
   Serial.println("[GSM] Initializing SIM800L...");
   if (lcdEnabled) {
-    lcdShowStatus("GSM Module", "Initializing...");
+    lcdToast(0, "GSM Module", "Initializing...");
   }
   
   // Test AT command
-  if (!sendATCommand("AT", "OK", 1000)) {
+  if (!sendATCommand("AT", 1000)) {
     Serial.println("[GSM] ERROR: No response from SIM800L");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "GSM No Response");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "GSM No Response");
     }
     return false;
   }
   
+  // Disable command echo so message bodies never look like result codes
+  sendATCommand("ATE0", 1000);
+  
   // Check signal quality
-  gsmSerial->println("AT+CSQ");
-  delay(500);
+  sendATCommand("AT+CSQ", 1000);
   Serial.print("[GSM] Signal: ");
-  while (gsmSerial->available()) {
-    Serial.write(gsmSerial->read());
-  }
+  Serial.print(modem->signalQuality());
+  Serial.println("/31");
   
-  // Set SMS mode to text
-  if (!sendATCommand("AT+CMGF=1", "OK", 1000)) {
-    Serial.println("[GSM] ERROR: Failed to set SMS text mode");
+  // Select the SMS mode once; messages never switch it again
+  if (!sendATCommand(pduMode ? "AT+CMGF=0" : "AT+CMGF=1", 1000)) {
+    Serial.println(pduMode ? "[GSM] ERROR: Failed to set SMS PDU mode"
+                           : "[GSM] ERROR: Failed to set SMS text mode");
     return false;
   }
+  // Text mode: headers carry the body length, so a message line reading
+  // "OK" can never pass for the modem's answer
+  if (!pduMode && !sendATCommand("AT+CSDH=1", 1000)) {
+    Serial.println("[GSM] ERROR: Failed to enable SMS text headers");
+    return false;
+  }
+  modem->setTextMode(!pduMode);
+  outbox->setPduMode(pduMode);
   
-  // Configure SMS parameters
-  sendATCommand("AT+CNMI=2,2,0,0,0", "OK", 1000);
+  // Push incoming SMS to the UART (+CMT) for the command processor
+  commands->setPduMode(pduMode);
+  commands->begin();
+  sendATCommand("AT+CNMI=2,2,0,0,0", 1000);
   
   Serial.println("[GSM] SIM800L initialized successfully");
   if (lcdEnabled) {
-    lcdShowStatus("GSM Module", "Ready!");
-    delay(1500);
+    lcdToast(1500, "GSM Module", "Ready!");
   }
   
   gsmReady = true;
+  
+  // Pick up notifications that were still queued before the last reset
+  outbox->begin();
   return true;
 }
 
@@ -108,6 +199,8 @@ bool FingerprintGSM::beginLCD(uint8_t address, uint8_t cols, uint8_t rows) {
   lcd = new LiquidCrystal_I2C(address, cols, rows);
   lcd->init();
   lcd->backlight();
+  lcdFrame = new LcdFrame(lcd, cols, rows);
+  screens = new LcdCompositor(lcdFrame, lcd, cols, rows);
   
   lcdEnabled = true;
   
@@ -127,8 +220,7 @@ bool FingerprintGSM::beginRTC() {
   if (!rtc->begin()) {
     Serial.println("[RTC] ERROR: RTC not found");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "RTC Not Found");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "RTC Not Found");
     }
     return false;
   }
@@ -141,92 +233,368 @@ bool FingerprintGSM::beginRTC() {
   rtcEnabled = true;
   Serial.println("[RTC] Real-Time Clock initialized");
   
-  DateTime now = rtc->now();
+  DateTime now = readRtc();
+  DateTimeText timeStr;
+  DateTimeText dateStr;
   Serial.print("[RTC] Current time: ");
-  Serial.println(getDateTimeString(now));
+  Serial.println(getDateTimeString(now, timeStr));
   
   if (lcdEnabled) {
-    lcdShowStatus("RTC Ready", getTimeString(now), getDateString(now));
-    delay(2000);
+    lcdToast(2000, "RTC Ready", getTimeString(now, timeStr), getDateString(now, dateStr));
   }
   
   return true;
 }
 
-void FingerprintGSM::setAdminPhone(String phone) {
-  adminPhone = phone;
-  Serial.print("[GSM] Admin phone set to: ");
-  Serial.println(adminPhone);
+void FingerprintGSM::setLinkNegotiation(bool enabled) {
+  linkNegotiation = enabled;
 }
 
-bool FingerprintGSM::sendATCommand(String cmd, String expectedResponse, unsigned long timeout) {
-  gsmSerial->println(cmd);
-  unsigned long start = millis();
-  String response = "";
+bool FingerprintGSM::probeLink(long baud) {
+  fingerprintSerial->updateBaudRate(baud);
+  delay(20);
+  while (fingerprintSerial->available()) fingerprintSerial->read();  // Junk from the old rate
   
-  while (millis() - start < timeout) {
-    while (gsmSerial->available()) {
-      char c = gsmSerial->read();
-      response += c;
-    }
-    if (response.indexOf(expectedResponse) != -1) {
-      return true;
-    }
+  for (uint8_t i = 0; i < LINK_CHECKS; i++) {
+    if (!finger->verifyPassword()) return false;
   }
+  return true;
+}
+
+bool FingerprintGSM::switchBaud(long from, long to) {
+  // The sensor acknowledges at the old rate, then switches (R30x codes are N x 9600)
+  if (finger->setBaudRate(to / 9600) != FINGERPRINT_OK) return false;
+  if (probeLink(to)) return true;
+  
+  // Not stable at the new rate: ask it to go back, then listen at the old one
+  finger->setBaudRate(from / 9600);
+  probeLink(from);
   return false;
 }
 
-bool FingerprintGSM::sendSMS(String phoneNumber, String message) {
-  if (!gsmReady) {
-    Serial.println("[GSM] ERROR: GSM not initialized");
+bool FingerprintGSM::negotiateLink(long defaultBaud) {
+  // R30x modules top out at 115200 (register value 12)
+  static const long BAUD_RATES[] = {115200, 57600, 38400, 19200, 9600};
+  static const uint8_t BAUD_COUNT = sizeof(BAUD_RATES) / sizeof(BAUD_RATES[0]);
+  
+  Preferences prefs;
+  prefs.begin("fplink", false);
+  long storedBaud = prefs.getUInt("baud", 0);
+  uint8_t storedPacket = prefs.getUChar("packet", 0xFF);
+  
+  // Settings from an earlier boot only need the link check
+  if (storedBaud > 0 && probeLink(storedBaud)) {
+    Serial.print("[FP] Link ");
+    Serial.print(storedBaud);
+    Serial.print(" baud, ");
+    Serial.print(32 << storedPacket);
+    Serial.println("-byte packets (stored)");
+    prefs.end();
+    return true;
+  }
+  
+  // Find the rate the sensor is at now, starting with the configured one
+  long current = probeLink(defaultBaud) ? defaultBaud : 0;
+  for (uint8_t i = 0; i < BAUD_COUNT && current == 0; i++) {
+    if (BAUD_RATES[i] != defaultBaud && probeLink(BAUD_RATES[i])) current = BAUD_RATES[i];
+  }
+  if (current == 0) {
+    prefs.end();
     return false;
   }
   
-  Serial.println("[GSM] Sending SMS to: " + phoneNumber);
-  if (lcdEnabled) {
-    lcdShowStatus("Sending SMS...");
+  // Step up from the fastest rate and keep the first one that holds
+  long chosen = current;
+  for (uint8_t i = 0; i < BAUD_COUNT && BAUD_RATES[i] > current; i++) {
+    if (switchBaud(current, BAUD_RATES[i])) {
+      chosen = BAUD_RATES[i];
+      break;
+    }
+  }
+  if (chosen == current && !probeLink(current)) {
+    // A failed switch left the sensor somewhere else; find it again
+    chosen = 0;
+    for (uint8_t i = 0; i < BAUD_COUNT && chosen == 0; i++) {
+      if (probeLink(BAUD_RATES[i])) chosen = BAUD_RATES[i];
+    }
+    if (chosen == 0) {
+      prefs.end();
+      return false;
+    }
   }
   
-  gsmSerial->print("AT+CMGS=\"");
-  gsmSerial->print(phoneNumber);
-  gsmSerial->println("\"");
-  delay(500);
+  // Largest packet size the sensor accepts and reports back
+  uint8_t packet = FINGERPRINT_PACKET_SIZE_32;
+  for (int8_t code = FINGERPRINT_PACKET_SIZE_256; code > FINGERPRINT_PACKET_SIZE_32; code--) {
+    if (finger->setPacketSize(code) == FINGERPRINT_OK &&
+        finger->getParameters() == FINGERPRINT_OK && finger->packet_len == (32 << code)) {
+      packet = code;
+      break;
+    }
+  }
   
-  gsmSerial->print(message);
-  delay(100);
-  gsmSerial->write(26);  // Ctrl+Z to send
+  if ((uint32_t)chosen != (uint32_t)storedBaud) prefs.putUInt("baud", chosen);
+  if (packet != storedPacket) prefs.putUChar("packet", packet);
+  prefs.end();
   
-  unsigned long start = millis();
-  bool sent = false;
+  Serial.print("[FP] Link negotiated: ");
+  Serial.print(chosen);
+  Serial.print(" baud, ");
+  Serial.print(32 << packet);
+  Serial.println("-byte packets");
+  return true;
+}
+
+void FingerprintGSM::setPduMode(bool enabled) {
+  pduMode = enabled;
+}
+
+void FingerprintGSM::setAdminPhone(const char* phone) {
+  strncpy(adminPhone, phone, sizeof(adminPhone) - 1);
+  adminPhone[sizeof(adminPhone) - 1] = '\0';
+  commands->setAdminPhone(adminPhone);
+  Serial.print("[GSM] Admin phone set to: ");
+  Serial.println(adminPhone);
+}
+
+bool FingerprintGSM::sendATCommand(const char* cmd, unsigned long timeout) {
+  return modem->runCommand(cmd, timeout) == AT_OK;
+}
+
+SmsHandle FingerprintGSM::sendSMS(const char* phoneNumber, const char* message) {
+  if (refuseInTaskMode("sendSMS")) return 0;
+  if (!gsmReady) {
+    Serial.println("[GSM] ERROR: GSM not initialized");
+    return 0;
+  }
   
-  while (millis() - start < 10000) {
-    if (gsmSerial->available()) {
-      String response = gsmSerial->readString();
-      if (response.indexOf("OK") != -1) {
-        sent = true;
-        break;
+  SmsHandle handle = 0;
+  if (pduMode) {
+    char pdu[SMS_PDU_HEX_MAX + 1];
+    uint8_t parts = smsPartCount(message);
+    // Queue all parts or none: a message missing a part is never reassembled
+    if (parts > modem->freeSlots()) {
+      Serial.println("[GSM] ERROR: SMS queue full");
+      return 0;
+    }
+    pduRef++;
+    for (uint8_t i = 0; i < parts; i++) {
+      uint8_t len = smsEncodePdu(phoneNumber, message, i, parts, pduRef, pdu, sizeof(pdu));
+      if (len == 0) {
+        Serial.println("[GSM] ERROR: Cannot encode SMS");
+        return 0;
       }
+      handle = modem->sendPdu(len, pdu);
+      if (handle == 0) break;
     }
+  } else {
+    handle = modem->sendSMS(phoneNumber, message);
   }
   
-  if (sent) {
-    Serial.println("[GSM] SMS sent successfully");
-    if (lcdEnabled) {
-      lcdShowStatus("SMS Sent!");
-      delay(1500);
-    }
+  if (handle == 0) {
+    Serial.println("[GSM] ERROR: SMS queue full");
+    return 0;
+  }
+  
+  Serial.print("[GSM] Queued SMS #");
+  Serial.print(handle);
+  Serial.print(" to: ");
+  Serial.println(phoneNumber);
+  return handle;
+}
+
+SmsStatus FingerprintGSM::getSmsStatus(SmsHandle handle) {
+  return modem->smsStatus(handle);
+}
+
+uint8_t FingerprintGSM::getPendingSMSCount() {
+  return outbox->size() + digest->pendingEvents();
+}
+
+void FingerprintGSM::setDigestMode(bool enabled, unsigned long windowMs, uint8_t maxEvents) {
+  if (refuseInTaskMode("setDigestMode")) return;
+  if (!enabled && digestMode) {
+    digest->flushAll();
+  }
+  digestMode = enabled;
+  digest->setWindow(windowMs, maxEvents);
+}
+
+void FingerprintGSM::onSmsResult(SmsHandle handle, SmsStatus status, void* ctx) {
+  FingerprintGSM* self = (FingerprintGSM*)ctx;
+  if (self->latency->enabled()) {
+    self->latency->record(LatencyStats::STAGE_SMS_SEND, self->modem->lastSmsLatency());
+  }
+  Serial.print("[GSM] SMS #");
+  Serial.print(handle);
+  if (status == SMS_SENT) {
+    Serial.println(" sent successfully");
   } else {
-    Serial.println("[GSM] ERROR: Failed to send SMS");
-    if (lcdEnabled) {
-      lcdShowStatus("SMS Failed!");
-      delay(1500);
-    }
+    Serial.println(" ERROR: Failed to send SMS");
+  }
+}
+
+void FingerprintGSM::poll() {
+  if (tasksRunning) return;  // The GSM task owns the modem
+  if (pagingEnabled) pager->poll();
+  if (logEnabled) accessLog->poll();
+  if (presence != nullptr) presence->poll();
+  if (report != nullptr) report->poll(currentEpoch());
+  if (lcdEnabled) screens->tick();
+  modem->poll();
+  digest->poll();
+  outbox->poll();
+  commands->poll(currentEpoch());
+  if (consoleEnabled) serviceConsole();
+}
+
+bool FingerprintGSM::startTasks(uint16_t scanIntervalMs) {
+#ifdef ARDUINO_ARCH_ESP32
+  if (tasksRunning) return true;
+  scanInterval = scanIntervalMs;
+  tasksRunning = true;
+  
+  // Core 1 only ever talks to the sensor; the modem and the I2C bus share core 0
+  TaskHandle_t scanHandle = nullptr;
+  BaseType_t ok = xTaskCreatePinnedToCore(scanTaskEntry, "fp_scan", 4096, this, 3, &scanHandle, 1);
+  scanTaskHandle = scanHandle;
+  ok &= xTaskCreatePinnedToCore(gsmTaskEntry, "gsm", 6144, this, 2, nullptr, 0);
+  ok &= xTaskCreatePinnedToCore(lcdTaskEntry, "lcd", 4096, this, 1, nullptr, 0);
+  if (ok != pdPASS) {
+    Serial.println("[TASK] ERROR: Failed to start tasks");
+    return false;
+  }
+  
+  Serial.println("[TASK] Scan task on core 1, GSM and LCD tasks on core 0");
+  return true;
+#else
+  (void)scanIntervalMs;
+  Serial.println("[TASK] ERROR: Tasks need an ESP32");
+  return false;
+#endif
+}
+
+bool FingerprintGSM::refuseInTaskMode(const char* what) {
+  if (!tasksRunning) return false;
+  Serial.print("[TASK] ERROR: ");
+  Serial.print(what);
+  Serial.println("() would race the tasks");
+  return true;
+}
+
+bool FingerprintGSM::scanOnce(ScanEvent& event) {
+  bool woken;
+  if (!captureDue(woken)) return false;
+  
+  uint8_t p = captureImage(woken);
+  if (p == FINGERPRINT_NOFINGER) {
+    fingerDown = false;
+    return false;
   }
+  // One event per touch, however long the finger stays on the glass
+  if (p != FINGERPRINT_OK || fingerDown) return false;
   
-  return sent;
+  uint32_t started = latency->start();
+  p = finger->image2Tz();
+  latency->stop(LatencyStats::STAGE_IMAGE_TO_TZ, started);
+  if (p != FINGERPRINT_OK) return false;
+  
+  uint16_t id, score;
+  p = searchFinger(&id, &score);
+  if (p != FINGERPRINT_OK && p != FINGERPRINT_NOTFOUND) return false;
+  
+  fingerDown = true;
+  event.at = millis();
+  event.granted = (p == FINGERPRINT_OK);
+  event.fingerprintID = event.granted ? id : 0;
+  event.confidence = event.granted ? score : 0;
+  return true;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void FingerprintGSM::scanTaskEntry(void* arg) {
+  static_cast<FingerprintGSM*>(arg)->scanTask();
+}
+
+void FingerprintGSM::gsmTaskEntry(void* arg) {
+  static_cast<FingerprintGSM*>(arg)->gsmTask();
+}
+
+void FingerprintGSM::lcdTaskEntry(void* arg) {
+  static_cast<FingerprintGSM*>(arg)->lcdTask();
+}
+
+void FingerprintGSM::scanTask() {
+  ScanEvent event;
+  for (;;) {
+    // No logging here: a full UART TX buffer must not stall the gate
+    if (scanOnce(event)) {
+      notifyQueue.push(event);
+      displayQueue.push(event);
+    } else if (pagingEnabled && !fingerDown) {
+      pager->poll();  // Preload scheduled templates while the gate is quiet
+    }
+    if (touchWake) {
+      // Sleep until the touch interrupt or the next fallback poll
+      unsigned long elapsed = millis() - lastCaptureMs;
+      unsigned long wait = nextPollDelay();
+      wait = elapsed < wait ? wait - elapsed : 1;
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(scanInterval));
+    }
+  }
+}
+
+void FingerprintGSM::gsmTask() {
+  ScanEvent event;
+  for (;;) {
+    while (notifyQueue.pop(event)) {
+      if (event.granted) {
+        Serial.print("[FP] Match found! ID #");
+        Serial.print(event.fingerprintID);
+        Serial.print(" Confidence: ");
+        Serial.println(event.confidence);
+      } else {
+        Serial.println("[FP] No match found");
+      }
+      logAccess(event.fingerprintID, event.granted);
+      if (event.granted && presence != nullptr) presence->mark(event.fingerprintID, currentEpoch());
+      notifyAccess(event.fingerprintID, event.granted);
+    }
+    if (logEnabled) accessLog->poll();
+    if (presence != nullptr) presence->poll();
+    if (report != nullptr) report->poll(currentEpoch());
+    modem->poll();
+    digest->poll();
+    outbox->poll();
+    commands->poll(currentEpoch());
+    if (consoleEnabled) serviceConsole();
+    vTaskDelay(pdMS_TO_TICKS(GSM_TASK_PERIOD));
+  }
+}
+
+void FingerprintGSM::lcdTask() {
+  ScanEvent event;
+  for (;;) {
+    if (displayQueue.pop(event)) {
+      UserData user;
+      if (event.granted && getUser(event.fingerprintID, user)) {
+        lcdShowAccessGranted(user.name);
+      } else {
+        lcdShowAccessDenied();
+      }
+    }
+    // The clock keeps running on the base screen under the result toast
+    lcdUpdateTime();
+    lcdTick();
+    vTaskDelay(pdMS_TO_TICKS(LCD_TASK_PERIOD));
+  }
 }
+#endif
 
-bool FingerprintGSM::enrollFingerprint(uint8_t id) {
+bool FingerprintGSM::enrollFingerprint(uint16_t id) {
+  if (refuseInTaskMode("enrollFingerprint")) return false;
   Serial.print("[FP] Enrolling fingerprint ID #");
   Serial.println(id);
   
@@ -244,8 +612,7 @@ bool FingerprintGSM::enrollFingerprint(uint8_t id) {
     } else if (p != FINGERPRINT_NOFINGER) {
       Serial.println("[FP] ERROR: Image capture failed");
       if (lcdEnabled) {
-        lcdShowStatus("ERROR:", "Capture Failed");
-        delay(2000);
+        lcdToast(2000, "ERROR:", "Capture Failed");
       }
       return false;
     }
@@ -255,8 +622,7 @@ bool FingerprintGSM::enrollFingerprint(uint8_t id) {
   if (p != FINGERPRINT_OK) {
     Serial.println("[FP] ERROR: Image conversion failed");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "Convert Failed");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "Convert Failed");
     }
     return false;
   }
@@ -284,8 +650,7 @@ bool FingerprintGSM::enrollFingerprint(uint8_t id) {
     } else if (p != FINGERPRINT_NOFINGER) {
       Serial.println("[FP] ERROR: Image capture failed");
       if (lcdEnabled) {
-        lcdShowStatus("ERROR:", "Capture Failed");
-        delay(2000);
+        lcdToast(2000, "ERROR:", "Capture Failed");
       }
       return false;
     }
@@ -295,8 +660,7 @@ bool FingerprintGSM::enrollFingerprint(uint8_t id) {
   if (p != FINGERPRINT_OK) {
     Serial.println("[FP] ERROR: Image conversion failed");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "Convert Failed");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "Convert Failed");
     }
     return false;
   }
@@ -305,44 +669,55 @@ bool FingerprintGSM::enrollFingerprint(uint8_t id) {
   if (p != FINGERPRINT_OK) {
     Serial.println("[FP] ERROR: Fingerprints did not match");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "Prints Don't", "Match!");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "Prints Don't", "Match!");
     }
     return false;
   }
   
-  p = finger->storeModel(id);
+  if (pagingEnabled) {
+    p = pager->enroll(id) ? FINGERPRINT_OK : FINGERPRINT_FLASHERR;
+  } else {
+    p = finger->storeModel(id);
+  }
   if (p == FINGERPRINT_OK) {
     Serial.println("[FP] Fingerprint enrolled successfully!");
     if (lcdEnabled) {
-      lcdShowStatus("Success!", "ID #" + String(id), "Enrolled!");
-      delay(2000);
+      TextBuffer<16> line;
+      line.format("ID #%u", id);
+      lcdToast(2000, "Success!", line, "Enrolled!");
     }
     return true;
   } else {
     Serial.println("[FP] ERROR: Failed to store fingerprint");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "Store Failed");
-      delay(2000);
+      lcdToast(2000, "ERROR:", "Store Failed");
     }
     return false;
   }
 }
 
 int FingerprintGSM::verifyFingerprint() {
-  uint8_t p = finger->getImage();
+  if (refuseInTaskMode("verifyFingerprint")) return -1;
+  bool woken;
+  if (!captureDue(woken)) return -1;
+  
+  uint8_t p = captureImage(woken);
   if (p != FINGERPRINT_OK) return -1;
   
+  uint32_t started = latency->start();
   p = finger->image2Tz();
+  latency->stop(LatencyStats::STAGE_IMAGE_TO_TZ, started);
   if (p != FINGERPRINT_OK) return -1;
   
-  p = finger->fingerSearch();
+  uint16_t id, score;
+  p = searchFinger(&id, &score);
   if (p == FINGERPRINT_OK) {
     Serial.print("[FP] Match found! ID #");
-    Serial.print(finger->fingerID);
+    Serial.print(id);
     Serial.print(" Confidence: ");
-    Serial.println(finger->confidence);
-    return finger->fingerID;
+    Serial.println(score);
+    if (presence != nullptr) presence->mark(id, currentEpoch());
+    return id;
   } else if (p == FINGERPRINT_NOTFOUND) {
     Serial.println("[FP] No match found");
     return -2;
@@ -351,33 +726,266 @@ int FingerprintGSM::verifyFingerprint() {
   return -1;
 }
 
-bool FingerprintGSM::deleteFingerprint(uint8_t id) {
-  uint8_t p = finger->deleteModel(id);
+void FingerprintGSM::enableTouchWake(int8_t pin, bool activeHigh) {
+  touchWake = true;
+  touchWired = pin >= 0;
+  pollInterval = POLL_MIN;
+  touchPending = false;
+  touchStats.touchMisses = 0;
+  
+  if (touchPin >= 0) detachInterrupt(digitalPinToInterrupt(touchPin));
+  touchPin = pin;
+  if (touchWired) {
+    // Pull the line to its idle level so an unconnected pin stays quiet
+    pinMode(pin, activeHigh ? INPUT_PULLDOWN : INPUT_PULLUP);
+    attachInterruptArg(pin, onTouch, this, activeHigh ? RISING : FALLING);
+    Serial.print("[FP] Wake-on-touch enabled on GPIO ");
+    Serial.println(pin);
+  } else {
+    Serial.println("[FP] No touch line, using adaptive polling");
+  }
+}
+
+void IRAM_ATTR FingerprintGSM::onTouch(void* arg) {
+  FingerprintGSM* self = static_cast<FingerprintGSM*>(arg);
+  if (!self->touchPending) {
+    self->touchAtUs = micros();
+    self->touchPending = true;
+  }
+#ifdef ARDUINO_ARCH_ESP32
+  if (self->scanTaskHandle != nullptr) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)self->scanTaskHandle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+  }
+#endif
+}
+
+bool FingerprintGSM::captureDue(bool& woken) {
+  woken = false;
+  if (!touchWake) return true;
+  
+  if (touchPending) {
+    touchPending = false;
+    woken = true;
+    return true;
+  }
+  return millis() - lastCaptureMs >= nextPollDelay();
+}
+
+unsigned long FingerprintGSM::nextPollDelay() {
+  if (fingerPresent) return POLL_MIN;  // Track the finger until it lifts
+  if (touchWired) return TOUCH_SAFETY_POLL;
+  return pollInterval;
+}
+
+uint8_t FingerprintGSM::captureImage(bool woken) {
+  uint32_t started = latency->start();
+  uint8_t p = finger->getImage();
+  latency->stop(LatencyStats::STAGE_GET_IMAGE, started);
+  touchStats.imageRequests++;
+  if (!touchWake) return p;
+  
+  lastCaptureMs = millis();
+  bool wasPresent = fingerPresent;
+  fingerPresent = (p != FINGERPRINT_NOFINGER);
+  
+  if (woken) {
+    uint32_t latency = micros() - touchAtUs;
+    touchStats.wakeups++;
+    touchStats.latencySumUs += latency;
+    if (latency > touchStats.latencyMaxUs) touchStats.latencyMaxUs = latency;
+  }
+  
+  if (!fingerPresent) {
+    touchStats.idleImages++;
+    // Back off while nobody is at the gate
+    pollInterval = pollInterval * 2 > POLL_MAX ? POLL_MAX : pollInterval * 2;
+    return p;
+  }
+  
+  pollInterval = POLL_MIN;
+  if (touchWired && !woken && !wasPresent) {
+    // A new finger the interrupt never reported: the line is probably not wired
+    if (++touchStats.touchMisses >= TOUCH_MISS_LIMIT) {
+      touchWired = false;
+      Serial.println("[FP] Touch line silent, falling back to adaptive polling");
+    }
+  }
+  return p;
+}
+
+void FingerprintGSM::printTouchStats() {
+  Serial.println("\n[FP] === Touch Wake Stats ===");
+  Serial.print("Mode: ");
+  Serial.println(!touchWake ? "Fixed polling" : (touchWired ? "Touch line" : "Adaptive polling"));
+  Serial.print("Wake-ups: "); Serial.println(touchStats.wakeups);
+  if (touchStats.wakeups > 0) {
+    Serial.print("Touch to image: avg ");
+    Serial.print(touchStats.latencySumUs / touchStats.wakeups);
+    Serial.print(" us, max ");
+    Serial.print(touchStats.latencyMaxUs);
+    Serial.println(" us");
+  }
+  Serial.print("getImage sent: "); Serial.println(touchStats.imageRequests);
+  Serial.print("Idle getImage: ");
+  Serial.print(touchStats.idleImages);
+  Serial.print(" (");
+  Serial.print(touchStats.idleImages * IMAGE_PACKET_BYTES);
+  Serial.println(" UART bytes)");
+  Serial.print("Missed touches: "); Serial.println(touchStats.touchMisses);
+  Serial.println("============================\n");
+}
+
+void FingerprintGSM::setLatencyStats(bool enabled) {
+  latency->setEnabled(enabled);
+}
+
+void FingerprintGSM::printLatencyStats() {
+  latency->print();
+}
+
+void FingerprintGSM::setSerialCommands(bool enabled) {
+  consoleEnabled = enabled;
+  consoleLength = 0;
+}
+
+void FingerprintGSM::serviceConsole() {
+  // Never waits: takes what the UART already holds, runs a complete line
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c == '\r' || c == '\n') {
+      if (consoleLength == 0) continue;
+      consoleLine[consoleLength] = '\0';
+      consoleLength = 0;
+      if (!runSerialCommand(consoleLine)) {
+        Serial.print("[CMD] Unknown command: ");
+        Serial.println(consoleLine);
+      }
+      return;  // One command per pass
+    }
+    if (consoleLength < CONSOLE_LINE_MAX - 1) consoleLine[consoleLength++] = c;
+  }
+}
+
+bool FingerprintGSM::runSerialCommand(const char* line) {
+  if (strcmp(line, "stats") == 0) {
+    printLatencyStats();
+  } else if (strcmp(line, "stats reset") == 0) {
+    latency->reset();
+    Serial.println("[STATS] Cleared");
+  } else if (strcmp(line, "stats on") == 0 || strcmp(line, "stats off") == 0) {
+    setLatencyStats(line[7] == 'n');
+    Serial.println(line[7] == 'n' ? "[STATS] Recording" : "[STATS] Stopped");
+  } else if (strcmp(line, "touch") == 0) {
+    printTouchStats();
+  } else if (strcmp(line, "lcd") == 0) {
+    printLcdStats();
+  } else if (strcmp(line, "paging") == 0) {
+    printPagingStats();
+  } else if (strcmp(line, "search") == 0) {
+    printSearchStats();
+  } else if (strcmp(line, "presence") == 0) {
+    printPresenceReport();
+  } else if (strcmp(line, "help") == 0) {
+    Serial.println("[CMD] stats | stats reset | stats on | stats off | touch | lcd | paging | search | presence");
+  } else {
+    return false;
+  }
+  return true;
+}
+
+uint8_t FingerprintGSM::searchFinger(uint16_t* id, uint16_t* score) {
+  uint32_t started = latency->start();
+  uint8_t p;
+  if (pagingEnabled) {
+    p = pager->identify(id, score);
+  } else if (hotSearch->hotCount() > 0) {
+    p = hotSearch->search(id, score);
+  } else {
+    p = finger->fingerSearch();
+    *id = finger->fingerID;
+    *score = finger->confidence;
+  }
+  latency->stop(LatencyStats::STAGE_SEARCH, started);
+  return p;
+}
+
+bool FingerprintGSM::beginTemplatePaging() {
+  if (finger->getParameters() != FINGERPRINT_OK) {
+    Serial.println("[FP] ERROR: Fingerprint sensor not found");
+    return false;
+  }
+  link->setPacketSize(finger->packet_len);
+  
+  if (!templates->begin() || !pager->begin(finger->capacity)) {
+    Serial.println("[FP] ERROR: Template paging unavailable");
+    return false;
+  }
+  pagingEnabled = true;
+  return true;
+}
+
+void FingerprintGSM::setTemplateSchedule(const uint16_t* ids, uint16_t count) {
+  if (refuseInTaskMode("setTemplateSchedule")) return;
+  pager->setSchedule(ids, count);
+}
+
+void FingerprintGSM::printPagingStats() {
+  if (!pagingEnabled) return;
+  pager->printStats();
+}
+
+void FingerprintGSM::setHotRange(uint16_t start, uint16_t count) {
+  if (refuseInTaskMode("setHotRange")) return;
+  // Both are kept so the range survives beginTemplatePaging() either way
+  pager->setHotSlots(count);
+  hotSearch->setHotRange(start, count);
+}
+
+void FingerprintGSM::printSearchStats() {
+  if (pagingEnabled) {
+    pager->printStats();
+  } else {
+    hotSearch->printStats();
+  }
+}
+
+bool FingerprintGSM::deleteFingerprint(uint16_t id) {
+  if (refuseInTaskMode("deleteFingerprint")) return false;
+  uint8_t p;
+  if (pagingEnabled) {
+    p = pager->remove(id) ? FINGERPRINT_OK : FINGERPRINT_DELETEFAIL;
+  } else {
+    p = finger->deleteModel(id);
+  }
   
   if (p == FINGERPRINT_OK) {
     Serial.print("[FP] Deleted fingerprint ID #");
     Serial.println(id);
     if (lcdEnabled) {
-      lcdShowStatus("Deleted", "ID #" + String(id));
-      delay(1500);
+      TextBuffer<16> line;
+      line.format("ID #%u", id);
+      lcdToast(1500, "Deleted", line);
     }
     return true;
   } else {
     Serial.println("[FP] ERROR: Failed to delete fingerprint");
     if (lcdEnabled) {
-      lcdShowStatus("ERROR:", "Delete Failed");
-      delay(1500);
+      lcdToast(1500, "ERROR:", "Delete Failed");
     }
     return false;
   }
 }
 
 uint8_t FingerprintGSM::getTemplateCount() {
+  if (refuseInTaskMode("getTemplateCount")) return 0;
   finger->getTemplateCount();
   return finger->templateCount;
 }
 
 void FingerprintGSM::printSensorInfo() {
+  if (refuseInTaskMode("printSensorInfo")) return;
   finger->getParameters();
   Serial.println("\n[FP] === Sensor Information ===");
   Serial.print("Capacity: "); Serial.println(finger->capacity);
@@ -388,24 +996,35 @@ void FingerprintGSM::printSensorInfo() {
   Serial.println("============================\n");
   
   if (lcdEnabled) {
-    lcdShowStatus("Templates: " + String(finger->templateCount), 
-                  "Capacity: " + String(finger->capacity));
-    delay(3000);
+    TextBuffer<24> line1;
+    TextBuffer<24> line2;
+    line1.format("Templates: %u", finger->templateCount);
+    line2.format("Capacity: %u", finger->capacity);
+    lcdToast(3000, line1, line2);
   }
 }
 
-bool FingerprintGSM::addUser(uint8_t id, const char* name, const char* phoneNumber, bool notify) {
-  if (id < 1 || id > 127) {
+bool FingerprintGSM::beginUsers(const char* partitionLabel) {
+  return users->begin(partitionLabel);
+}
+
+bool FingerprintGSM::addUser(uint16_t id, const char* name, const char* phoneNumber, bool notify,
+                             const char* grade) {
+  if (refuseInTaskMode("addUser")) return false;
+  if (id < 1 || id > users->maxId()) {
     Serial.println("[USER] ERROR: Invalid ID");
     return false;
   }
   
-  users[id - 1].id = id;
-  strncpy(users[id - 1].name, name, 31);
-  users[id - 1].name[31] = '\0';
-  strncpy(users[id - 1].phoneNumber, phoneNumber, 15);
-  users[id - 1].phoneNumber[15] = '\0';
-  users[id - 1].notifyOnAccess = notify;
+  UserData user;
+  memset(&user, 0, sizeof(user));
+  user.id = id;
+  strncpy(user.name, name, sizeof(user.name) - 1);
+  strncpy(user.phoneNumber, phoneNumber, sizeof(user.phoneNumber) - 1);
+  strncpy(user.grade, grade != nullptr ? grade : "", sizeof(user.grade) - 1);
+  user.notifyOnAccess = notify;
+  if (!users->put(user)) return false;
+  if (presence != nullptr) presence->setEnrolled(id, true);
   
   Serial.print("[USER] Added user: ");
   Serial.print(name);
@@ -414,45 +1033,51 @@ bool FingerprintGSM::addUser(uint8_t id, const char* name, const char* phoneNumb
   Serial.println(")");
   
   if (lcdEnabled) {
-    lcdShowStatus("User Added:", String(name));
-    delay(1500);
+    lcdToast(1500, "User Added:", name);
   }
   
   return true;
 }
 
-bool FingerprintGSM::removeUser(uint8_t id) {
-  if (id < 1 || id > 127) return false;
-  
-  users[id - 1].id = 0;
-  users[id - 1].name[0] = '\0';
-  users[id - 1].phoneNumber[0] = '\0';
-  users[id - 1].notifyOnAccess = false;
+bool FingerprintGSM::removeUser(uint16_t id) {
+  if (refuseInTaskMode("removeUser")) return false;
+  if (!users->remove(id)) return false;
+  if (presence != nullptr) presence->setEnrolled(id, false);
   
   return true;
 }
 
-UserData* FingerprintGSM::getUser(uint8_t id) {
-  if (id < 1 || id > 127) return nullptr;
-  if (users[id - 1].id == 0) return nullptr;
-  return &users[id - 1];
+bool FingerprintGSM::getUser(uint16_t id, UserData& user) {
+  return users->get(id, user);
+}
+
+uint8_t FingerprintGSM::findUsersByPhone(const char* number, uint16_t* ids, uint8_t max) {
+  return users->findByPhone(number, ids, max);
+}
+
+uint8_t FingerprintGSM::findUsersByName(const char* prefix, uint16_t* ids, uint8_t max) {
+  return users->findByName(prefix, ids, max);
 }
 
 void FingerprintGSM::listUsers() {
   Serial.println("\n[USER] === Registered Users ===");
   int count = 0;
-  for (int i = 0; i < 127; i++) {
-    if (users[i].id != 0) {
-      Serial.print("ID #");
-      Serial.print(users[i].id);
-      Serial.print(": ");
-      Serial.print(users[i].name);
-      Serial.print(" | Phone: ");
-      Serial.print(users[i].phoneNumber);
-      Serial.print(" | Notify: ");
-      Serial.println(users[i].notifyOnAccess ? "Yes" : "No");
-      count++;
+  UserData user;
+  for (uint16_t id = users->next(0); id != 0; id = users->next(id)) {
+    if (!users->peek(id, user)) continue;
+    Serial.print("ID #");
+    Serial.print(user.id);
+    Serial.print(": ");
+    Serial.print(user.name);
+    if (user.grade[0] != '\0') {
+      Serial.print(" | ");
+      Serial.print(user.grade);
     }
+    Serial.print(" | Phone: ");
+    Serial.print(user.phoneNumber);
+    Serial.print(" | Notify: ");
+    Serial.println(user.notifyOnAccess ? "Yes" : "No");
+    count++;
   }
   Serial.print("Total: ");
   Serial.print(count);
@@ -460,236 +1085,184 @@ void FingerprintGSM::listUsers() {
   Serial.println("==============================\n");
   
   if (lcdEnabled) {
-    lcdShowStatus("Total Users:", String(count));
-    delay(2000);
+    TextBuffer<8> line;
+    line.format("%d", count);
+    lcdToast(2000, "Total Users:", line);
   }
 }
 
-bool FingerprintGSM::sendAccessNotification(uint8_t fingerprintID, bool granted) {
-  if (!gsmReady || adminPhone.length() == 0) return false;
-  
-  String message = "";
-  UserData* user = getUser(fingerprintID);
-  
-  // Get current time if RTC is available
-  String timeStamp = "";
-  if (rtcEnabled) {
-    DateTime now = rtc->now();
-    timeStamp = getDateTimeString(now);
-  }
-  
-  if (granted && user != nullptr) {
-    message = "ACCESS GRANTED\n";
-    message += "User: " + String(user->name) + "\n";
-    message += "ID: " + String(fingerprintID) + "\n";
-    if (rtcEnabled) {
-      message += "Time: " + timeStamp;
+bool FingerprintGSM::sendAccessNotification(uint16_t fingerprintID, bool granted) {
+  if (refuseInTaskMode("sendAccessNotification")) return false;
+  return notifyAccess(fingerprintID, granted);
+}
+
+bool FingerprintGSM::notifyAccess(uint16_t fingerprintID, bool granted) {
+  if (!gsmReady || adminPhone[0] == '\0') return false;
+  
+  uint32_t started = latency->start();
+  UserData user;
+  DateTimeText timeStamp;
+  TextBuffer<OUTBOX_TEXT_MAX + 1> message;
+  
+  if (granted && getUser(fingerprintID, user)) {
+    if (digestMode) {
+      // One line per scan; the digest sends them to the admin in bulk
+      if (!digest->add(adminPhone, user.name, user.grade, getTimeStamp(timeStamp, false))) {
+        Serial.print("[GSM] ERROR: Digest full, scan of ID #");
+        Serial.print(fingerprintID);
+        Serial.println(" not reported");
+      }
     } else {
-      message += "Time: " + String(millis() / 1000) + "s";
+      message.format(MSG_ACCESS_GRANTED, user.name, fingerprintID, getTimeStamp(timeStamp, true));
+      outbox->append(adminPhone, message);
     }
     
-    // Send to admin
-    sendSMS(adminPhone, message);
-    
     // Send to user if they want notifications
-    if (user->notifyOnAccess && strlen(user->phoneNumber) > 0) {
-      String userMsg = "Hello " + String(user->name) + ", you accessed the system";
+    if (user.notifyOnAccess && user.phoneNumber[0] != '\0') {
+      message.clear();
       if (rtcEnabled) {
-        userMsg += " at " + getTimeString(rtc->now());
+        message.format(MSG_USER_ACCESS_AT, user.name, getTimeString(readRtc(), timeStamp));
+      } else {
+        message.format(MSG_USER_ACCESS, user.name);
       }
-      userMsg += ".";
-      sendSMS(String(user->phoneNumber), userMsg);
+      outbox->append(user.phoneNumber, message);
     }
   } else {
-    message = "ACCESS DENIED\n";
-    message += "Unknown fingerprint detected!\n";
-    if (rtcEnabled) {
-      message += "Time: " + timeStamp;
-    } else {
-      message += "Time: " + String(millis() / 1000) + "s";
-    }
-    sendSMS(adminPhone, message);
+    message.format(MSG_ACCESS_DENIED, getTimeStamp(timeStamp, true));
+    outbox->append(adminPhone, message);
   }
   
+  latency->stop(LatencyStats::STAGE_SMS_ENQUEUE, started);
   return true;
 }
 
-bool FingerprintGSM::sendEnrollmentNotification(uint8_t fingerprintID, const char* name) {
-  if (!gsmReady || adminPhone.length() == 0) return false;
+bool FingerprintGSM::sendEnrollmentNotification(uint16_t fingerprintID, const char* name) {
+  if (refuseInTaskMode("sendEnrollmentNotification")) return false;
+  if (!gsmReady || adminPhone[0] == '\0') return false;
   
-  String message = "NEW ENROLLMENT\n";
-  message += "User: " + String(name) + "\n";
-  message += "ID: " + String(fingerprintID);
+  TextBuffer<OUTBOX_TEXT_MAX + 1> message;
+  message.format(MSG_ENROLLMENT, name, fingerprintID);
   
   if (rtcEnabled) {
-    DateTime now = rtc->now();
-    message += "\nTime: " + getDateTimeString(now);
+    DateTimeText timeStamp;
+    message.format(MSG_ENROLLMENT_TIME, getDateTimeString(readRtc(), timeStamp));
   }
   
-  return sendSMS(adminPhone, message);
+  return outbox->append(adminPhone, message);
 }
 
-bool FingerprintGSM::makeCall(String phoneNumber) {
+const char* FingerprintGSM::readSMS() {
+  return commands->lastText();
+}
+
+bool FingerprintGSM::makeCall(const char* phoneNumber) {
+  if (refuseInTaskMode("makeCall")) return false;
   if (!gsmReady) return false;
   
-  Serial.println("[GSM] Making call to: " + phoneNumber);
+  Serial.print("[GSM] Making call to: ");
+  Serial.println(phoneNumber);
   if (lcdEnabled) {
-    lcdShowStatus("Calling...", phoneNumber);
+    lcdToast(STATUS_HOLD, "Calling...", phoneNumber);
   }
   
-  gsmSerial->print("ATD");
-  gsmSerial->print(phoneNumber);
-  gsmSerial->println(";");
-  
-  delay(1000);
-  return true;
+  TextBuffer<AtEngine::NUMBER_MAX + 8> cmd;
+  cmd.format("ATD%s;", phoneNumber);
+  return modem->sendCommand(cmd, 20000);
 }
 
 int FingerprintGSM::getFingerprintID() {
   return verifyFingerprint();
 }
 
-// LCD Functions
+// LCD Functions. Screens are composed by `screens` into lcdFrame; nothing
+// here waits, poll() (or the LCD task) drives timing through lcdTick().
 void FingerprintGSM::lcdClear() {
   if (!lcdEnabled) return;
-  lcd->clear();
+  screens->clearToasts();
+  screens->clearBase();
 }
 
-void FingerprintGSM::lcdPrint(String text, uint8_t col, uint8_t row) {
+void FingerprintGSM::lcdPrint(const char* text, uint8_t col, uint8_t row) {
   if (!lcdEnabled) return;
-  lcd->setCursor(col, row);
-  lcd->print(text);
+  screens->setBaseText(col, row, text);
 }
 
-void FingerprintGSM::lcdPrintCenter(String text, uint8_t row) {
+void FingerprintGSM::lcdTick() {
   if (!lcdEnabled) return;
-  
-  uint8_t len = text.length();
-  if (len >= lcdCols) {
-    lcd->setCursor(0, row);
-    lcd->print(text.substring(0, lcdCols));
-  } else {
-    uint8_t pos = (lcdCols - len) / 2;
-    lcd->setCursor(pos, row);
-    lcd->print(text);
-  }
+  uint32_t updates = lcdFrame->updates();
+  uint32_t started = latency->start();
+  screens->tick();
+  // Most ticks send nothing; only real screen updates are timed
+  if (lcdFrame->updates() != updates) latency->stop(LatencyStats::STAGE_LCD_UPDATE, started);
 }
 
-void FingerprintGSM::lcdScrollText(String text, uint8_t row, uint16_t delayMs) {
+void FingerprintGSM::lcdShowStatus(const char* line1, const char* line2, const char* line3, const char* line4) {
   if (!lcdEnabled) return;
   
-  if (text.length() <= lcdCols) {
-    lcdPrintCenter(text, row);
-    return;
-  }
-  
-  // Add spaces for smooth scrolling
-  text = String("  ") + text + String("  ");
-  
-  for (int i = 0; i <= text.length() - lcdCols; i++) {
-    lcd->setCursor(0, row);
-    lcd->print(text.substring(i, i + lcdCols));
-    delay(delayMs);
-  }
+  screens->setBaseLine(0, line1);
+  screens->setBaseLine(1, line2);
+  screens->setBaseLine(2, line3);
+  screens->setBaseLine(3, line4);
 }
 
-void FingerprintGSM::lcdShowStatus(String line1, String line2, String line3, String line4) {
+void FingerprintGSM::lcdToast(unsigned long durationMs, const char* line1, const char* line2,
+                              const char* line3, const char* line4) {
   if (!lcdEnabled) return;
-  
-  lcd->clear();
-  
-  if (line1.length() > 0) lcdPrintCenter(line1, 0);
-  if (lcdRows >= 2 && line2.length() > 0) lcdPrintCenter(line2, 1);
-  if (lcdRows >= 3 && line3.length() > 0) lcdPrintCenter(line3, 2);
-  if (lcdRows >= 4 && line4.length() > 0) lcdPrintCenter(line4, 3);
+  screens->toast(durationMs, line1, line2, line3, line4);
 }
 
 void FingerprintGSM::lcdShowWelcome() {
   if (!lcdEnabled) return;
-  
-  lcd->clear();
-  lcdPrintCenter("Security System", 0);
-  if (lcdRows >= 2) {
-    lcdPrintCenter("Initializing...", 1);
-  }
-  delay(2000);
+  screens->toast(STATUS_HOLD, "Security System", "Initializing...");
 }
 
 void FingerprintGSM::lcdShowAccessGranted(const char* name) {
   if (!lcdEnabled) return;
   
-  lcd->clear();
-  lcdPrintCenter("ACCESS GRANTED", 0);
-  
-  if (lcdRows >= 2) {
-    if (strlen(name) > lcdCols) {
-      lcdScrollText(String(name), 1, 250);
-    } else {
-      lcdPrintCenter(String(name), 1);
-    }
-  }
-  
+  // Names wider than the display scroll as a marquee
+  DateTimeText third;
   if (lcdRows >= 3 && rtcEnabled) {
-    DateTime now = rtc->now();
-    lcdPrintCenter(getTimeString(now), 2);
+    getTimeString(readRtc(), third);
   } else if (lcdRows >= 3) {
-    lcdPrintCenter("Welcome!", 2);
+    third.add("Welcome!");
   }
+  screens->setMarqueeStep(250);
+  screens->toast(RESULT_HOLD, "ACCESS GRANTED", name, third, nullptr, true);
 }
 
 void FingerprintGSM::lcdShowAccessDenied() {
   if (!lcdEnabled) return;
   
-  lcd->clear();
-  lcdPrintCenter("ACCESS DENIED", 0);
-  
-  if (lcdRows >= 2) {
-    lcdPrintCenter("Unknown User", 1);
-  }
-  
+  DateTimeText third;
   if (lcdRows >= 3 && rtcEnabled) {
-    DateTime now = rtc->now();
-    lcdPrintCenter(getTimeString(now), 2);
-  }
-  
-  // Flash backlight
-  for (int i = 0; i < 3; i++) {
-    lcd->noBacklight();
-    delay(200);
-    lcd->backlight();
-    delay(200);
+    getTimeString(readRtc(), third);
   }
+  // Flash the backlight three times while the toast is up
+  screens->toast(RESULT_HOLD, "ACCESS DENIED", "Unknown User", third, nullptr, true, 3);
 }
 
 void FingerprintGSM::lcdShowEnrolling(uint8_t step) {
   if (!lcdEnabled) return;
   
-  lcd->clear();
-  lcdPrintCenter("ENROLLING", 0);
-  
-  if (lcdRows >= 2) {
-    switch (step) {
-      case 1:
-        lcdPrintCenter("Place Finger", 1);
-        break;
-      case 2:
-        lcdPrintCenter("Remove Finger", 1);
-        break;
-      case 3:
-        lcdPrintCenter("Place Again", 1);
-        break;
-    }
+  const char* prompt = "";
+  switch (step) {
+    case 1:
+      prompt = "Place Finger";
+      break;
+    case 2:
+      prompt = "Remove Finger";
+      break;
+    case 3:
+      prompt = "Place Again";
+      break;
   }
+  // Stays up until the next message; the prompt replaces anything queued
+  screens->toast(0, "ENROLLING", prompt, nullptr, nullptr, true);
 }
 
 void FingerprintGSM::lcdBacklight(bool on) {
   if (!lcdEnabled) return;
-  
-  if (on) {
-    lcd->backlight();
-  } else {
-    lcd->noBacklight();
-  }
+  screens->setBacklight(on);
 }
 
 void FingerprintGSM::lcdUpdateTime() {
@@ -697,40 +1270,42 @@ void FingerprintGSM::lcdUpdateTime() {
   
   if (millis() - lastTimeUpdate >= TIME_UPDATE_INTERVAL) {
     lastTimeUpdate = millis();
-    DateTime now = rtc->now();
+    DateTime now = readRtc();
     
-    // Update time on first row
-    lcd->setCursor(0, 0);
-    String timeStr = getTimeString(now);
-    
-    // Center the time
-    if (timeStr.length() < lcdCols) {
-      uint8_t padding = (lcdCols - timeStr.length()) / 2;
-      for (uint8_t i = 0; i < padding; i++) {
-        lcd->print(" ");
-      }
-    }
-    lcd->print(timeStr);
-    
-    // Fill remaining space
-    for (uint8_t i = timeStr.length() + ((lcdCols - timeStr.length()) / 2); i < lcdCols; i++) {
-      lcd->print(" ");
-    }
+    // Only the digits that changed reach the display
+    DateTimeText timeStr;
+    screens->setBaseLine(0, getTimeString(now, timeStr));
   }
 }
 
 void FingerprintGSM::lcdShowTimeDate() {
   if (!lcdEnabled || !rtcEnabled) return;
   
-  DateTime now = rtc->now();
-  lcd->clear();
-  lcdPrintCenter(getTimeString(now), 0);
-  if (lcdRows >= 2) {
-    lcdPrintCenter(getDateString(now), 1);
-  }
-  if (lcdRows >= 3) {
-    lcdPrintCenter("Temp: " + String(getTemperature(), 1) + "C", 2);
+  DateTime now = readRtc();
+  DateTimeText timeStr;
+  DateTimeText dateStr;
+  TextBuffer<16> temp;
+  if (lcdRows >= 3) temp.format("Temp: %.1fC", getTemperature());
+  lcdShowStatus(getTimeString(now, timeStr), getDateString(now, dateStr), temp);
+}
+
+void FingerprintGSM::printLcdStats() {
+  if (!lcdEnabled) return;
+  
+  Serial.println("\n[LCD] === Display Traffic ===");
+  Serial.print("Screen updates: ");
+  Serial.println(lcdFrame->updates());
+  Serial.print("LCD bytes: ");
+  Serial.println(lcdFrame->lcdBytes());
+  if (lcdFrame->updates() > 0) {
+    uint32_t perUpdate = lcdFrame->lcdBytes() / lcdFrame->updates();
+    Serial.print("Per update: ");
+    Serial.print(perUpdate);
+    Serial.print(" LCD bytes, ~");
+    Serial.print(perUpdate * LcdFrame::I2C_BYTES_PER_LCD_BYTE);
+    Serial.println(" I2C bytes");
   }
+  Serial.println("============================\n");
 }
 
 void FingerprintGSM::setShowTimeOnLCD(bool show) {
@@ -740,12 +1315,126 @@ void FingerprintGSM::setShowTimeOnLCD(bool show) {
   }
 }
 
+// Attendance log
+bool FingerprintGSM::beginLog(const char* partitionLabel) {
+  logEnabled = accessLog->begin(partitionLabel);
+  return logEnabled;
+}
+
+bool FingerprintGSM::logAccess(uint16_t fingerprintID, bool granted) {
+  if (!logEnabled) return false;
+  return accessLog->append(currentEpoch(), fingerprintID, granted ? ACCESS_GRANTED : 0);
+}
+
+bool FingerprintGSM::beginPresence(uint16_t maxIds) {
+  if (maxIds > TemplateStore::MAX_TEMPLATES) maxIds = TemplateStore::MAX_TEMPLATES;
+  if (presence == nullptr) presence = new PresenceIndex(maxIds);
+  if (!presence->begin()) return false;
+  commands->setPresence(presence);
+  
+  for (uint16_t id = users->next(0); id != 0; id = users->next(id)) {
+    presence->setEnrolled(id, true);
+  }
+  return true;
+}
+
+void FingerprintGSM::printPresenceReport() {
+  if (presence == nullptr) return;
+  
+  uint32_t today = currentEpoch() / 86400UL;
+  uint32_t absentees[(TemplateStore::MAX_TEMPLATES + 31) / 32];
+  uint16_t missing = presence->absent(today, absentees);
+  
+  Serial.println("\n[PRES] === Attendance Today ===");
+  Serial.print("Present: ");
+  Serial.print(presence->countPresent(today));
+  Serial.print("/");
+  Serial.println(presence->countEnrolled());
+  Serial.print("Absent: ");
+  Serial.println(missing);
+  for (uint16_t w = 0; w < presence->words(); w++) {
+    for (uint32_t bits = absentees[w]; bits != 0; bits &= bits - 1) {
+      uint16_t id = w * 32 + __builtin_ctz(bits);
+      UserData user;
+      Serial.print("  ID #");
+      Serial.print(id);
+      Serial.print(": ");
+      Serial.println(users->peek(id, user) ? user.name : "?");
+    }
+  }
+  
+  Serial.print("Last 7 days: ");
+  for (int8_t d = PresenceIndex::DAYS - 1; d >= 0; d--) {
+    Serial.print(presence->countPresent(today - d));
+    Serial.print(d > 0 ? " " : "\n");
+  }
+  Serial.print("Every day this week: ");
+  Serial.println(presence->presentEveryDay(today, 5, absentees));
+  Serial.println("============================\n");
+}
+
+bool FingerprintGSM::lookupUser(uint16_t id, const char** name, const char** grade, void* ctx) {
+  // The report runs on one task and copies what it needs before the next call
+  FingerprintGSM* self = (FingerprintGSM*)ctx;
+  if (!self->users->peek(id, self->lookupScratch)) return false;
+  *name = self->lookupScratch.name;
+  *grade = self->lookupScratch.grade;
+  return true;
+}
+
+bool FingerprintGSM::beginReport(uint8_t cutoffHour, uint8_t cutoffMinute, uint8_t lateHour, uint8_t lateMinute) {
+  if (presence == nullptr && !beginPresence()) return false;
+  if (!rtcEnabled) {
+    Serial.println("[REPORT] WARNING: No RTC, the cut-off follows uptime");
+  }
+  
+  if (report == nullptr) {
+    report = new AttendanceReport(presence, outbox, lookupUser, this);
+    if (!report->begin()) return false;
+    if (adminPhone[0] != '\0') report->addRecipient(adminPhone);
+  }
+  report->setCutoff(cutoffHour, cutoffMinute);
+  report->setLateTime(lateHour, lateMinute);
+  return true;
+}
+
+bool FingerprintGSM::addReportRecipient(const char* number, const char* grade) {
+  if (refuseInTaskMode("addReportRecipient")) return false;
+  if (report == nullptr) return false;
+  return report->addRecipient(number, grade);
+}
+
+void FingerprintGSM::sendReportNow() {
+  if (refuseInTaskMode("sendReportNow")) return;
+  if (report != nullptr) report->runNow(currentEpoch());
+}
+
+uint32_t FingerprintGSM::currentEpoch() {
+  if (!rtcEnabled) return millis() / 1000;
+  
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreTake(epochLock, portMAX_DELAY);
+#endif
+  // An I2C read takes far longer than a log append, so read the RTC once a minute
+  unsigned long elapsed = millis() - epochBaseMs;
+  if (epochBase == 0 || elapsed >= 60000) {
+    epochBase = readRtc().unixtime();
+    epochBaseMs = millis();
+    elapsed = 0;
+  }
+  uint32_t epoch = epochBase + elapsed / 1000;
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreGive(epochLock);
+#endif
+  return epoch;
+}
+
 // RTC Functions
 DateTime FingerprintGSM::getCurrentTime() {
   if (!rtcEnabled) {
     return DateTime(2000, 1, 1, 0, 0, 0); // Return default if RTC not available
   }
-  return rtc->now();
+  return readRtc();
 }
 
 bool FingerprintGSM::setTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
@@ -754,13 +1443,21 @@ bool FingerprintGSM::setTime(uint16_t year, uint8_t month, uint8_t day, uint8_t
     return false;
   }
   
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreTake(epochLock, portMAX_DELAY);  // No task may cache a reading from before the change
+#endif
   rtc->adjust(DateTime(year, month, day, hour, minute, second));
+  epochBase = 0;  // Re-read on the next log entry
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreGive(epochLock);
+#endif
+  DateTimeText timeStr;
+  getDateTimeString(readRtc(), timeStr);
   Serial.print("[RTC] Time set to: ");
-  Serial.println(getDateTimeString(rtc->now()));
+  Serial.println(timeStr);
   
   if (lcdEnabled) {
-    lcdShowStatus("Time Set!", getDateTimeString(rtc->now()));
-    delay(2000);
+    lcdToast(2000, "Time Set!", timeStr);
   }
   
   return true;
@@ -772,9 +1469,9 @@ void FingerprintGSM::printCurrentTime() {
     return;
   }
   
-  DateTime now = rtc->now();
+  DateTimeText timeStr;
   Serial.print("[RTC] Current time: ");
-  Serial.println(getDateTimeString(now));
+  Serial.println(getDateTimeString(readRtc(), timeStr));
   Serial.print("[RTC] Temperature: ");
   Serial.print(getTemperature());
   Serial.println("°C");
@@ -786,22 +1483,36 @@ float FingerprintGSM::getTemperature() {
 }
 
 // Helper functions for time formatting
-String FingerprintGSM::getTimeString(DateTime dt) {
-  char buffer[9];
-  sprintf(buffer, "%02d:%02d:%02d", dt.hour(), dt.minute(), dt.second());
-  return String(buffer);
+const char* FingerprintGSM::getTimeString(const DateTime& dt, DateTimeText& buffer) {
+  buffer.clear();
+  return buffer.format("%02d:%02d:%02d", dt.hour(), dt.minute(), dt.second());
+}
+
+const char* FingerprintGSM::getDateString(const DateTime& dt, DateTimeText& buffer) {
+  buffer.clear();
+  return buffer.format("%04d-%02d-%02d", dt.year(), dt.month(), dt.day());
+}
+
+const char* FingerprintGSM::getDateTimeString(const DateTime& dt, DateTimeText& buffer) {
+  buffer.clear();
+  return buffer.format("%04d-%02d-%02d %02d:%02d:%02d",
+                       dt.year(), dt.month(), dt.day(),
+                       dt.hour(), dt.minute(), dt.second());
 }
 
-String FingerprintGSM::getDateString(DateTime dt) {
-  char buffer[11];
-  sprintf(buffer, "%04d-%02d-%02d", dt.year(), dt.month(), dt.day());
-  return String(buffer);
+// RTC time when there is one, otherwise seconds of uptime
+DateTime FingerprintGSM::readRtc() {
+  uint32_t started = latency->start();
+  DateTime now = rtc->now();
+  latency->stop(LatencyStats::STAGE_RTC_READ, started);
+  return now;
 }
 
-String FingerprintGSM::getDateTimeString(DateTime dt) {
-  char buffer[20];
-  sprintf(buffer, "%04d-%02d-%02d %02d:%02d:%02d", 
-          dt.year(), dt.month(), dt.day(),
-          dt.hour(), dt.minute(), dt.second());
-  return String(buffer);
+const char* FingerprintGSM::getTimeStamp(DateTimeText& buffer, bool withDate) {
+  if (!rtcEnabled) {
+    buffer.clear();
+    return buffer.format("%lus", millis() / 1000);
+  }
+  DateTime now = readRtc();
+  return withDate ? getDateTimeString(now, buffer) : getTimeString(now, buffer);
 }
\ No newline at end of file
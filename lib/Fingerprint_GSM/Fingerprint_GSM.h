@@ -15,35 +15,84 @@
 #include <Adafruit_Fingerprint.h>
 #include <LiquidCrystal_I2C.h>
 #include <RTClib.h>
+#include <Preferences.h>
+#include "AtEngine.h"
+#include "SmsOutbox.h"
+#include "SmsDigest.h"
+#include "SpscQueue.h"
+#include "FingerprintLink.h"
+#include "TemplateStore.h"
+#include "TemplatePager.h"
+#include "HotSearch.h"
+#include "AttendanceLog.h"
+#include "PresenceIndex.h"
+#include "AttendanceReport.h"
+#include "UserStore.h"
+#include "SmsCommands.h"
+#include "LatencyStats.h"
+#include "LcdFrame.h"
+#include "LcdCompositor.h"
+#include "TextBuffer.h"
 
-// User data structure
-struct UserData {
-  uint8_t id;
-  char name[32];
-  char phoneNumber[16];
-  bool notifyOnAccess;
+// Scan result handed from the scan task to the GSM and LCD tasks
+struct ScanEvent {
+  unsigned long at;        // millis() when the finger was read
+  uint16_t fingerprintID;  // 0 when no match
+  uint16_t confidence;
+  bool granted;
 };
 
-// Access log structure
-struct AccessLog {
-  uint8_t userId;
-  DateTime timestamp;
-  bool granted;
+// Wake-on-touch counters (see printTouchStats)
+struct TouchStats {
+  uint32_t wakeups;        // Captures started by the touch line
+  uint32_t latencySumUs;   // Touch interrupt -> getImage answered
+  uint32_t latencyMaxUs;
+  uint32_t imageRequests;  // getImage packets sent
+  uint32_t idleImages;     // ... answered "no finger"
+  uint8_t touchMisses;     // Fingers found without a touch interrupt
 };
 
 class FingerprintGSM {
   private:
     HardwareSerial* fingerprintSerial;
     HardwareSerial* gsmSerial;
+    // Owners once startTasks() has run: the scan task has the sensor
+    // (finger, link, templates, pager, hotSearch), the GSM task has the
+    // modem and everything that sends (outbox, digest, commands, report,
+    // accessLog, presence) and the LCD task has lcd, lcdFrame and screens.
+    // Public calls that reach those objects refuse while tasks run.
     Adafruit_Fingerprint* finger;
+    FingerprintLink* link;
+    TemplateStore* templates;
+    TemplatePager* pager;
+    bool pagingEnabled;
+    HotSearch* hotSearch;  // Ranged search when a hot range is set without paging
+    AtEngine* modem;
+    SmsOutbox* outbox;
+    SmsDigest* digest;
+    SmsCommands* commands;  // Inbound SMS commands, answered from poll()
     LiquidCrystal_I2C* lcd;
+    LcdFrame* lcdFrame;  // Shadow of the screen; only changed cells reach the LCD
+    LcdCompositor* screens;  // Base screen and timed toasts drawn into lcdFrame
     RTC_DS3231* rtc;
+    AttendanceLog* accessLog;
+    bool logEnabled;
+    PresenceIndex* presence;  // Created by beginPresence()
+    AttendanceReport* report;  // Created by beginReport()
+    uint32_t epochBase;          // RTC reading used by currentEpoch()
+    unsigned long epochBaseMs;
+#ifdef ARDUINO_ARCH_ESP32
+    SemaphoreHandle_t epochLock;  // The scan and GSM tasks both call currentEpoch()
+#endif
     
-    UserData users[127];  // Store user data for IDs 1-127
-    uint8_t userCount;
+    UserStore* users;       // Flash-resident, see beginUsers()
+    UserData lookupScratch; // Holds the names lookupUser() hands out
     
-    String adminPhone;
+    char adminPhone[AtEngine::NUMBER_MAX];
     bool gsmReady;
+    bool digestMode;
+    bool pduMode;
+    uint8_t pduRef;
     bool lcdEnabled;
     bool rtcEnabled;
     uint8_t lcdCols;
@@ -54,54 +103,192 @@ class FingerprintGSM {
     unsigned long lastTimeUpdate;
     const unsigned long TIME_UPDATE_INTERVAL = 1000; // Update every second
     
+    // Task mode: the scan task produces, the GSM and LCD tasks each consume one queue
+    static const uint16_t EVENT_QUEUE_SIZE = 8;
+    static const uint16_t GSM_TASK_PERIOD = 10;    // ms between modem polls
+    static const uint16_t LCD_TASK_PERIOD = 20;    // ms between screen updates
+    static const unsigned long RESULT_HOLD = 3000; // Keep a scan result before the clock returns
+    static const unsigned long STATUS_HOLD = 2000; // Default toast duration
+    SpscQueue<ScanEvent, EVENT_QUEUE_SIZE> notifyQueue;
+    SpscQueue<ScanEvent, EVENT_QUEUE_SIZE> displayQueue;
+    bool tasksRunning;
+    bool refuseInTaskMode(const char* what);  // Logs and returns true while tasks run
+    bool fingerDown;
+    uint16_t scanInterval;
+    void* scanTaskHandle;
+    
+    // Wake-on-touch: the sensor's touch line starts a capture, polling is the fallback
+    static const uint16_t POLL_MIN = 50;             // ms, while a finger is on or just left
+    static const uint16_t POLL_MAX = 500;            // ms, after a long idle spell
+    static const uint16_t TOUCH_SAFETY_POLL = 2000;  // ms, proves the touch line is really wired
+    static const uint8_t TOUCH_MISS_LIMIT = 3;       // Missed touches before the pin is ignored
+    static const uint8_t IMAGE_PACKET_BYTES = 24;    // getImage command + acknowledge
+    bool touchWake;
+    bool touchWired;
+    int8_t touchPin;  // -1 until enableTouchWake() attaches the interrupt
+    bool fingerPresent;
+    volatile bool touchPending;
+    volatile unsigned long touchAtUs;
+    unsigned long lastCaptureMs;
+    uint16_t pollInterval;
+    TouchStats touchStats;
+    
+    // Stage timing and the serial console that prints it
+    static const uint8_t CONSOLE_LINE_MAX = 32;
+    LatencyStats* latency;
+    bool consoleEnabled;
+    char consoleLine[CONSOLE_LINE_MAX];
+    uint8_t consoleLength;
+    void serviceConsole();
+    
     // GSM helper functions
-    bool sendATCommand(String cmd, String expectedResponse, unsigned long timeout);
+    bool sendATCommand(const char* cmd, unsigned long timeout);
     void waitForGSM();
+    static void onSmsResult(SmsHandle handle, SmsStatus status, void* ctx);
+    bool notifyAccess(uint16_t fingerprintID, bool granted);  // sendAccessNotification() minus the task check
+    static bool lookupUser(uint16_t id, const char** name, const char** grade, void* ctx);
     
     // LCD helper functions
-    void lcdPrintCenter(String text, uint8_t row);
-    void lcdScrollText(String text, uint8_t row, uint16_t delayMs = 300);
+    void lcdTick();  // Advance toasts and effects from blocking loops
     
     // RTC helper functions
-    String getTimeString(DateTime dt);
-    String getDateString(DateTime dt);
-    String getDateTimeString(DateTime dt);
+    // Formatters replace the text in a caller buffer and return it
+    static const uint8_t DATETIME_TEXT_SIZE = 20;
+    typedef TextBuffer<DATETIME_TEXT_SIZE> DateTimeText;
+    const char* getTimeString(const DateTime& dt, DateTimeText& buffer);
+    const char* getDateString(const DateTime& dt, DateTimeText& buffer);
+    const char* getDateTimeString(const DateTime& dt, DateTimeText& buffer);
+    const char* getTimeStamp(DateTimeText& buffer, bool withDate);  // RTC time, else uptime
+    DateTime readRtc();  // rtc->now(), timed
+    uint32_t currentEpoch();
+    
+    // Fingerprint helper functions
+    uint8_t searchFinger(uint16_t* id, uint16_t* score);
+    
+    // Task bodies (never return)
+    bool scanOnce(ScanEvent& event);
+    void scanTask();
+    void gsmTask();
+    void lcdTask();
+    static void scanTaskEntry(void* arg);
+    static void gsmTaskEntry(void* arg);
+    static void lcdTaskEntry(void* arg);
+    
+    // Link negotiation: fastest baud and packet size, remembered in NVS
+    static const uint8_t LINK_CHECKS = 3;  // verifyPassword round trips that must all pass
+    bool linkNegotiation;
+    bool negotiateLink(long defaultBaud);
+    bool probeLink(long baud);
+    bool switchBaud(long from, long to);
+    
+    // Wake-on-touch helpers
+    static void IRAM_ATTR onTouch(void* arg);
+    bool captureDue(bool& woken);
+    unsigned long nextPollDelay();
+    uint8_t captureImage(bool woken);
     
   public:
     // Constructor
     FingerprintGSM(HardwareSerial* fpSerial, HardwareSerial* gsmSerial);
+    // Never delete the system once startTasks() has run: the tasks keep using it
+    ~FingerprintGSM();
     
     // Initialization
     bool beginFingerprint(long baudRate = 57600, uint8_t rxPin = 16, uint8_t txPin = 17);
     bool beginGSM(long baudRate = 9600, uint8_t rxPin = 26, uint8_t txPin = 27);
     bool beginLCD(uint8_t address = 0x27, uint8_t cols = 16, uint8_t rows = 2);
     bool beginRTC();
-    void setAdminPhone(String phone);
+    void setAdminPhone(const char* phone);
+    void setAdminPhone(const String& phone) { setAdminPhone(phone.c_str()); }
+    void setPduMode(bool enabled);  // Call before beginGSM()
+    void setLinkNegotiation(bool enabled);  // Call before beginFingerprint()
     
-    // Fingerprint operations
-    bool enrollFingerprint(uint8_t id);
+    // Fingerprint operations. With template paging, IDs are global (1-2047)
+    // rather than sensor slots.
+    bool enrollFingerprint(uint16_t id);
     int verifyFingerprint();
-    bool deleteFingerprint(uint8_t id);
+    bool deleteFingerprint(uint16_t id);
     uint8_t getTemplateCount();
     void printSensorInfo();
     
-    // User management
-    bool addUser(uint8_t id, const char* name, const char* phoneNumber, bool notify = true);
-    bool removeUser(uint8_t id);
-    UserData* getUser(uint8_t id);
+    // Wake-on-touch (optional): the R30x touch output on `pin` triggers a
+    // capture. With pin < 0, or if the line never fires, polling adapts
+    // between POLL_MIN and POLL_MAX instead.
+    void enableTouchWake(int8_t pin, bool activeHigh = true);
+    const TouchStats& getTouchStats() const { return touchStats; }
+    void printTouchStats();
+    
+    // Latency of each access stage (getImage, image2Tz, search, RTC, LCD,
+    // SMS enqueue and send), log-bucketed; on by default
+    void setLatencyStats(bool enabled);
+    LatencyStats* getLatencyStats() { return latency; }
+    void printLatencyStats();
+    
+    // Serial console, off by default: "stats", "stats reset", "stats on",
+    // "stats off", "touch", "lcd", "paging", "search", "presence", "help".
+    // poll() or the GSM task reads it a line at a time.
+    void setSerialCommands(bool enabled);
+    bool runSerialCommand(const char* line);
+    
+    // Template paging (optional, after beginFingerprint): keep every template
+    // in flash and use the sensor library as a cache of the scheduled ones
+    bool beginTemplatePaging();
+    void setTemplateSchedule(const uint16_t* ids, uint16_t count);
+    void printPagingStats();
+    
+    // Hot-set-first search: library slots [start, start + count) are
+    // searched before the rest, which is searched only on a miss. Enrol the
+    // students expected at this gate under consecutive IDs. With template
+    // paging the pager keeps the scheduled and recently seen templates in
+    // slots 0..count-1 itself and `start` is ignored. count 0 turns it off.
+    void setHotRange(uint16_t start, uint16_t count);
+    void printSearchStats();
+    
+    // User management. Users live in the "users" flash partition and survive
+    // a reboot; beginUsers() indexes them. getUser() copies a user out.
+    bool beginUsers(const char* partitionLabel = "users");
+    bool addUser(uint16_t id, const char* name, const char* phoneNumber, bool notify = true,
+                 const char* grade = "");
+    bool removeUser(uint16_t id);
+    bool getUser(uint16_t id, UserData& user);
+    // Hashed lookups; fill `ids` and return how many matched (at most `max`)
+    uint8_t findUsersByPhone(const char* number, uint16_t* ids, uint8_t max);
+    uint8_t findUsersByName(const char* prefix, uint16_t* ids, uint8_t max);
+    UserStore* getUserStore() { return users; }
     void listUsers();
     
     // GSM operations
-    bool sendSMS(String phoneNumber, String message);
-    bool sendAccessNotification(uint8_t fingerprintID, bool granted);
-    bool sendEnrollmentNotification(uint8_t fingerprintID, const char* name);
-    String readSMS();
-    bool makeCall(String phoneNumber);
+    SmsHandle sendSMS(const char* phoneNumber, const char* message);  // Handle of the last part, 0 if not all parts fit
+    SmsHandle sendSMS(const String& phoneNumber, const String& message) {
+      return sendSMS(phoneNumber.c_str(), message.c_str());
+    }
+    SmsStatus getSmsStatus(SmsHandle handle);
+    uint8_t getPendingSMSCount();
+    void setDigestMode(bool enabled, unsigned long windowMs = 300000, uint8_t maxEvents = 12);
+    bool sendAccessNotification(uint16_t fingerprintID, bool granted);
+    bool sendEnrollmentNotification(uint16_t fingerprintID, const char* name);
+    // Text of the last SMS received (commands included), "" before any
+    const char* readSMS();
+    SmsCommands* getSmsCommands() { return commands; }
+    SmsOutbox* getOutbox() { return outbox; }
+    SmsDigest* getDigest() { return digest; }
+    bool makeCall(const char* phoneNumber);
+    bool makeCall(const String& phoneNumber) { return makeCall(phoneNumber.c_str()); }
     
-    // LCD operations
+    // LCD operations. None of them block: lcdShowStatus() and lcdPrint() set
+    // the base screen, the others show timed toasts over it. poll() (or the
+    // LCD task) expires toasts, scrolls long lines and sends changed cells.
     void lcdClear();
-    void lcdPrint(String text, uint8_t col = 0, uint8_t row = 0);
-    void lcdShowStatus(String line1, String line2 = "", String line3 = "", String line4 = "");
+    void lcdPrint(const char* text, uint8_t col = 0, uint8_t row = 0);
+    void lcdShowStatus(const char* line1, const char* line2 = "", const char* line3 = "", const char* line4 = "");
+    void lcdToast(unsigned long durationMs, const char* line1, const char* line2 = "",
+                  const char* line3 = "", const char* line4 = "");
+    // String versions, kept for existing sketches
+    void lcdPrint(const String& text, uint8_t col = 0, uint8_t row = 0) { lcdPrint(text.c_str(), col, row); }
+    void lcdShowStatus(const String& line1, const String& line2 = "", const String& line3 = "",
+                       const String& line4 = "") {
+      lcdShowStatus(line1.c_str(), line2.c_str(), line3.c_str(), line4.c_str());
+    }
     void lcdShowWelcome();
     void lcdShowAccessGranted(const char* name);
     void lcdShowAccessDenied();
@@ -110,6 +297,7 @@ class FingerprintGSM {
     void lcdUpdateTime();
     void lcdShowTimeDate();
     void setShowTimeOnLCD(bool show);
+    void printLcdStats();
     
     // RTC operations
     DateTime getCurrentTime();
@@ -117,6 +305,36 @@ class FingerprintGSM {
     void printCurrentTime();
     float getTemperature(); // DS3231 has built-in temperature sensor
     
+    // Attendance log (needs the "attlog" partition). logAccess() only copies
+    // into RAM; poll() writes to flash. In task mode the GSM task logs every scan.
+    bool beginLog(const char* partitionLabel = "attlog");
+    bool logAccess(uint16_t fingerprintID, bool granted);
+    AttendanceLog* getAccessLog() { return accessLog; }
+    
+    // Presence index: who was in on each of the last seven days. Matches
+    // update it; registered users form the roster for absentee queries.
+    bool beginPresence(uint16_t maxIds = 128);
+    PresenceIndex* getPresence() { return presence; }
+    void printPresenceReport();
+    
+    // Daily absentee/late SMS per grade, sent at the cut-off time (RTC).
+    // Starts the presence index if needed; the admin phone gets every grade.
+    bool beginReport(uint8_t cutoffHour, uint8_t cutoffMinute, uint8_t lateHour, uint8_t lateMinute);
+    bool addReportRecipient(const char* number, const char* grade = nullptr);
+    void sendReportNow();
+    
+    // Service background work (modem I/O); call from loop()
+    void poll();
+    
+    // Run scanning on core 1 and GSM/LCD work on core 0 as FreeRTOS tasks
+    // (ESP32 only). Add users and set the digest mode first: afterwards the
+    // fingerprint, SMS, call, report and user calls return 0/false (or do
+    // nothing) and log "[TASK] ERROR", and loop() must not call the LCD
+    // functions. poll() becomes a no-op.
+    bool startTasks(uint16_t scanIntervalMs = 20);
+    bool tasksStarted() const { return tasksRunning; }
+    uint32_t getDroppedEvents() const { return notifyQueue.dropCount() + displayQueue.dropCount(); }
+    
     // Utility
     int getFingerprintID();
     uint8_t captureFingerprint(uint8_t slot);
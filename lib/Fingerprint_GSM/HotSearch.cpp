@@ -0,0 +1,86 @@
+/**
+ * @file HotSearch.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Hot-range-first fingerprint search over the sensor library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "HotSearch.h"
+
+HotSearch::HotSearch(FingerprintLink* link) {
+  this->link = link;
+  this->capacity = 0;
+  this->hotStart = 0;
+  this->hotSize = 0;
+  memset(&this->stats, 0, sizeof(this->stats));
+}
+
+void HotSearch::begin(uint16_t capacity) {
+  this->capacity = capacity;
+  setHotRange(hotStart, hotSize);
+}
+
+void HotSearch::setHotRange(uint16_t start, uint16_t count) {
+  if (capacity > 0) {
+    if (start > capacity) start = capacity;
+    if (count > capacity - start) count = capacity - start;
+  }
+  hotStart = start;
+  hotSize = count;
+}
+
+uint8_t HotSearch::searchRange(uint16_t start, uint16_t count, uint16_t* slot, uint16_t* score) {
+  if (count == 0) return FINGERPRINT_NOTFOUND;
+  stats.slotsSum += count;
+  return link->search(1, start, count, slot, score);
+}
+
+uint8_t HotSearch::search(uint16_t* slot, uint16_t* score) {
+  stats.searches++;
+  uint8_t rc = searchRange(hotStart, hotSize, slot, score);
+  if (rc == FINGERPRINT_OK) {
+    stats.hotHits++;
+    return rc;
+  }
+  if (rc != FINGERPRINT_NOTFOUND) return rc;
+
+  // Hot miss: the slots below and above the range
+  rc = searchRange(0, hotSize > 0 ? hotStart : capacity, slot, score);
+  if (rc == FINGERPRINT_NOTFOUND) {
+    uint16_t end = hotStart + hotSize;
+    rc = searchRange(end, hotSize > 0 ? capacity - end : 0, slot, score);
+  }
+  if (rc == FINGERPRINT_OK) {
+    stats.coldHits++;
+  } else if (rc == FINGERPRINT_NOTFOUND) {
+    stats.misses++;
+  }
+  return rc;
+}
+
+void HotSearch::printStats() {
+  Serial.println("\n[FP] === Hot Search ===");
+  Serial.print("Hot range: ");
+  Serial.print(hotStart);
+  Serial.print("-");
+  Serial.print(hotSize > 0 ? hotStart + hotSize - 1 : hotStart);
+  Serial.print(" (");
+  Serial.print(hotSize);
+  Serial.print(" of ");
+  Serial.print(capacity);
+  Serial.println(" slots)");
+  Serial.print("Searches: "); Serial.println(stats.searches);
+  if (stats.searches > 0) {
+    Serial.print("Hot hit rate: ");
+    Serial.print(stats.hotHits * 100UL / stats.searches);
+    Serial.println("%");
+    Serial.print("Slots per search: ");
+    Serial.println(stats.slotsSum / stats.searches);
+  }
+  Serial.print("Cold hits: "); Serial.println(stats.coldHits);
+  Serial.print("Misses: "); Serial.println(stats.misses);
+  Serial.println("============================\n");
+}
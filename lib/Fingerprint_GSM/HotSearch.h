@@ -0,0 +1,59 @@
+/**
+ * @file HotSearch.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Hot-range-first fingerprint search over the sensor library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The R30x compares library templates one by one, so a search costs time
+ * in proportion to the slots it covers. HotSearch first searches a small
+ * range of slots (the students expected at this gate, enrolled under
+ * consecutive IDs) and searches the rest of the library only on a miss.
+ * Without template paging the slot is the fingerprint ID, so the range is
+ * fixed; TemplatePager keeps its own hot region filled instead.
+ */
+#ifndef HOT_SEARCH_H
+#define HOT_SEARCH_H
+
+#include <Arduino.h>
+#include "FingerprintLink.h"
+
+struct HotSearchStats {
+  uint32_t searches;
+  uint32_t hotHits;    // Found in the hot range
+  uint32_t coldHits;   // Found in the rest of the library
+  uint32_t misses;
+  uint32_t slotsSum;   // Slots covered, for the average per search
+};
+
+class HotSearch {
+  public:
+    HotSearch(FingerprintLink* link);
+
+    // Library slots 0..capacity-1
+    void begin(uint16_t capacity);
+    // Search slots [start, start + count) first; count 0 searches the whole
+    // library at once
+    void setHotRange(uint16_t start, uint16_t count);
+    uint16_t hotCount() const { return hotSize; }
+
+    // Features must already be in CharBuffer1 (image2Tz). Returns
+    // FINGERPRINT_OK with the slot, FINGERPRINT_NOTFOUND, or a link error.
+    uint8_t search(uint16_t* slot, uint16_t* score);
+
+    const HotSearchStats& getStats() const { return stats; }
+    void printStats();
+
+  private:
+    FingerprintLink* link;
+    uint16_t capacity;
+    uint16_t hotStart;
+    uint16_t hotSize;
+    HotSearchStats stats;
+
+    uint8_t searchRange(uint16_t start, uint16_t count, uint16_t* slot, uint16_t* score);
+};
+
+#endif
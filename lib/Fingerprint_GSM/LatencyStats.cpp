@@ -0,0 +1,105 @@
+/**
+ * @file LatencyStats.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Per-stage latency histograms for the access pipeline
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "LatencyStats.h"
+#include "TextBuffer.h"
+
+static const char* const STAGE_NAMES[LatencyStats::STAGE_COUNT] = {
+  "getImage", "image2Tz", "search", "RTC read", "LCD update", "SMS enqueue", "SMS send"
+};
+
+LatencyStats::LatencyStats() {
+  this->cyclesPerUs = 1;
+  this->on = false;
+  reset();
+  setEnabled(true);
+}
+
+void LatencyStats::setEnabled(bool enabled) {
+#ifdef ARDUINO_ARCH_ESP32
+  // Read once: the clock does not change while the pipeline runs
+  cyclesPerUs = ESP.getCpuFreqMHz();
+#endif
+  on = enabled;
+}
+
+void LatencyStats::reset() {
+  memset(stages, 0, sizeof(stages));
+}
+
+void LatencyStats::record(Stage stage, uint32_t us) {
+  Histogram& h = stages[stage];
+  uint8_t b = us == 0 ? 0 : 32 - __builtin_clz(us);
+  if (b >= BUCKETS) b = BUCKETS - 1;
+  h.buckets[b]++;
+  h.count++;
+  h.sum += us;
+  if (us > h.max) h.max = us;
+}
+
+uint32_t LatencyStats::averageUs(Stage stage) const {
+  const Histogram& h = stages[stage];
+  return h.count == 0 ? 0 : (uint32_t)(h.sum / h.count);
+}
+
+uint32_t LatencyStats::percentileUs(Stage stage, uint8_t percent) const {
+  const Histogram& h = stages[stage];
+  if (h.count == 0) return 0;
+  uint32_t rank = (uint32_t)(((uint64_t)h.count * percent + 99) / 100);
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < BUCKETS; b++) {
+    seen += h.buckets[b];
+    if (seen >= rank) {
+      // Never report more than was actually seen; the last bucket is open
+      if (b == BUCKETS - 1) return h.max;
+      uint32_t bound = b == 0 ? 0 : (1UL << b) - 1;
+      return bound < h.max ? bound : h.max;
+    }
+  }
+  return h.max;
+}
+
+const char* LatencyStats::stageName(Stage stage) {
+  return stage < STAGE_COUNT ? STAGE_NAMES[stage] : "?";
+}
+
+void LatencyStats::print() {
+  Serial.println("\n[STATS] === Access Pipeline Latency (us) ===");
+  if (!on) Serial.println("(recording is off)");
+
+  TextBuffer<80> line;
+  line.format("%-12s %8s %8s %8s %8s %8s %9s", "Stage", "Count", "Avg", "p50", "p90", "p99", "Max");
+  Serial.println(line);
+  for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+    Stage stage = (Stage)s;
+    line.clear();
+    line.format("%-12s %8lu %8lu %8lu %8lu %8lu %9lu", stageName(stage),
+                (unsigned long)count(stage), (unsigned long)averageUs(stage),
+                (unsigned long)percentileUs(stage, 50), (unsigned long)percentileUs(stage, 90),
+                (unsigned long)percentileUs(stage, 99), (unsigned long)maxUs(stage));
+    Serial.println(line);
+  }
+
+  // Buckets as "<upper bound>:count", so the shape of each stage shows
+  Serial.println("Histograms (< us:count):");
+  for (uint8_t s = 0; s < STAGE_COUNT; s++) {
+    const Histogram& h = stages[s];
+    if (h.count == 0) continue;
+    TextBuffer<256> hist;
+    hist.format("%-12s", stageName((Stage)s));
+    for (uint8_t b = 0; b < BUCKETS; b++) {
+      if (h.buckets[b] == 0) continue;
+      if (b == BUCKETS - 1) hist.format(" >=%lu:%lu", 1UL << (b - 1), (unsigned long)h.buckets[b]);
+      else hist.format(" %lu:%lu", 1UL << b, (unsigned long)h.buckets[b]);
+    }
+    Serial.println(hist);
+  }
+  Serial.println("============================\n");
+}
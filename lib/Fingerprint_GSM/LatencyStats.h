@@ -0,0 +1,89 @@
+/**
+ * @file LatencyStats.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Per-stage latency histograms for the access pipeline
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Each stage keeps a count, sum and maximum plus a histogram with one bucket
+ * per power of two microseconds. A sample is a CPU cycle counter read at
+ * each end of the span, one division and a count-leading-zeros, well under
+ * a microsecond, so the stages stay instrumented in the field. The cycle
+ * counter is per core and wraps after about 17 s at 240 MHz: start() and
+ * stop() belong on the same task, and longer spans (an SMS waiting for the
+ * network) are measured elsewhere and handed to record().
+ *
+ * Each stage is recorded by one task. Counters are not atomic, so a stage
+ * fed from two tasks may rarely lose a sample, which a histogram can bear.
+ */
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <Arduino.h>
+
+class LatencyStats {
+  public:
+    enum Stage : uint8_t {
+      STAGE_GET_IMAGE = 0,  // getImage, finger on or not
+      STAGE_IMAGE_TO_TZ,    // image2Tz
+      STAGE_SEARCH,         // fingerSearch, or the template pager
+      STAGE_RTC_READ,       // DS3231 read over I2C
+      STAGE_LCD_UPDATE,     // Screen flush that sent changed cells
+      STAGE_SMS_ENQUEUE,    // Building and queueing an access notification
+      STAGE_SMS_SEND,       // Queued in the modem -> +CMGS or failure
+      STAGE_COUNT
+    };
+
+    // Bucket 0 is under 1 us; bucket b >= 1 holds 2^(b-1) .. 2^b - 1 us.
+    // The last one also takes everything above 2^26 us (67 s).
+    static const uint8_t BUCKETS = 28;
+
+    LatencyStats();
+
+    void setEnabled(bool enabled);
+    bool enabled() const { return on; }
+    void reset();
+
+    // Open a span; 0 when disabled (stop() then records nothing)
+    uint32_t start() const { return on ? cycles() | 1 : 0; }
+    // Close a span opened by start() on the same task
+    void stop(Stage stage, uint32_t started) {
+      if (started != 0) record(stage, (cycles() - started) / cyclesPerUs);
+    }
+    void record(Stage stage, uint32_t us);
+
+    uint32_t count(Stage stage) const { return stages[stage].count; }
+    uint32_t maxUs(Stage stage) const { return stages[stage].max; }
+    uint32_t averageUs(Stage stage) const;
+    // Upper bound of the bucket holding the `percent`th percentile
+    uint32_t percentileUs(Stage stage, uint8_t percent) const;
+    uint32_t bucket(Stage stage, uint8_t index) const { return stages[stage].buckets[index]; }
+    static const char* stageName(Stage stage);
+
+    // Table of every stage, then the non-empty buckets of each
+    void print();
+
+  private:
+    struct Histogram {
+      uint32_t count;
+      uint32_t max;
+      uint64_t sum;
+      uint32_t buckets[BUCKETS];
+    };
+
+    Histogram stages[STAGE_COUNT];
+    uint32_t cyclesPerUs;
+    bool on;
+
+    static uint32_t cycles() {
+#ifdef ARDUINO_ARCH_ESP32
+      return ESP.getCycleCount();
+#else
+      return micros();
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @file LcdCompositor.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Non-blocking LCD screens: a base screen with timed toasts above it
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "LcdCompositor.h"
+
+LcdCompositor::LcdCompositor(LcdFrame* frame, LiquidCrystal_I2C* lcd, uint8_t cols, uint8_t rows) {
+  this->frame = frame;
+  this->lcd = lcd;
+  this->cols = cols < LcdFrame::MAX_COLS ? cols : LcdFrame::MAX_COLS;
+  this->rows = rows < LcdFrame::MAX_ROWS ? rows : LcdFrame::MAX_ROWS;
+  this->toastHead = 0;
+  this->toastCount = 0;
+  this->shownAt = 0;
+  this->changed = false;
+  this->marqueeStep = MARQUEE_STEP;
+  this->marqueeOffset = 0;
+  this->marqueeAt = 0;
+  this->backlightOn = true;
+  this->blinkLit = true;
+  this->blinkEdges = 0;
+  this->blinkAt = 0;
+  memset(&this->base, 0, sizeof(this->base));
+}
+
+void LcdCompositor::setLine(Screen& screen, uint8_t row, const char* text, bool center) {
+  if (row >= LcdFrame::MAX_ROWS) return;
+  strncpy(screen.lines[row], text != nullptr ? text : "", LINE_MAX);
+  screen.lines[row][LINE_MAX] = '\0';
+  if (center) {
+    screen.centered |= 1 << row;
+  } else {
+    screen.centered &= ~(1 << row);
+  }
+}
+
+void LcdCompositor::setBaseLine(uint8_t row, const char* text) {
+  setLine(base, row, text, true);
+  if (toastCount == 0) changed = true;
+}
+
+void LcdCompositor::setBaseText(uint8_t col, uint8_t row, const char* text) {
+  if (row >= LcdFrame::MAX_ROWS) return;
+
+  // A centered line is first laid out as it appears on the display
+  char* line = base.lines[row];
+  size_t len = strlen(line);
+  if ((base.centered & (1 << row)) && len < cols) {
+    uint8_t pad = (cols - len) / 2;
+    memmove(line + pad, line, len + 1);
+    memset(line, ' ', pad);
+    len += pad;
+  }
+
+  // Overwrite in place, padding with spaces up to `col`
+  for (; len < col && len < LINE_MAX; len++) line[len] = ' ';
+  for (; *text != '\0' && col < LINE_MAX; col++, text++) {
+    line[col] = *text;
+    if (col >= len) len = col + 1;
+  }
+  line[len] = '\0';
+  base.centered &= ~(1 << row);
+  if (toastCount == 0) changed = true;
+}
+
+void LcdCompositor::clearBase() {
+  memset(&base, 0, sizeof(base));
+  if (toastCount == 0) changed = true;
+}
+
+void LcdCompositor::toast(unsigned long durationMs, const char* line1, const char* line2,
+                          const char* line3, const char* line4, bool preempt, uint8_t blinks) {
+  if (preempt) toastCount = 0;
+
+  // When every slot is taken the newest queued toast is replaced
+  uint8_t slot;
+  if (toastCount < TOAST_SLOTS) {
+    slot = (toastHead + toastCount) % TOAST_SLOTS;
+    toastCount++;
+  } else {
+    slot = (toastHead + TOAST_SLOTS - 1) % TOAST_SLOTS;
+  }
+
+  Screen& screen = toasts[slot];
+  setLine(screen, 0, line1, true);
+  setLine(screen, 1, line2, true);
+  setLine(screen, 2, line3, true);
+  setLine(screen, 3, line4, true);
+  screen.durationMs = durationMs;
+  screen.blinks = blinks;
+
+  if (toastCount == 1) {
+    activate();
+  } else if (toasts[toastHead].durationMs == 0) {
+    // An open-ended toast gives way as soon as another one arrives
+    toastHead = (toastHead + 1) % TOAST_SLOTS;
+    toastCount--;
+    activate();
+  }
+}
+
+void LcdCompositor::clearToasts() {
+  if (toastCount == 0) return;
+  toastCount = 0;
+  activate();
+}
+
+void LcdCompositor::setBacklight(bool on) {
+  backlightOn = on;
+  if (blinkEdges > 0) return;  // Restored when the effect ends
+  blinkLit = on;
+  if (on) {
+    lcd->backlight();
+  } else {
+    lcd->noBacklight();
+  }
+}
+
+void LcdCompositor::activate() {
+  shownAt = millis();
+  marqueeOffset = 0;
+  marqueeAt = shownAt;
+
+  // A blink cut short by the next screen must not leave the light off
+  blinkEdges = toastCount > 0 ? visible().blinks * 2 : 0;
+  blinkAt = shownAt - BLINK_PERIOD;
+  if (blinkEdges == 0 && blinkLit != backlightOn) setBacklight(backlightOn);
+
+  render();
+  frame->flush();
+}
+
+void LcdCompositor::render() {
+  Screen& screen = visible();
+  char buffer[LcdFrame::MAX_COLS + 1];
+
+  for (uint8_t row = 0; row < rows; row++) {
+    const char* line = screen.lines[row];
+    size_t len = strlen(line);
+
+    if (len > cols) {
+      // Marquee: a window over the line followed by a short gap, repeating
+      uint32_t period = len + MARQUEE_GAP;
+      for (uint8_t col = 0; col < cols; col++) {
+        uint32_t index = (marqueeOffset + col) % period;
+        buffer[col] = index < len ? line[index] : ' ';
+      }
+      buffer[cols] = '\0';
+      frame->print(0, row, buffer);
+    } else if (screen.centered & (1 << row)) {
+      frame->printCenter(row, line);
+    } else {
+      memcpy(buffer, line, len);
+      memset(buffer + len, ' ', cols - len);
+      buffer[cols] = '\0';
+      frame->print(0, row, buffer);
+    }
+  }
+  changed = false;
+}
+
+void LcdCompositor::tick() {
+  unsigned long now = millis();
+
+  if (toastCount > 0) {
+    const Screen& top = toasts[toastHead];
+    if ((top.durationMs > 0 && now - shownAt >= top.durationMs) ||
+        (top.durationMs == 0 && toastCount > 1)) {
+      toastHead = (toastHead + 1) % TOAST_SLOTS;
+      toastCount--;
+      activate();
+      return;
+    }
+  }
+
+  if (now - marqueeAt >= marqueeStep) {
+    const Screen& screen = visible();
+    for (uint8_t row = 0; row < rows; row++) {
+      if (strlen(screen.lines[row]) > cols) {
+        marqueeAt = now;
+        marqueeOffset++;
+        changed = true;
+        break;
+      }
+    }
+  }
+
+  if (blinkEdges > 0 && now - blinkAt >= BLINK_PERIOD) {
+    blinkAt = now;
+    blinkEdges--;
+    blinkLit = blinkEdges == 0 ? backlightOn : !blinkLit;
+    if (blinkLit) {
+      lcd->backlight();
+    } else {
+      lcd->noBacklight();
+    }
+  }
+
+  if (changed) render();
+  frame->poll();
+}
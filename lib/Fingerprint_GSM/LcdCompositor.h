@@ -0,0 +1,89 @@
+/**
+ * @file LcdCompositor.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Non-blocking LCD screens: a base screen with timed toasts above it
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The base screen (clock, status) is always at the bottom. Toasts are
+ * stacked over it in arrival order and each stays up for its own duration,
+ * counted from the moment it becomes visible; then the next one, or the
+ * base screen, shows again. Lines wider than the display scroll as a
+ * marquee and toasts can blink the backlight. All of it is advanced by
+ * tick(), so nothing here ever calls delay().
+ */
+#ifndef LCD_COMPOSITOR_H
+#define LCD_COMPOSITOR_H
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+#include "LcdFrame.h"
+
+class LcdCompositor {
+  public:
+    static const uint8_t LINE_MAX = 40;
+    static const uint8_t TOAST_SLOTS = 6;
+    static const uint16_t MARQUEE_STEP = 300;  // ms per column
+    static const uint8_t MARQUEE_GAP = 4;      // Blank columns between repeats
+    static const uint16_t BLINK_PERIOD = 200;  // ms per backlight edge
+
+    LcdCompositor(LcdFrame* frame, LiquidCrystal_I2C* lcd, uint8_t cols, uint8_t rows);
+
+    // Base screen. Centered lines unless written with setBaseText().
+    void setBaseLine(uint8_t row, const char* text);
+    void setBaseText(uint8_t col, uint8_t row, const char* text);
+    void clearBase();
+
+    // Show a toast for `durationMs`; 0 keeps it up until the next toast
+    // arrives. `preempt` drops everything still queued (scan results).
+    // `blinks` flashes the backlight that many times while it is up.
+    void toast(unsigned long durationMs, const char* line1, const char* line2 = nullptr,
+               const char* line3 = nullptr, const char* line4 = nullptr,
+               bool preempt = false, uint8_t blinks = 0);
+    void clearToasts();
+    bool toastShowing() const { return toastCount > 0; }
+
+    void setBacklight(bool on);
+    void setMarqueeStep(uint16_t ms) { marqueeStep = ms; }
+
+    // Expire toasts, step marquees and effects, flush the frame
+    void tick();
+
+  private:
+    struct Screen {
+      char lines[LcdFrame::MAX_ROWS][LINE_MAX + 1];
+      uint8_t centered;              // One bit per row
+      unsigned long durationMs;
+      uint8_t blinks;
+    };
+
+    LcdFrame* frame;
+    LiquidCrystal_I2C* lcd;
+    uint8_t cols;
+    uint8_t rows;
+
+    Screen base;
+    Screen toasts[TOAST_SLOTS];      // Ring, toastHead is the visible one
+    uint8_t toastHead;
+    uint8_t toastCount;
+    unsigned long shownAt;           // When the visible screen appeared
+
+    bool changed;
+    uint16_t marqueeStep;
+    uint32_t marqueeOffset;
+    unsigned long marqueeAt;
+
+    bool backlightOn;                // Level outside of effects
+    bool blinkLit;
+    uint8_t blinkEdges;              // Backlight toggles still to do
+    unsigned long blinkAt;
+
+    Screen& visible() { return toastCount > 0 ? toasts[toastHead] : base; }
+    void activate();
+    void render();
+    void setLine(Screen& screen, uint8_t row, const char* text, bool center);
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file LcdFrame.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Shadow framebuffer for the I2C character LCD
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "LcdFrame.h"
+
+LcdFrame::LcdFrame(LiquidCrystal_I2C* lcd, uint8_t cols, uint8_t rows) {
+  this->lcd = lcd;
+  this->cols = cols < MAX_COLS ? cols : MAX_COLS;
+  this->rows = rows < MAX_ROWS ? rows : MAX_ROWS;
+  this->dirtyRows = 0;
+  this->lastFlush = 0;
+  this->sentBytes = 0;
+  this->sentUpdates = 0;
+  memset(back, ' ', sizeof(back));
+  memset(front, ' ', sizeof(front));
+}
+
+void LcdFrame::put(uint8_t col, uint8_t row, char c) {
+  if (back[row][col] == c) return;
+  back[row][col] = c;
+
+  uint8_t bit = 1 << row;
+  if (!(dirtyRows & bit)) {
+    dirtyRows |= bit;
+    dirtyFrom[row] = col;
+    dirtyTo[row] = col;
+  } else if (col < dirtyFrom[row]) {
+    dirtyFrom[row] = col;
+  } else if (col > dirtyTo[row]) {
+    dirtyTo[row] = col;
+  }
+}
+
+void LcdFrame::clear() {
+  for (uint8_t row = 0; row < rows; row++) clearRow(row);
+}
+
+void LcdFrame::clearRow(uint8_t row) {
+  if (row >= rows) return;
+  for (uint8_t col = 0; col < cols; col++) put(col, row, ' ');
+}
+
+void LcdFrame::print(uint8_t col, uint8_t row, const char* text) {
+  if (row >= rows) return;
+  for (; col < cols && *text != '\0'; col++, text++) put(col, row, *text);
+}
+
+void LcdFrame::printCenter(uint8_t row, const char* text) {
+  if (row >= rows) return;
+  size_t len = strlen(text);
+  uint8_t start = len >= cols ? 0 : (cols - len) / 2;
+
+  for (uint8_t col = 0; col < start; col++) put(col, row, ' ');
+  print(start, row, text);
+  for (uint8_t col = start + (len < cols ? len : cols); col < cols; col++) put(col, row, ' ');
+}
+
+void LcdFrame::poll() {
+  if (dirtyRows != 0 && millis() - lastFlush >= FRAME_INTERVAL) flush();
+}
+
+void LcdFrame::flush() {
+  lastFlush = millis();
+  if (dirtyRows == 0) return;
+
+  uint32_t before = sentBytes;
+  for (uint8_t row = 0; row < rows; row++) {
+    if (!(dirtyRows & (1 << row))) continue;
+
+    // The display's cursor moves right after each character, so a new
+    // setCursor is needed only where a run of changed cells begins. A
+    // one-cell gap costs the same either way; rewriting it saves a command.
+    int16_t cursor = -1;
+    for (uint8_t col = dirtyFrom[row]; col <= dirtyTo[row]; col++) {
+      if (back[row][col] == front[row][col]) continue;
+
+      if (cursor >= 0 && col - cursor == 1) {
+        lcd->write((uint8_t)front[row][cursor]);
+        sentBytes++;
+      } else if (cursor != col) {
+        lcd->setCursor(col, row);
+        sentBytes++;
+      }
+      lcd->write((uint8_t)back[row][col]);
+      front[row][col] = back[row][col];
+      sentBytes++;
+      cursor = col + 1;
+    }
+  }
+  dirtyRows = 0;
+  if (sentBytes != before) sentUpdates++;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file LcdFrame.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Shadow framebuffer for the I2C character LCD
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Drawing only changes a RAM copy of the screen. flush() compares it with
+ * what the display already shows and sends just the changed cells, moving
+ * the cursor only where a run of changes starts. The display is never
+ * cleared, so there is no flicker and no 2 ms clear command.
+ */
+#ifndef LCD_FRAME_H
+#define LCD_FRAME_H
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+
+class LcdFrame {
+  public:
+    static const uint8_t MAX_COLS = 20;
+    static const uint8_t MAX_ROWS = 4;
+    static const uint16_t FRAME_INTERVAL = 50;      // ms, 20 frames per second
+    static const uint8_t I2C_BYTES_PER_LCD_BYTE = 12;  // 2 nibbles x 3 PCF8574 writes x (address + data)
+
+    // The display must have just been initialised (blank)
+    LcdFrame(LiquidCrystal_I2C* lcd, uint8_t cols, uint8_t rows);
+
+    // Drawing (RAM only). Text is clipped at the right edge.
+    void clear();
+    void clearRow(uint8_t row);
+    void print(uint8_t col, uint8_t row, const char* text);
+    // Blank the row and center `text` on it
+    void printCenter(uint8_t row, const char* text);
+
+    // Flush when FRAME_INTERVAL has passed since the last flush
+    void poll();
+    // Send changed cells now
+    void flush();
+
+    // Characters plus commands sent to the display, and flushes that sent any
+    uint32_t lcdBytes() const { return sentBytes; }
+    uint32_t updates() const { return sentUpdates; }
+
+  private:
+    LiquidCrystal_I2C* lcd;
+    uint8_t cols;
+    uint8_t rows;
+    char back[MAX_ROWS][MAX_COLS];   // What should be on the screen
+    char front[MAX_ROWS][MAX_COLS];  // What is on the screen
+    uint8_t dirtyFrom[MAX_ROWS];     // Columns that may differ, per row
+    uint8_t dirtyTo[MAX_ROWS];
+    uint8_t dirtyRows;               // One bit per row
+    unsigned long lastFlush;
+    uint32_t sentBytes;
+    uint32_t sentUpdates;
+
+    void put(uint8_t col, uint8_t row, char c);
+};
+
+#endif
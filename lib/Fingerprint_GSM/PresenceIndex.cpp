@@ -0,0 +1,219 @@
+/**
+ * @file PresenceIndex.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Per-day presence bitsets with first-in / last-out minutes
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "PresenceIndex.h"
+
+// File layout: header, bitset, first-in minutes, last-out minutes
+struct PresenceFileHeader {
+  uint32_t day;
+  uint16_t maxIds;
+  uint16_t reserved;
+};
+
+PresenceIndex::PresenceIndex(uint16_t maxIds) {
+  this->maxIds = maxIds;
+  this->wordCount = (maxIds + 31) / 32;
+  this->enrolled = new uint32_t[wordCount];
+  this->bits = new uint32_t[DAYS * wordCount];
+  this->firstIn = new uint16_t[maxIds];
+  this->lastOut = new uint16_t[maxIds];
+  this->today = 0;
+  this->dirty = false;
+  this->lastPersist = 0;
+
+  memset(enrolled, 0, wordCount * sizeof(uint32_t));
+  memset(bits, 0, DAYS * wordCount * sizeof(uint32_t));
+  memset(firstIn, 0xFF, maxIds * sizeof(uint16_t));
+  memset(lastOut, 0xFF, maxIds * sizeof(uint16_t));
+  for (uint8_t i = 0; i < DAYS; i++) dayOf[i] = 0;
+}
+
+PresenceIndex::~PresenceIndex() {
+  delete[] enrolled;
+  delete[] bits;
+  delete[] firstIn;
+  delete[] lastOut;
+}
+
+void PresenceIndex::fileName(uint32_t day, char* name) const {
+  sprintf(name, "/presence%u.bin", (unsigned)(day % DAYS));
+}
+
+bool PresenceIndex::begin() {
+  if (!LittleFS.begin(true)) {
+    Serial.println("[PRES] ERROR: Cannot mount flash storage");
+    return false;
+  }
+
+  for (uint8_t i = 0; i < DAYS; i++) {
+    char name[20];
+    fileName(i, name);
+    File file = LittleFS.open(name, "r");
+    if (!file) continue;
+
+    PresenceFileHeader header;
+    if (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.maxIds == maxIds) {
+      file.read((uint8_t*)slot(header.day), wordCount * sizeof(uint32_t));
+      dayOf[header.day % DAYS] = header.day;
+      if (header.day > today) today = header.day;
+    }
+    file.close();
+  }
+
+  // Today's minutes come back too, in case of a reboot during the day
+  if (today != 0) {
+    char name[20];
+    fileName(today, name);
+    File file = LittleFS.open(name, "r");
+    if (file) {
+      file.seek(sizeof(PresenceFileHeader) + wordCount * sizeof(uint32_t));
+      file.read((uint8_t*)firstIn, maxIds * sizeof(uint16_t));
+      file.read((uint8_t*)lastOut, maxIds * sizeof(uint16_t));
+      file.close();
+    }
+  }
+  return true;
+}
+
+void PresenceIndex::setEnrolled(uint16_t id, bool on) {
+  if (id >= maxIds) return;
+  if (on) {
+    enrolled[id >> 5] |= 1UL << (id & 31);
+  } else {
+    enrolled[id >> 5] &= ~(1UL << (id & 31));
+  }
+}
+
+void PresenceIndex::startDay(uint32_t day) {
+  if (dirty) save();
+
+  memset(slot(day), 0, wordCount * sizeof(uint32_t));
+  dayOf[day % DAYS] = day;
+  memset(firstIn, 0xFF, maxIds * sizeof(uint16_t));
+  memset(lastOut, 0xFF, maxIds * sizeof(uint16_t));
+  today = day;
+  dirty = true;
+}
+
+void PresenceIndex::mark(uint16_t id, uint32_t epoch) {
+  if (id >= maxIds) return;
+
+  uint32_t day = epoch / 86400UL;
+  if (day != today) {
+    if (day < today) return;  // Clock went backwards; keep today intact
+    startDay(day);
+  }
+
+  uint16_t minute = (epoch % 86400UL) / 60;
+  slot(day)[id >> 5] |= 1UL << (id & 31);
+  if (firstIn[id] == NO_MINUTE) firstIn[id] = minute;
+  lastOut[id] = minute;
+  dirty = true;
+}
+
+bool PresenceIndex::save() {
+  char name[20];
+  fileName(today, name);
+  File file = LittleFS.open(name, "w");
+  if (!file) return false;
+
+  PresenceFileHeader header = {today, maxIds, 0};
+  file.write((const uint8_t*)&header, sizeof(header));
+  file.write((const uint8_t*)slot(today), wordCount * sizeof(uint32_t));
+  file.write((const uint8_t*)firstIn, maxIds * sizeof(uint16_t));
+  file.write((const uint8_t*)lastOut, maxIds * sizeof(uint16_t));
+  file.close();
+
+  dirty = false;
+  lastPersist = millis();
+  return true;
+}
+
+void PresenceIndex::poll() {
+  if (dirty && today != 0 && millis() - lastPersist >= PERSIST_INTERVAL) {
+    save();
+  }
+}
+
+void PresenceIndex::flush() {
+  if (dirty && today != 0) save();
+}
+
+const uint32_t* PresenceIndex::presentOn(uint32_t day) const {
+  if (day == 0 || dayOf[day % DAYS] != day) return nullptr;
+  return bits + (day % DAYS) * wordCount;
+}
+
+bool PresenceIndex::isPresent(uint16_t id, uint32_t day) const {
+  const uint32_t* set = presentOn(day);
+  if (set == nullptr || id >= maxIds) return false;
+  return set[id >> 5] & (1UL << (id & 31));
+}
+
+uint16_t PresenceIndex::countPresent(uint32_t day) const {
+  const uint32_t* set = presentOn(day);
+  if (set == nullptr) return 0;
+  uint16_t total = 0;
+  for (uint16_t w = 0; w < wordCount; w++) total += __builtin_popcount(set[w]);
+  return total;
+}
+
+uint16_t PresenceIndex::countEnrolled() const {
+  uint16_t total = 0;
+  for (uint16_t w = 0; w < wordCount; w++) total += __builtin_popcount(enrolled[w]);
+  return total;
+}
+
+uint16_t PresenceIndex::absent(uint32_t day, uint32_t* out) const {
+  const uint32_t* set = presentOn(day);
+  uint16_t total = 0;
+  for (uint16_t w = 0; w < wordCount; w++) {
+    out[w] = enrolled[w] & ~(set != nullptr ? set[w] : 0);
+    total += __builtin_popcount(out[w]);
+  }
+  return total;
+}
+
+uint16_t PresenceIndex::presentEveryDay(uint32_t lastDay, uint8_t days, uint32_t* out) const {
+  memcpy(out, enrolled, wordCount * sizeof(uint32_t));
+  for (uint8_t d = 0; d < days && d < DAYS; d++) {
+    const uint32_t* set = presentOn(lastDay - d);
+    for (uint16_t w = 0; w < wordCount; w++) {
+      out[w] &= set != nullptr ? set[w] : 0;
+    }
+  }
+  uint16_t total = 0;
+  for (uint16_t w = 0; w < wordCount; w++) total += __builtin_popcount(out[w]);
+  return total;
+}
+
+bool PresenceIndex::minutes(uint16_t id, uint32_t day, uint16_t* first, uint16_t* last) {
+  *first = NO_MINUTE;
+  *last = NO_MINUTE;
+  if (!isPresent(id, day)) return false;
+
+  if (day == today) {
+    *first = firstIn[id];
+    *last = lastOut[id];
+    return true;
+  }
+
+  char name[20];
+  fileName(day, name);
+  File file = LittleFS.open(name, "r");
+  if (!file) return false;
+  uint32_t base = sizeof(PresenceFileHeader) + wordCount * sizeof(uint32_t);
+  file.seek(base + id * sizeof(uint16_t));
+  file.read((uint8_t*)first, sizeof(uint16_t));
+  file.seek(base + (maxIds + id) * sizeof(uint16_t));
+  file.read((uint8_t*)last, sizeof(uint16_t));
+  file.close();
+  return true;
+}
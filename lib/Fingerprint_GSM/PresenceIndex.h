@@ -0,0 +1,77 @@
+/**
+ * @file PresenceIndex.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Per-day presence bitsets with first-in / last-out minutes
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * One bit per fingerprint ID per day, for the last seven days, plus the
+ * first and last scan minute of every ID for today. "How many came" is a
+ * popcount and "who is absent" is roster AND NOT present, a few dozen word
+ * operations however many scans there were. Each day is persisted to its
+ * own LittleFS file, at most once a minute.
+ */
+#ifndef PRESENCE_INDEX_H
+#define PRESENCE_INDEX_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+class PresenceIndex {
+  public:
+    static const uint8_t DAYS = 7;
+    static const uint16_t NO_MINUTE = 0xFFFF;
+    static const unsigned long PERSIST_INTERVAL = 60000;
+
+    // IDs 0..maxIds-1 are tracked
+    PresenceIndex(uint16_t maxIds = 128);
+    ~PresenceIndex();
+
+    // Load the last seven days from flash
+    bool begin();
+
+    void setEnrolled(uint16_t id, bool enrolled);
+    // Record a scan at `epoch` (local unixtime)
+    void mark(uint16_t id, uint32_t epoch);
+    // Write today's file if it changed and PERSIST_INTERVAL has passed
+    void poll();
+    void flush();
+
+    uint16_t words() const { return wordCount; }
+    // Bitset for `day` (epoch / 86400), nullptr if it is not among the last seven
+    const uint32_t* presentOn(uint32_t day) const;
+    const uint32_t* roster() const { return enrolled; }
+    bool isPresent(uint16_t id, uint32_t day) const;
+
+    uint16_t countPresent(uint32_t day) const;
+    uint16_t countEnrolled() const;
+    // Enrolled IDs not present on `day`; `out` must hold words() words
+    uint16_t absent(uint32_t day, uint32_t* out) const;
+    // Enrolled IDs present on every one of the `days` days ending at `lastDay`
+    uint16_t presentEveryDay(uint32_t lastDay, uint8_t days, uint32_t* out) const;
+
+    // First and last scan minute (0-1439) for `day`, NO_MINUTE if none.
+    // Today comes from RAM; earlier days cost one small flash read.
+    bool minutes(uint16_t id, uint32_t day, uint16_t* firstIn, uint16_t* lastOut);
+
+  private:
+    uint16_t maxIds;
+    uint16_t wordCount;
+    uint32_t* enrolled;
+    uint32_t* bits;          // DAYS bitsets, day d in slot d % DAYS
+    uint32_t dayOf[DAYS];    // Day held by each slot, 0 = empty
+    uint16_t* firstIn;       // Today only
+    uint16_t* lastOut;
+    uint32_t today;
+    bool dirty;
+    unsigned long lastPersist;
+
+    uint32_t* slot(uint32_t day) { return bits + (day % DAYS) * wordCount; }
+    void startDay(uint32_t day);
+    void fileName(uint32_t day, char* name) const;
+    bool save();
+};
+
+#endif
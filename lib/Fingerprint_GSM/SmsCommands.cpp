@@ -0,0 +1,413 @@
+/**
+ * @file SmsCommands.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Commands sent to the device by SMS (STATUS, ABSENT, ADDUSER, DELUSER)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "SmsCommands.h"
+#include "TextBuffer.h"
+
+#define MSG_HELP_ADMIN "Commands:\nSTATUS [id|name]\nABSENT [grade]\nADDUSER id phone name[, grade]\nDELUSER id"
+#define MSG_HELP_GUARDIAN "Send STATUS for today's attendance."
+#define MSG_NOT_ALLOWED "Only the admin phone can do that."
+#define MSG_NO_PRESENCE "Attendance is not being tracked."
+
+typedef TextBuffer<OUTBOX_TEXT_MAX + 1> Reply;
+
+// Copy the `index`-th quoted field of a line ("+CMT: "+639...","",...")
+static bool quotedField(const char* line, uint8_t index, char* out, size_t cap) {
+  for (;;) {
+    line = strchr(line, '"');
+    if (line == nullptr) return false;
+    line++;
+    const char* end = strchr(line, '"');
+    if (end == nullptr) return false;
+    if (index-- == 0) {
+      size_t len = (size_t)(end - line) < cap - 1 ? (size_t)(end - line) : cap - 1;
+      memcpy(out, line, len);
+      out[len] = '\0';
+      return true;
+    }
+    line = end + 1;
+  }
+}
+
+static const char* skipSpaces(const char* p) {
+  while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+  return p;
+}
+
+// Copy the next word, upper-cased, and move past it
+static const char* nextWord(const char* p, char* word, uint8_t cap) {
+  p = skipSpaces(p);
+  uint8_t len = 0;
+  while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+    char c = *p++;
+    if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    if (len < cap - 1) word[len++] = c;
+  }
+  word[len] = '\0';
+  return skipSpaces(p);
+}
+
+// A whole number with nothing after it but spaces; -1 otherwise
+static long parseId(const char* p) {
+  p = skipSpaces(p);
+  if (*p < '0' || *p > '9') return -1;
+  long id = 0;
+  while (*p >= '0' && *p <= '9' && id < 100000) id = id * 10 + (*p++ - '0');
+  return *skipSpaces(p) == '\0' ? id : -1;
+}
+
+static void appendMinute(Reply& msg, uint16_t minute) {
+  msg.format("%02u:%02u", minute / 60, minute % 60);
+}
+
+SmsCommands::SmsCommands(AtEngine* modem, SmsOutbox* outbox, UserStore* users) {
+  this->modem = modem;
+  this->outbox = outbox;
+  this->users = users;
+  this->presence = nullptr;
+  this->absentBits = nullptr;
+  this->adminPhone[0] = '\0';
+  this->pduMode = false;
+  this->bodyExpected = false;
+  this->readHead = 0;
+  this->readCount = 0;
+  this->readDrops = 0;
+  this->deleteIndex = -1;
+  this->handled = 0;
+  this->rejected = 0;
+  memset(&this->staging, 0, sizeof(this->staging));
+  memset(&this->current, 0, sizeof(this->current));
+}
+
+SmsCommands::~SmsCommands() {
+  delete[] absentBits;
+}
+
+void SmsCommands::begin() {
+  modem->setUrcCallback(onUrc, this);
+}
+
+void SmsCommands::setAdminPhone(const char* phone) {
+  strncpy(adminPhone, phone, sizeof(adminPhone) - 1);
+  adminPhone[sizeof(adminPhone) - 1] = '\0';
+}
+
+void SmsCommands::setPresence(PresenceIndex* presence) {
+  if (presence != this->presence) {
+    delete[] absentBits;
+    absentBits = presence != nullptr ? new uint32_t[presence->words()] : nullptr;
+  }
+  this->presence = presence;
+}
+
+void SmsCommands::onUrc(const AtResponse& response, void* ctx) {
+  SmsCommands* self = (SmsCommands*)ctx;
+  switch (response.code) {
+    case AT_CODE_CMT:
+      self->startMessage(response.line, 0);  // +CMT: "<number>","",...
+      break;
+    case AT_CODE_CMGR:
+      self->startMessage(response.line, 1);  // +CMGR: "REC UNREAD","<number>",...
+      break;
+    case AT_CODE_SMS_BODY:
+      self->finishMessage(response.line);
+      break;
+    case AT_CODE_CMTI:
+      self->queueRead(response.value);
+      break;
+    default:
+      break;
+  }
+}
+
+void SmsCommands::startMessage(const char* line, uint8_t numberField) {
+  // PDU mode carries the sender inside the body
+  staging.number[0] = '\0';
+  if (!pduMode) quotedField(line, numberField, staging.number, sizeof(staging.number));
+  bodyExpected = true;
+}
+
+void SmsCommands::finishMessage(const char* line) {
+  if (!bodyExpected) return;
+  bodyExpected = false;
+
+  if (pduMode) {
+    if (!smsDecodePdu(line, staging.number, sizeof(staging.number), staging.text, sizeof(staging.text))) return;
+  } else {
+    strncpy(staging.text, line, TEXT_MAX);
+    staging.text[TEXT_MAX] = '\0';
+  }
+  queue.push(staging);  // Full: dropped and counted
+}
+
+void SmsCommands::queueRead(int16_t index) {
+  if (index < 0 || index > 255) return;
+  if (readCount >= PENDING_READS) {
+    readDrops++;
+    return;
+  }
+  reads[(readHead + readCount) % PENDING_READS] = (uint8_t)index;
+  readCount++;
+}
+
+void SmsCommands::serviceReads() {
+  // The engine runs commands in order, so the delete always follows the read
+  TextBuffer<16> cmd;
+  if (deleteIndex >= 0) {
+    cmd.format("AT+CMGD=%d", deleteIndex);
+    if (modem->sendCommand(cmd)) deleteIndex = -1;
+    return;
+  }
+  if (readCount == 0) return;
+  cmd.format("AT+CMGR=%u", reads[readHead]);
+  if (!modem->sendCommand(cmd, READ_TIMEOUT)) return;
+  deleteIndex = reads[readHead];
+  readHead = (readHead + 1) % PENDING_READS;
+  readCount--;
+}
+
+void SmsCommands::poll(uint32_t epoch) {
+  serviceReads();
+  if (!queue.pop(current)) return;
+  handle(epoch);
+}
+
+SmsCommands::Role SmsCommands::roleOf(const char* number, uint16_t* ids, uint8_t* count) {
+  *count = 0;
+  if (adminPhone[0] != '\0' && UserStore::samePhone(number, adminPhone)) return ROLE_ADMIN;
+  *count = users->findByPhone(number, ids, MAX_MATCHES);
+  return *count > 0 ? ROLE_GUARDIAN : ROLE_NONE;
+}
+
+void SmsCommands::handle(uint32_t epoch) {
+  uint16_t ids[MAX_MATCHES];
+  uint8_t count;
+  Role role = roleOf(current.number, ids, &count);
+  if (role == ROLE_NONE) {
+    // No reply: a stranger must not be able to spend the SIM's credit
+    rejected++;
+    Serial.print("[CMD] Ignored SMS from unknown number ");
+    Serial.println(current.number);
+    return;
+  }
+
+  char word[12];
+  const char* args = nextWord(current.text, word, sizeof(word));
+  bool adminOnly = strcmp(word, "ABSENT") == 0 || strcmp(word, "ADDUSER") == 0 || strcmp(word, "DELUSER") == 0;
+  if (!adminOnly && strcmp(word, "STATUS") != 0 && strcmp(word, "HELP") != 0) {
+    // No reply either: answering an auto-responder starts a paid ping-pong
+    rejected++;
+    Serial.print("[CMD] Ignored non-command SMS from ");
+    Serial.println(current.number);
+    return;
+  }
+
+  handled++;
+  Serial.print("[CMD] ");
+  Serial.print(word);
+  Serial.print(" from ");
+  Serial.println(current.number);
+
+  if (adminOnly && role != ROLE_ADMIN) {
+    reply(MSG_NOT_ALLOWED);
+  } else if (strcmp(word, "STATUS") == 0) {
+    commandStatus(role, ids, count, args, epoch);
+  } else if (strcmp(word, "ABSENT") == 0) {
+    commandAbsent(args, epoch);
+  } else if (strcmp(word, "ADDUSER") == 0) {
+    commandAddUser(args);
+  } else if (strcmp(word, "DELUSER") == 0) {
+    commandDelUser(args);
+  } else {
+    reply(role == ROLE_ADMIN ? MSG_HELP_ADMIN : MSG_HELP_GUARDIAN);
+  }
+}
+
+void SmsCommands::commandStatus(Role role, const uint16_t* ids, uint8_t count, const char* args,
+                                uint32_t epoch) {
+  Reply msg;
+  uint32_t day = epoch / 86400UL;
+  uint16_t matches[MAX_MATCHES];
+
+  if (role == ROLE_ADMIN) {
+    if (*args == '\0') {
+      if (presence == nullptr) {
+        msg.add(MSG_NO_PRESENCE);
+      } else {
+        uint16_t present = presence->countPresent(day);
+        uint16_t enrolled = presence->countEnrolled();
+        msg.format("Present %u/%u\nAbsent %u", present, enrolled, enrolled - present);
+      }
+      msg.format("\nUsers %u\nSMS queued %u", users->count(), outbox->size());
+      reply(msg);
+      return;
+    }
+    long id = parseId(args);
+    if (id > 0 && id <= users->maxId()) {
+      matches[0] = (uint16_t)id;
+      count = users->contains(matches[0]) ? 1 : 0;
+    } else {
+      count = users->findByName(args, matches, MAX_MATCHES);
+    }
+    if (count == 0) {
+      msg.format("No student matches \"%s\".", args);
+      reply(msg);
+      return;
+    }
+    ids = matches;
+  }
+
+  if (presence == nullptr) {
+    reply(MSG_NO_PRESENCE);
+    return;
+  }
+
+  UserData user;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!users->peek(ids[i], user)) continue;
+    if (msg.length() > 0) msg.add('\n');
+    msg.add(user.name);
+    uint16_t firstIn, lastOut;
+    if (presence->minutes(ids[i], day, &firstIn, &lastOut) && firstIn != PresenceIndex::NO_MINUTE) {
+      msg.add(": in ");
+      appendMinute(msg, firstIn);
+      if (lastOut != PresenceIndex::NO_MINUTE && lastOut != firstIn) {
+        msg.add(", last scan ");
+        appendMinute(msg, lastOut);
+      }
+    } else {
+      msg.add(": not in yet today");
+    }
+  }
+  reply(msg);
+}
+
+void SmsCommands::commandAbsent(const char* args, uint32_t epoch) {
+  if (presence == nullptr) {
+    reply(MSG_NO_PRESENCE);
+    return;
+  }
+
+  uint32_t day = epoch / 86400UL;
+  presence->absent(day, absentBits);
+
+  // Names until the message is nearly full, then a count of the rest
+  static const size_t MORE_ROOM = 16;
+  Reply names;
+  uint16_t total = 0;
+  uint16_t more = 0;
+  UserData user;
+  for (uint16_t w = 0; w < presence->words(); w++) {
+    for (uint32_t bits = absentBits[w]; bits != 0; bits &= bits - 1) {
+      uint16_t id = w * 32 + __builtin_ctz(bits);
+      if (!users->peek(id, user)) continue;
+      if (*args != '\0' && strcasecmp(user.grade, args) != 0) continue;
+      total++;
+      if (more > 0 || names.length() + strlen(user.name) + 2 + MORE_ROOM > Reply::capacity()) {
+        more++;
+        continue;
+      }
+      if (names.length() > 0) names.add(", ");
+      names.add(user.name);
+    }
+  }
+
+  Reply msg;
+  if (*args != '\0') msg.format("Absent today, %s: %u", args, total);
+  else msg.format("Absent today: %u", total);
+  if (total > 0) {
+    msg.add('\n').add(names);
+    if (more > 0) msg.format(" +%u more", more);
+  }
+  reply(msg);
+}
+
+void SmsCommands::commandAddUser(const char* args) {
+  // ADDUSER <id> <phone> <name>[, <grade>]
+  char field[USER_NAME_MAX];
+  const char* p = nextWord(args, field, sizeof(field));
+  long id = parseId(field);
+  Reply msg;
+  if (id < 1 || id > users->maxId()) {
+    msg.format("Usage: ADDUSER id phone name[, grade]. IDs are 1-%u.", users->maxId());
+    reply(msg);
+    return;
+  }
+
+  UserData user;
+  memset(&user, 0, sizeof(user));
+  user.id = (uint16_t)id;
+  user.notifyOnAccess = true;
+  p = skipSpaces(p);
+  uint8_t len = 0;
+  while (*p != '\0' && *p != ' ' && len < sizeof(user.phoneNumber) - 1) user.phoneNumber[len++] = *p++;
+  if (!UserStore::validPhone(user.phoneNumber)) {
+    reply("Usage: ADDUSER id phone name[, grade]. The phone number is not valid.");
+    return;
+  }
+
+  p = skipSpaces(p);
+  const char* comma = strchr(p, ',');
+  len = 0;
+  for (const char* q = p; *q != '\0' && q != comma && len < sizeof(user.name) - 1; q++) user.name[len++] = *q;
+  while (len > 0 && user.name[len - 1] == ' ') len--;
+  user.name[len] = '\0';
+  if (comma != nullptr) {
+    strncpy(user.grade, skipSpaces(comma + 1), sizeof(user.grade) - 1);
+    for (len = strlen(user.grade); len > 0 && (user.grade[len - 1] == ' ' || user.grade[len - 1] == '\r'); len--) {
+      user.grade[len - 1] = '\0';
+    }
+  }
+  if (user.name[0] == '\0') {
+    reply("Usage: ADDUSER id phone name[, grade]. The name is missing.");
+    return;
+  }
+
+  bool existed = users->contains(user.id);
+  if (!users->put(user)) {
+    reply("Could not save the user, storage is full.");
+    return;
+  }
+  if (presence != nullptr) presence->setEnrolled(user.id, true);
+  msg.format("%s #%u %s", existed ? "Updated" : "Added", user.id, user.name);
+  if (user.grade[0] != '\0') msg.format(" (%s)", user.grade);
+  reply(msg);
+}
+
+void SmsCommands::commandDelUser(const char* args) {
+  long id = parseId(args);
+  Reply msg;
+  UserData user;
+  if (id < 1 || id > users->maxId()) {
+    reply("Usage: DELUSER id");
+    return;
+  }
+  if (!users->peek((uint16_t)id, user)) {
+    msg.format("No user #%ld.", id);
+    reply(msg);
+    return;
+  }
+  if (!users->remove(user.id)) {
+    reply("Could not remove the user.");
+    return;
+  }
+  if (presence != nullptr) presence->setEnrolled(user.id, false);
+  msg.format("Removed #%u %s", user.id, user.name);
+  reply(msg);
+}
+
+bool SmsCommands::reply(const char* text) {
+  // Replies leave half the outbox to notifications
+  if (outbox->size() >= outbox->capacity() / 2) {
+    Serial.println("[CMD] Outbox busy, reply dropped");
+    return false;
+  }
+  return outbox->append(current.number, text);
+}
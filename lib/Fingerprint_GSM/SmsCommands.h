@@ -0,0 +1,117 @@
+/**
+ * @file SmsCommands.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Commands sent to the device by SMS (STATUS, ABSENT, ADDUSER, DELUSER)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The modem's URC handler decodes each pushed (+CMT) or stored (+CMTI, read
+ * back with AT+CMGR) message as its lines arrive and only copies it into a
+ * small bounded queue; a full queue drops the message. poll() answers at
+ * most one command per call, from the user store and presence index in
+ * RAM, so a flood of SMS costs the GSM loop a few microseconds per pass and
+ * never reaches the scan path. Replies go through the outbox, and half of
+ * it is kept free for access notifications.
+ *
+ * Only the admin phone and phones registered to a user are answered, and
+ * only to the commands below. Anything else gets no reply, so an
+ * auto-responder cannot keep a conversation going:
+ *   STATUS                 guardian: today's scans of their children
+ *   STATUS [id|name]       admin: head count, or one student
+ *   ABSENT [grade]         admin: who has not scanned today
+ *   ADDUSER id phone name[, grade]
+ *   DELUSER id
+ *   HELP
+ */
+#ifndef SMS_COMMANDS_H
+#define SMS_COMMANDS_H
+
+#include <Arduino.h>
+#include "AtEngine.h"
+#include "SmsOutbox.h"
+#include "SpscQueue.h"
+#include "UserStore.h"
+#include "PresenceIndex.h"
+
+class SmsCommands {
+  public:
+    static const uint8_t QUEUE_SIZE = 4;       // Messages waiting for poll()
+    static const uint8_t TEXT_MAX = 160;       // Longer messages are cut
+    static const uint8_t PENDING_READS = 4;    // +CMTI indexes waiting for AT+CMGR
+    static const uint8_t MAX_MATCHES = 4;      // Students in one STATUS reply
+    static const unsigned long READ_TIMEOUT = 5000;
+
+    SmsCommands(AtEngine* modem, SmsOutbox* outbox, UserStore* users);
+    ~SmsCommands();
+
+    // Take over the modem's URC callback
+    void begin();
+    void setAdminPhone(const char* phone);
+    // Without a presence index STATUS and ABSENT say attendance is off
+    void setPresence(PresenceIndex* presence);
+    // Bodies are hex PDUs (AT+CMGF=0) rather than text
+    void setPduMode(bool enabled) { pduMode = enabled; }
+
+    // URC handler: decodes and queues, never blocks
+    static void onUrc(const AtResponse& response, void* ctx);
+
+    // Read stored messages and answer at most one command. `epoch` is the
+    // local RTC time.
+    void poll(uint32_t epoch);
+
+    // Sender and text of the last message taken off the queue, "" before any
+    const char* lastSender() const { return current.number; }
+    const char* lastText() const { return current.text; }
+    uint8_t pending() const { return queue.size(); }
+    uint32_t handledCount() const { return handled; }
+    uint32_t rejectedCount() const { return rejected; }  // Unknown senders or commands
+    uint32_t droppedCount() const { return queue.dropCount() + readDrops; }
+
+  private:
+    enum Role : uint8_t { ROLE_NONE, ROLE_GUARDIAN, ROLE_ADMIN };
+
+    struct Inbound {
+      char number[AtEngine::NUMBER_MAX];
+      char text[TEXT_MAX + 1];
+    };
+
+    AtEngine* modem;
+    SmsOutbox* outbox;
+    UserStore* users;
+    PresenceIndex* presence;
+    uint32_t* absentBits;    // presence->words() words
+    char adminPhone[AtEngine::NUMBER_MAX];
+    bool pduMode;
+
+    // URC side
+    SpscQueue<Inbound, QUEUE_SIZE> queue;
+    Inbound staging;         // Header seen, waiting for the body line
+    bool bodyExpected;
+    uint8_t reads[PENDING_READS];
+    uint8_t readHead;
+    uint8_t readCount;
+    uint32_t readDrops;
+    int16_t deleteIndex;     // Read, still to be deleted; -1 none
+
+    // poll() side
+    Inbound current;
+    uint32_t handled;
+    uint32_t rejected;
+
+    void startMessage(const char* line, uint8_t numberField);
+    void finishMessage(const char* line);
+    void queueRead(int16_t index);
+    void serviceReads();
+
+    void handle(uint32_t epoch);
+    Role roleOf(const char* number, uint16_t* ids, uint8_t* count);
+    void commandStatus(Role role, const uint16_t* ids, uint8_t count, const char* args, uint32_t epoch);
+    void commandAbsent(const char* args, uint32_t epoch);
+    void commandAddUser(const char* args);
+    void commandDelUser(const char* args);
+    bool reply(const char* text);
+};
+
+#endif
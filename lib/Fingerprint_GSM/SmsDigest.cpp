@@ -0,0 +1,138 @@
+/**
+ * @file SmsDigest.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Coalesces attendance alerts per recipient into one long SMS
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "SmsDigest.h"
+
+SmsDigest::SmsDigest(SmsOutbox* outbox) {
+  this->outbox = outbox;
+  this->windowMs = 300000;  // 5 minutes
+  this->maxEvents = 12;
+  this->rejected = 0;
+
+  for (uint8_t i = 0; i < MAX_RECIPIENTS; i++) {
+    buckets[i].number[0] = '\0';
+    buckets[i].len = 0;
+    buckets[i].events = 0;
+    buckets[i].openedAt = 0;
+  }
+}
+
+void SmsDigest::setWindow(unsigned long windowMs, uint8_t maxEvents) {
+  this->windowMs = windowMs;
+  this->maxEvents = maxEvents > 0 ? maxEvents : 1;
+}
+
+SmsDigest::Bucket* SmsDigest::find(const char* number) {
+  Bucket* oldest = nullptr;
+
+  for (uint8_t i = 0; i < MAX_RECIPIENTS; i++) {
+    if (buckets[i].number[0] != '\0' && strcmp(buckets[i].number, number) == 0) {
+      return &buckets[i];
+    }
+  }
+
+  // Claim a free bucket, or make room by sending the oldest one early
+  for (uint8_t i = 0; i < MAX_RECIPIENTS; i++) {
+    if (buckets[i].events == 0) {
+      oldest = &buckets[i];
+      break;
+    }
+    if (oldest == nullptr || (long)(buckets[i].openedAt - oldest->openedAt) < 0) {
+      oldest = &buckets[i];
+    }
+  }
+  if (oldest->events > 0) {
+    flush(*oldest);
+    if (oldest->events > 0) return nullptr;
+  }
+
+  strncpy(oldest->number, number, sizeof(oldest->number) - 1);
+  oldest->number[sizeof(oldest->number) - 1] = '\0';
+  return oldest;
+}
+
+bool SmsDigest::add(const char* number, const char* name, const char* grade, const char* timeStr) {
+  Bucket* bucket = find(number);
+  if (bucket == nullptr) {
+    rejected++;
+    return false;
+  }
+
+  char entry[64];
+  int n;
+  if (grade != nullptr && grade[0] != '\0') {
+    n = snprintf(entry, sizeof(entry), "%s, %s, %s\n", name, grade, timeStr);
+  } else {
+    n = snprintf(entry, sizeof(entry), "%s, %s\n", name, timeStr);
+  }
+  if (n < 0) return false;
+  if (n >= (int)sizeof(entry)) n = sizeof(entry) - 1;
+
+  if ((size_t)(bucket->len + n) >= sizeof(bucket->lines)) {
+    flush(*bucket);
+    if (bucket->events > 0) {
+      rejected++;
+      return false;
+    }
+  }
+
+  if (bucket->events == 0) {
+    bucket->openedAt = millis();
+  }
+  memcpy(bucket->lines + bucket->len, entry, n);
+  bucket->len += n;
+  bucket->lines[bucket->len] = '\0';
+  bucket->events++;
+
+  if (bucket->events >= maxEvents) {
+    flush(*bucket);
+  }
+  return true;
+}
+
+void SmsDigest::flush(Bucket& bucket) {
+  if (bucket.events == 0) return;
+
+  int n = snprintf(message, sizeof(message), "Attendance (%u)\n", bucket.events);
+  memcpy(message + n, bucket.lines, bucket.len);
+  // Drop the trailing newline of the last line
+  message[n + bucket.len - 1] = '\0';
+
+  if (!outbox->append(bucket.number, message)) {
+    return;  // Outbox full; keep the lines and try again on the next poll
+  }
+
+  bucket.len = 0;
+  bucket.lines[0] = '\0';
+  bucket.events = 0;
+}
+
+void SmsDigest::poll() {
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < MAX_RECIPIENTS; i++) {
+    if (buckets[i].events > 0 && now - buckets[i].openedAt >= windowMs) {
+      flush(buckets[i]);
+    }
+  }
+}
+
+void SmsDigest::flushAll() {
+  for (uint8_t i = 0; i < MAX_RECIPIENTS; i++) {
+    flush(buckets[i]);
+  }
+}
+
+uint8_t SmsDigest::pendingEvents() const {
+  uint8_t total = 0;
+  for (uint8_t i = 0; i < MAX_RECIPIENTS; i++) {
+    total += buckets[i].events;
+  }
+  return total;
+}
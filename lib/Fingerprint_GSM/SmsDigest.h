@@ -0,0 +1,64 @@
+/**
+ * @file SmsDigest.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Coalesces attendance alerts per recipient into one long SMS
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * A digest is one outbox record, so it holds at most OUTBOX_TEXT_MAX
+ * characters (three concatenated SMS). That is about 12 lines of "name,
+ * grade, time"; a digest that fills up goes out before it reaches
+ * maxEvents. The limit comes from the outbox ring entry, not from the UDH.
+ */
+#ifndef SMS_DIGEST_H
+#define SMS_DIGEST_H
+
+#include <Arduino.h>
+#include "SmsOutbox.h"
+
+class SmsDigest {
+  public:
+    static const uint8_t MAX_RECIPIENTS = 4;
+    static const uint16_t HEADER_MAX = 24;  // "Attendance (nn)\n"
+
+    SmsDigest(SmsOutbox* outbox);
+
+    // A digest goes out when its oldest entry is windowMs old, it holds
+    // maxEvents lines or the next line does not fit, whichever comes first.
+    void setWindow(unsigned long windowMs, uint8_t maxEvents);
+
+    // Add one "name, grade, time" line for a recipient. grade may be null.
+    // Returns false, and counts the line in rejectedCount(), when the
+    // digest is full and the outbox cannot take it.
+    bool add(const char* number, const char* name, const char* grade, const char* timeStr);
+
+    // Flush digests whose window has expired
+    void poll();
+    void flushAll();
+
+    uint8_t pendingEvents() const;
+    uint32_t rejectedCount() const { return rejected; }
+
+  private:
+    struct Bucket {
+      char number[AtEngine::NUMBER_MAX];
+      char lines[OUTBOX_TEXT_MAX + 1 - HEADER_MAX];
+      uint16_t len;
+      uint8_t events;
+      unsigned long openedAt;
+    };
+
+    SmsOutbox* outbox;
+    Bucket buckets[MAX_RECIPIENTS];
+    unsigned long windowMs;
+    uint8_t maxEvents;
+    uint32_t rejected;
+    char message[OUTBOX_TEXT_MAX + 1];
+
+    Bucket* find(const char* number);
+    void flush(Bucket& bucket);
+};
+
+#endif
@@ -0,0 +1,375 @@
+/**
+ * @file SmsOutbox.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Flash-backed SMS outbox with retry and exponential backoff
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "SmsOutbox.h"
+
+static const uint32_t OUTBOX_MAGIC = 0x5842544F;  // "OTBX"
+static const uint8_t OUTBOX_SUBTYPE = 0x42;
+static const uint8_t ENTRY_WRITTEN = 0x0F;
+static const uint8_t ENTRY_RELEASED = 0x00;
+static const uint16_t NO_ENTRY = 0xFFFF;
+
+SmsOutbox::SmsOutbox(AtEngine* modem) {
+  this->modem = modem;
+  this->partition = nullptr;
+  this->entries = 0;
+  this->writePos = 0;
+  this->stamp = 0;
+  this->ready = false;
+  this->drainEnabled = true;
+  this->pduMode = false;
+  this->index = nullptr;
+  this->slots = 0;
+  this->nextSeq = 1;
+  this->used = 0;
+  this->dropped = 0;
+  this->rejected = 0;
+  this->inFlightSlot = -1;
+  this->inFlight = 0;
+  this->current.seq = 0;
+}
+
+SmsOutbox::~SmsOutbox() {
+  delete[] index;
+}
+
+bool SmsOutbox::begin(const char* partitionLabel) {
+  if (ready) return true;
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)OUTBOX_SUBTYPE,
+                                       partitionLabel);
+  entries = partition != nullptr ? partition->size / ENTRY_SIZE : 0;
+  // Records need a sector of their own on top of the two the ring keeps free
+  if (entries < 3 * ENTRIES_PER_SECTOR) {
+    Serial.println("[OUTBOX] ERROR: Outbox partition not found, SMS cannot be queued");
+    partition = nullptr;
+    return false;
+  }
+
+  slots = entries - 2 * ENTRIES_PER_SECTOR;
+  index = new Slot[slots];
+  for (uint16_t i = 0; i < slots; i++) {
+    index[i].seq = 0;
+    index[i].entry = NO_ENTRY;
+  }
+  recover();
+
+  ready = true;
+  if (used > 0) {
+    Serial.print("[OUTBOX] Resuming ");
+    Serial.print(used);
+    Serial.println(" pending SMS");
+  }
+  return true;
+}
+
+void SmsOutbox::recover() {
+  Entry entry;
+  uint16_t newest = NO_ENTRY;
+  for (uint16_t e = 0; e < entries; e++) {
+    esp_partition_read(partition, entryOffset(e), &entry, sizeof(entry));
+    if (entry.magic != OUTBOX_MAGIC) continue;
+    if (newest == NO_ENTRY || entry.stamp > stamp) {
+      newest = e;
+      stamp = entry.stamp;
+    }
+    if (entry.state != ENTRY_WRITTEN || entry.record.seq == 0) continue;
+
+    // A power cut between writing a record and releasing its old entry
+    // leaves both: keep the later one
+    int16_t slot = -1;
+    for (uint16_t i = 0; i < slots && slot < 0; i++) {
+      if (index[i].seq == entry.record.seq) slot = i;
+    }
+    if (slot >= 0) {
+      uint32_t header[2];
+      esp_partition_read(partition, entryOffset(index[slot].entry), header, sizeof(header));
+      if (header[1] > entry.stamp) {
+        setState(e, ENTRY_RELEASED);
+        continue;
+      }
+      setState(index[slot].entry, ENTRY_RELEASED);
+    } else {
+      for (uint16_t i = 0; i < slots && slot < 0; i++) {
+        if (index[i].seq == 0) slot = i;
+      }
+      if (slot < 0) continue;
+      used++;
+    }
+
+    index[slot].seq = entry.record.seq;
+    index[slot].notBefore = millis();
+    index[slot].entry = e;
+    index[slot].attempts = entry.record.attempts;
+    index[slot].partsSent = entry.record.partsSent;
+    if (entry.record.seq >= nextSeq) nextSeq = entry.record.seq + 1;
+  }
+
+  if (newest == NO_ENTRY) {
+    // Blank, or left over from another layout: start the ring clean
+    esp_partition_erase_range(partition, 0, (uint32_t)entries * ENTRY_SIZE);
+    writePos = 0;
+    stamp = 0;
+    return;
+  }
+
+  // Continue after the newest entry, past any a power cut left half-written
+  writePos = (newest + 1) % entries;
+  while (writePos % ENTRIES_PER_SECTOR != 0) {
+    uint32_t header[2];
+    esp_partition_read(partition, entryOffset(writePos), header, sizeof(header));
+    if (header[0] == 0xFFFFFFFF && header[1] == 0xFFFFFFFF) break;
+    writePos = (writePos + 1) % entries;
+  }
+}
+
+bool SmsOutbox::append(const char* number, const char* text) {
+  if (!ready || used >= slots) {
+    Serial.println(ready ? "[OUTBOX] ERROR: Outbox full" : "[OUTBOX] ERROR: Outbox not started");
+    rejected++;
+    return false;
+  }
+
+  uint16_t slot = 0;
+  while (index[slot].seq != 0) slot++;
+
+  Entry entry;
+  memset(&entry, 0xFF, sizeof(entry));
+  entry.record.seq = nextSeq;
+  entry.record.attempts = 0;
+  entry.record.partsSent = 0;
+  strncpy(entry.record.number, number, sizeof(entry.record.number) - 1);
+  entry.record.number[sizeof(entry.record.number) - 1] = '\0';
+  strncpy(entry.record.text, text, sizeof(entry.record.text) - 1);
+  entry.record.text[sizeof(entry.record.text) - 1] = '\0';
+
+  index[slot].seq = nextSeq;
+  index[slot].notBefore = millis();
+  index[slot].entry = NO_ENTRY;
+  index[slot].attempts = 0;
+  index[slot].partsSent = 0;
+  if (!makeRoom() || !writeEntry(slot, entry)) {
+    Serial.println("[OUTBOX] ERROR: Cannot write outbox entry");
+    index[slot].seq = 0;
+    rejected++;
+    return false;
+  }
+  nextSeq++;
+  used++;
+  return true;
+}
+
+void SmsOutbox::setState(uint16_t entry, uint8_t state) {
+  esp_partition_write(partition, entryOffset(entry) + offsetof(Entry, state), &state, 1);
+}
+
+bool SmsOutbox::makeRoom() {
+  // Records still live in the next sector move forward while this sector
+  // has room for them and one more entry, so the next sector is empty when
+  // the ring reaches it. Each move frees an entry, so this ends within one
+  // lap of the ring.
+  for (uint16_t moves = 0; moves < entries; moves++) {
+    uint8_t free = ENTRIES_PER_SECTOR - writePos % ENTRIES_PER_SECTOR;
+    uint16_t sector = writePos / ENTRIES_PER_SECTOR;
+    uint16_t next = (sector + 1) % (entries / ENTRIES_PER_SECTOR);
+    uint8_t live = 0;
+    int16_t slot = -1;
+    for (uint16_t i = 0; i < slots; i++) {
+      if (index[i].seq == 0 || index[i].entry == NO_ENTRY) continue;
+      uint16_t at = index[i].entry / ENTRIES_PER_SECTOR;
+      // A sector about to be erased must already be empty
+      if (free == ENTRIES_PER_SECTOR && at == sector) return false;
+      if (at != next) continue;
+      live++;
+      slot = i;
+    }
+    if (live < free) return true;
+    if (!moveEntry(slot)) return false;
+  }
+  return false;
+}
+
+bool SmsOutbox::moveEntry(uint16_t slot) {
+  Entry entry;
+  esp_partition_read(partition, entryOffset(index[slot].entry), &entry, sizeof(entry));
+  return writeEntry(slot, entry);
+}
+
+bool SmsOutbox::writeEntry(uint16_t slot, Entry& entry) {
+  if (writePos % ENTRIES_PER_SECTOR == 0) {
+    uint16_t sector = writePos / ENTRIES_PER_SECTOR;
+    if (esp_partition_erase_range(partition, (uint32_t)sector * SECTOR_SIZE, SECTOR_SIZE) != ESP_OK) {
+      return false;
+    }
+    if (index[slot].entry != NO_ENTRY && index[slot].entry / ENTRIES_PER_SECTOR == sector) {
+      index[slot].entry = NO_ENTRY;
+    }
+  }
+
+  entry.magic = OUTBOX_MAGIC;
+  entry.stamp = ++stamp;
+  entry.state = 0xFF;
+  uint16_t at = writePos;
+  writePos = (writePos + 1) % entries;
+  if (esp_partition_write(partition, entryOffset(at), &entry, sizeof(entry)) != ESP_OK) return false;
+
+  // The state byte is written last, so a torn entry is never loaded
+  setState(at, ENTRY_WRITTEN);
+  if (index[slot].entry != NO_ENTRY) setState(index[slot].entry, ENTRY_RELEASED);
+  index[slot].entry = at;
+  return true;
+}
+
+void SmsOutbox::persist(uint16_t slot) {
+  Entry entry;
+  memset(&entry, 0xFF, sizeof(entry));
+  entry.record = current;
+  if (!makeRoom() || !writeEntry(slot, entry)) Serial.println("[OUTBOX] ERROR: Cannot write outbox entry");
+}
+
+void SmsOutbox::release(uint16_t slot) {
+  index[slot].seq = 0;
+  if (index[slot].entry != NO_ENTRY) setState(index[slot].entry, ENTRY_RELEASED);
+  index[slot].entry = NO_ENTRY;
+  used--;
+}
+
+int16_t SmsOutbox::nextDue() {
+  int16_t best = -1;
+  unsigned long now = millis();
+
+  for (uint16_t i = 0; i < slots; i++) {
+    if (index[i].seq == 0 || index[i].entry == NO_ENTRY) continue;
+    if ((long)(now - index[i].notBefore) < 0) continue;
+    if (best < 0 || index[i].seq < index[best].seq) best = i;
+  }
+  return best;
+}
+
+void SmsOutbox::handleResult(SmsStatus status) {
+  uint16_t slot = inFlightSlot;
+  inFlightSlot = -1;
+  inFlight = 0;
+
+  Slot& rec = index[slot];
+
+  if (status == SMS_SENT) {
+    current.partsSent = ++rec.partsSent;
+    if (rec.partsSent >= totalParts(current.text)) {
+      release(slot);
+    } else {
+      persist(slot);
+    }
+    return;
+  }
+
+  current.attempts = ++rec.attempts;
+  if (rec.attempts >= MAX_ATTEMPTS) {
+    Serial.print("[OUTBOX] Dropping SMS to ");
+    Serial.print(current.number);
+    Serial.println(" after repeated failures");
+    dropped++;
+    release(slot);
+    return;
+  }
+
+  unsigned long backoff = BACKOFF_BASE << (rec.attempts - 1);
+  if (backoff > BACKOFF_MAX) backoff = BACKOFF_MAX;
+  rec.notBefore = millis() + backoff;
+  persist(slot);
+
+  Serial.print("[OUTBOX] SMS to ");
+  Serial.print(current.number);
+  Serial.print(" failed, retry in ");
+  Serial.print(backoff / 1000);
+  Serial.println("s");
+}
+
+void SmsOutbox::poll() {
+  if (!ready) return;
+
+  if (inFlight != 0) {
+    SmsStatus status = modem->smsStatus(inFlight);
+    if (status == SMS_SENT || status == SMS_FAILED || status == SMS_UNKNOWN) {
+      handleResult(status);
+    }
+    return;
+  }
+
+  if (!drainEnabled || used == 0) return;
+
+  int16_t slot = nextDue();
+  if (slot < 0) return;
+
+  // Retries and later parts of the same record are already in RAM
+  if (current.seq != index[slot].seq) {
+    esp_partition_read(partition, entryOffset(index[slot].entry) + offsetof(Entry, record), &current,
+                       sizeof(current));
+    current.number[sizeof(current.number) - 1] = '\0';
+    current.text[sizeof(current.text) - 1] = '\0';
+  }
+
+  SmsHandle handle = submitPart(slot);
+  if (handle != 0) {
+    inFlight = handle;
+    inFlightSlot = slot;
+  }
+}
+
+uint8_t SmsOutbox::totalParts(const char* text) {
+  return pduMode ? smsPartCount(text) : partCount(text);
+}
+
+SmsHandle SmsOutbox::submitPart(uint16_t slot) {
+  uint8_t total = totalParts(current.text);
+
+  if (!pduMode) {
+    copyPart(current.text, index[slot].partsSent, total, partBuffer);
+    return modem->sendSMS(current.number, partBuffer);
+  }
+
+  // The low byte of the sequence number doubles as the concatenation
+  // reference, so a retried part still joins the parts already delivered
+  uint8_t len = smsEncodePdu(current.number, current.text, index[slot].partsSent, total,
+                             (uint8_t)current.seq, partBuffer, sizeof(partBuffer));
+  if (len == 0) {
+    Serial.print("[OUTBOX] ERROR: Cannot encode SMS to ");
+    Serial.println(current.number);
+    dropped++;
+    release(slot);
+    return 0;
+  }
+  return modem->sendPdu(len, partBuffer);
+}
+
+uint8_t SmsOutbox::partCount(const char* text) {
+  size_t len = strlen(text);
+  if (len <= AtEngine::SMS_BODY_MAX) return 1;
+
+  const size_t partText = AtEngine::SMS_BODY_MAX - 7;  // Room for "(i/n) "
+  return (len + partText - 1) / partText;
+}
+
+void SmsOutbox::copyPart(const char* text, uint8_t index, uint8_t total, char* out) {
+  if (total <= 1) {
+    strncpy(out, text, AtEngine::SMS_BODY_MAX);
+    out[AtEngine::SMS_BODY_MAX] = '\0';
+    return;
+  }
+
+  const size_t partText = AtEngine::SMS_BODY_MAX - 7;
+  size_t len = strlen(text);
+  size_t start = index * partText;
+  size_t n = (start < len) ? len - start : 0;
+  if (n > partText) n = partText;
+
+  int prefix = sprintf(out, "(%u/%u) ", index + 1, total);
+  memcpy(out + prefix, text + start, n);
+  out[prefix + n] = '\0';
+}
@@ -0,0 +1,133 @@
+/**
+ * @file SmsOutbox.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Flash-backed SMS outbox with retry and exponential backoff
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Records live in the "outbox" flash partition, apart from the shared NVS
+ * partition. The partition is a ring of 512-byte entries, 8 per 4 KB
+ * sector. Every change to a record appends a new entry and clears the
+ * state byte of the old one; sending a message clears its last entry. Only
+ * the state byte is rewritten in place, which flash allows without an erase.
+ * A sector is erased when the ring wraps onto it. Any record still live in
+ * that sector is moved forward before the erase.
+ *
+ * RAM keeps a small index entry per record (sequence, ring entry, attempts,
+ * backoff); number and text are read back from flash when a part is sent.
+ * The index is sized to the partition: the ring holds every record but two
+ * sectors, the room the moves above need.
+ */
+#ifndef SMS_OUTBOX_H
+#define SMS_OUTBOX_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "AtEngine.h"
+
+// Longest message the outbox accepts: three concatenated 153-character parts
+#define OUTBOX_TEXT_MAX 459
+
+// One queued message, stored as-is in a ring entry
+struct OutboxRecord {
+  uint32_t seq;       // Append order, 0 = free slot
+  uint8_t attempts;   // Failed sends so far
+  uint8_t partsSent;  // Parts of a long message already confirmed
+  char number[AtEngine::NUMBER_MAX];
+  char text[OUTBOX_TEXT_MAX + 1];
+};
+
+class SmsOutbox {
+  public:
+    static const uint8_t MAX_ATTEMPTS = 8;
+    static const unsigned long BACKOFF_BASE = 5000;     // First retry after 5 s
+    static const unsigned long BACKOFF_MAX = 600000;    // Never wait more than 10 min
+    static const uint16_t SECTOR_SIZE = 4096;
+    static const uint16_t ENTRY_SIZE = 512;
+    static const uint8_t ENTRIES_PER_SECTOR = SECTOR_SIZE / ENTRY_SIZE;
+
+    SmsOutbox(AtEngine* modem);
+    ~SmsOutbox();
+
+    // Load records left over from the last power cycle. Nothing is queued
+    // without the partition.
+    bool begin(const char* partitionLabel = "outbox");
+
+    // Write a message to the flash ring. Returns false before begin()
+    // succeeded or when capacity() records are already waiting.
+    bool append(const char* number, const char* text);
+
+    // Hand the oldest due record to the modem and track its result.
+    void poll();
+    void setDrainEnabled(bool enabled) { drainEnabled = enabled; }
+    // PDU mode sends long messages as real concatenated SMS (UDH). The modem
+    // must already be in AT+CMGF=0.
+    void setPduMode(bool enabled) { pduMode = enabled; }
+
+    uint16_t size() const { return used; }
+    uint16_t capacity() const { return slots; }
+    uint32_t droppedCount() const { return dropped; }
+    uint32_t rejectedCount() const { return rejected; }  // append() found the ring full
+
+    // Text mode has no user data header, so long messages go out as
+    // separate SMS prefixed with "(i/n) ".
+    static uint8_t partCount(const char* text);
+    static void copyPart(const char* text, uint8_t index, uint8_t total, char* out);
+
+  private:
+    // One ring entry; the rest of its 512 bytes stays erased
+    struct Entry {
+      uint32_t magic;
+      uint32_t stamp;   // Write order across the whole ring
+      OutboxRecord record;
+      uint8_t state;    // Erased, written or released; bits are only ever cleared
+    };
+    static_assert(sizeof(Entry) <= ENTRY_SIZE, "Outbox entry must fit its ring slot");
+
+    // What RAM keeps of a queued record
+    struct Slot {
+      uint32_t seq;             // 0 = free
+      unsigned long notBefore;  // Backoff deadline, RAM only
+      uint16_t entry;           // Ring entry holding the record
+      uint8_t attempts;
+      uint8_t partsSent;
+    };
+
+    AtEngine* modem;
+    const esp_partition_t* partition;
+    uint16_t entries;        // In the ring
+    uint16_t writePos;       // Next entry to write
+    uint32_t stamp;
+    bool ready;
+    bool drainEnabled;
+    bool pduMode;
+
+    Slot* index;             // `slots` entries, allocated by begin()
+    uint16_t slots;
+    uint32_t nextSeq;
+    uint16_t used;
+    uint32_t dropped;
+    uint32_t rejected;
+
+    int16_t inFlightSlot;
+    SmsHandle inFlight;
+    OutboxRecord current;    // Record of inFlightSlot, read back from flash
+    char partBuffer[AtEngine::PAYLOAD_MAX + 1];
+
+    uint32_t entryOffset(uint16_t entry) const { return (uint32_t)entry * ENTRY_SIZE; }
+    void recover();
+    void setState(uint16_t entry, uint8_t state);
+    bool makeRoom();
+    bool writeEntry(uint16_t slot, Entry& entry);
+    bool moveEntry(uint16_t slot);
+    void persist(uint16_t slot);
+    void release(uint16_t slot);
+    int16_t nextDue();
+    uint8_t totalParts(const char* text);
+    SmsHandle submitPart(uint16_t slot);
+    void handleResult(SmsStatus status);
+};
+
+#endif
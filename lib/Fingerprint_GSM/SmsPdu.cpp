@@ -0,0 +1,425 @@
+/**
+ * @file SmsPdu.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief SMS-SUBMIT PDU encoder and SMS-DELIVER decoder (GSM 03.38 7-bit, UCS2, concatenation)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "SmsPdu.h"
+#include <string.h>
+
+// GSM 03.38 default alphabet, indexed by septet value
+static const uint16_t GSM7_BASIC[128] = {
+  0x0040, 0x00A3, 0x0024, 0x00A5, 0x00E8, 0x00E9, 0x00F9, 0x00EC,
+  0x00F2, 0x00C7, 0x000A, 0x00D8, 0x00F8, 0x000D, 0x00C5, 0x00E5,
+  0x0394, 0x005F, 0x03A6, 0x0393, 0x039B, 0x03A9, 0x03A0, 0x03A8,
+  0x03A3, 0x0398, 0x039E, 0xFFFF, 0x00C6, 0x00E6, 0x00DF, 0x00C9,
+  0x0020, 0x0021, 0x0022, 0x0023, 0x00A4, 0x0025, 0x0026, 0x0027,
+  0x0028, 0x0029, 0x002A, 0x002B, 0x002C, 0x002D, 0x002E, 0x002F,
+  0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+  0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+  0x00A1, 0x0041, 0x0042, 0x0043, 0x0044, 0x0045, 0x0046, 0x0047,
+  0x0048, 0x0049, 0x004A, 0x004B, 0x004C, 0x004D, 0x004E, 0x004F,
+  0x0050, 0x0051, 0x0052, 0x0053, 0x0054, 0x0055, 0x0056, 0x0057,
+  0x0058, 0x0059, 0x005A, 0x00C4, 0x00D6, 0x00D1, 0x00DC, 0x00A7,
+  0x00BF, 0x0061, 0x0062, 0x0063, 0x0064, 0x0065, 0x0066, 0x0067,
+  0x0068, 0x0069, 0x006A, 0x006B, 0x006C, 0x006D, 0x006E, 0x006F,
+  0x0070, 0x0071, 0x0072, 0x0073, 0x0074, 0x0075, 0x0076, 0x0077,
+  0x0078, 0x0079, 0x007A, 0x00E4, 0x00F6, 0x00F1, 0x00FC, 0x00E0
+};
+
+// Extension table, reached through the 0x1B escape
+static const struct { uint8_t septet; uint16_t cp; } GSM7_EXT[] = {
+  {0x0A, 0x000C}, {0x14, 0x005E}, {0x28, 0x007B}, {0x29, 0x007D}, {0x2F, 0x005C},
+  {0x3C, 0x005B}, {0x3D, 0x007E}, {0x3E, 0x005D}, {0x40, 0x007C}, {0x65, 0x20AC}
+};
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static uint32_t nextCodepoint(const char*& p) {
+  uint8_t c = (uint8_t)*p++;
+  if (c < 0x80) return c;
+
+  int extra;
+  uint32_t cp;
+  if ((c & 0xE0) == 0xC0) { extra = 1; cp = c & 0x1F; }
+  else if ((c & 0xF0) == 0xE0) { extra = 2; cp = c & 0x0F; }
+  else if ((c & 0xF8) == 0xF0) { extra = 3; cp = c & 0x07; }
+  else return 0xFFFD;
+
+  while (extra-- > 0) {
+    if (((uint8_t)*p & 0xC0) != 0x80) return 0xFFFD;
+    cp = (cp << 6) | ((uint8_t)*p++ & 0x3F);
+  }
+  return cp;
+}
+
+// Septets for one code point: 0 if it has no GSM7 form, else 1 or 2
+static uint8_t gsm7Encode(uint32_t cp, uint8_t* out) {
+  // Most of printable ASCII maps to itself
+  if ((cp >= 0x20 && cp <= 0x5A && cp != 0x24 && cp != 0x40) ||
+      (cp >= 0x61 && cp <= 0x7A) || cp == 0x0A || cp == 0x0D) {
+    out[0] = (uint8_t)cp;
+    return 1;
+  }
+  for (uint8_t i = 0; i < 128; i++) {
+    if (GSM7_BASIC[i] == cp) {
+      out[0] = i;
+      return 1;
+    }
+  }
+  for (uint8_t i = 0; i < sizeof(GSM7_EXT) / sizeof(GSM7_EXT[0]); i++) {
+    if (GSM7_EXT[i].cp == cp) {
+      out[0] = 0x1B;
+      out[1] = GSM7_EXT[i].septet;
+      return 2;
+    }
+  }
+  return 0;
+}
+
+// Septets (GSM7) or UTF-16 code units (UCS2) one code point occupies
+static uint8_t unitsFor(uint32_t cp, SmsEncoding enc) {
+  if (enc == SMS_ENC_UCS2) return cp > 0xFFFF ? 2 : 1;
+  uint8_t septets[2];
+  return gsm7Encode(cp, septets);
+}
+
+SmsEncoding smsPickEncoding(const char* utf8) {
+  const char* p = utf8;
+  uint8_t septets[2];
+  while (*p) {
+    if (gsm7Encode(nextCodepoint(p), septets) == 0) return SMS_ENC_UCS2;
+  }
+  return SMS_ENC_GSM7;
+}
+
+// Find the byte range of part `index`; characters are never split across parts
+static bool findPart(const char* utf8, SmsEncoding enc, uint8_t index, uint8_t total,
+                     const char** start, const char** end) {
+  uint16_t limit;
+  if (enc == SMS_ENC_GSM7) limit = total > 1 ? SMS_GSM7_MULTI : SMS_GSM7_SINGLE;
+  else limit = total > 1 ? SMS_UCS2_MULTI : SMS_UCS2_SINGLE;
+
+  const char* p = utf8;
+  const char* partBegin = utf8;
+  uint8_t part = 0;
+  uint16_t used = 0;
+
+  while (*p) {
+    const char* charBegin = p;
+    uint8_t units = unitsFor(nextCodepoint(p), enc);
+    if (used + units > limit) {
+      if (part == index) {
+        *start = partBegin;
+        *end = charBegin;
+        return true;
+      }
+      part++;
+      partBegin = charBegin;
+      used = 0;
+    }
+    used += units;
+  }
+
+  if (part != index) return false;
+  *start = partBegin;
+  *end = p;
+  return true;
+}
+
+uint8_t smsPartCount(const char* utf8) {
+  SmsEncoding enc = smsPickEncoding(utf8);
+  uint16_t single = enc == SMS_ENC_GSM7 ? SMS_GSM7_SINGLE : SMS_UCS2_SINGLE;
+  uint16_t multi = enc == SMS_ENC_GSM7 ? SMS_GSM7_MULTI : SMS_UCS2_MULTI;
+
+  const char* p = utf8;
+  uint16_t total = 0;
+  while (*p) total += unitsFor(nextCodepoint(p), enc);
+  if (total <= single) return 1;
+
+  // Walk again with the smaller limit so escape pairs and surrogates stay whole
+  p = utf8;
+  uint8_t parts = 1;
+  uint16_t used = 0;
+  while (*p) {
+    uint8_t units = unitsFor(nextCodepoint(p), enc);
+    if (used + units > multi) {
+      parts++;
+      used = 0;
+    }
+    used += units;
+  }
+  return parts;
+}
+
+uint8_t smsEncodePdu(const char* number, const char* utf8, uint8_t index, uint8_t total,
+                     uint8_t ref, char* hexOut, size_t hexCap) {
+  uint8_t tpdu[160];
+  memset(tpdu, 0, sizeof(tpdu));
+  if (total == 0 || index >= total) return 0;
+
+  SmsEncoding enc = smsPickEncoding(utf8);
+  const char* start;
+  const char* end;
+  if (!findPart(utf8, enc, index, total, &start, &end)) return 0;
+
+  uint8_t n = 0;
+  tpdu[n++] = total > 1 ? 0x41 : 0x01;  // SMS-SUBMIT, UDHI when concatenated
+  tpdu[n++] = 0x00;                      // Message reference set by the modem
+
+  // Destination address as swapped BCD semi-octets
+  bool international = (*number == '+');
+  char digits[20];
+  uint8_t nd = 0;
+  for (const char* p = number; *p; p++) {
+    if (*p >= '0' && *p <= '9') {
+      if (nd >= sizeof(digits)) return 0;
+      digits[nd++] = *p;
+    }
+  }
+  if (nd == 0) return 0;
+  tpdu[n++] = nd;
+  tpdu[n++] = international ? 0x91 : 0x81;
+  for (uint8_t i = 0; i < nd; i += 2) {
+    uint8_t lo = digits[i] - '0';
+    uint8_t hi = (i + 1 < nd) ? digits[i + 1] - '0' : 0x0F;
+    tpdu[n++] = (hi << 4) | lo;
+  }
+
+  tpdu[n++] = 0x00;                                 // TP-PID
+  tpdu[n++] = enc == SMS_ENC_UCS2 ? 0x08 : 0x00;    // TP-DCS
+  uint8_t udlPos = n++;
+  uint8_t udStart = n;
+
+  uint8_t udhLen = 0;
+  if (total > 1) {
+    tpdu[n++] = 0x05;  // UDH length
+    tpdu[n++] = 0x00;  // IEI: concatenated, 8-bit reference
+    tpdu[n++] = 0x03;
+    tpdu[n++] = ref;
+    tpdu[n++] = total;
+    tpdu[n++] = index + 1;
+    udhLen = 6;
+  }
+
+  if (enc == SMS_ENC_GSM7) {
+    // User data starts on the first septet boundary after the header
+    uint16_t startBit = ((udhLen * 8 + 6) / 7) * 7;
+    uint16_t count = 0;
+    const char* p = start;
+    while (p < end) {
+      uint8_t septets[2];
+      uint8_t k = gsm7Encode(nextCodepoint(p), septets);
+      for (uint8_t j = 0; j < k; j++) {
+        uint16_t bit = startBit + count * 7;
+        uint16_t byte = udStart + bit / 8;
+        uint8_t shift = bit % 8;
+        if ((size_t)byte + 1 >= sizeof(tpdu)) return 0;
+        tpdu[byte] |= (uint8_t)(septets[j] << shift);
+        if (shift > 1) tpdu[byte + 1] |= septets[j] >> (8 - shift);
+        count++;
+      }
+    }
+    tpdu[udlPos] = startBit / 7 + count;
+    n = udStart + (startBit + count * 7 + 7) / 8;
+  } else {
+    const char* p = start;
+    while (p < end) {
+      uint32_t cp = nextCodepoint(p);
+      uint16_t units[2];
+      uint8_t k = 1;
+      if (cp > 0xFFFF) {
+        cp -= 0x10000;
+        units[0] = 0xD800 | (cp >> 10);
+        units[1] = 0xDC00 | (cp & 0x3FF);
+        k = 2;
+      } else {
+        units[0] = (uint16_t)cp;
+      }
+      for (uint8_t j = 0; j < k; j++) {
+        if ((size_t)n + 2 > sizeof(tpdu)) return 0;
+        tpdu[n++] = units[j] >> 8;
+        tpdu[n++] = units[j] & 0xFF;
+      }
+    }
+    tpdu[udlPos] = n - udStart;
+  }
+
+  if (n - udStart > 140) return 0;
+  if (hexCap < 2 + (size_t)n * 2 + 1) return 0;
+
+  hexOut[0] = '0';
+  hexOut[1] = '0';
+  for (uint8_t i = 0; i < n; i++) {
+    hexOut[2 + i * 2] = HEX_DIGITS[tpdu[i] >> 4];
+    hexOut[3 + i * 2] = HEX_DIGITS[tpdu[i] & 0x0F];
+  }
+  hexOut[2 + n * 2] = '\0';
+  return n;
+}
+
+static int8_t hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Append one code point as UTF-8; false (and nothing written) if it does not fit
+static bool putUtf8(uint32_t cp, char* out, size_t cap, size_t& len) {
+  uint8_t bytes = cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+  if (len + bytes + 1 > cap) return false;
+  if (bytes == 1) {
+    out[len++] = (char)cp;
+  } else if (bytes == 2) {
+    out[len++] = (char)(0xC0 | (cp >> 6));
+    out[len++] = (char)(0x80 | (cp & 0x3F));
+  } else if (bytes == 3) {
+    out[len++] = (char)(0xE0 | (cp >> 12));
+    out[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[len++] = (char)(0x80 | (cp & 0x3F));
+  } else {
+    out[len++] = (char)(0xF0 | (cp >> 18));
+    out[len++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[len++] = (char)(0x80 | (cp & 0x3F));
+  }
+  out[len] = '\0';
+  return true;
+}
+
+// Unpack `count` septets starting `startBit` bits into `data` as UTF-8
+static void gsm7Decode(const uint8_t* data, uint16_t startBit, uint16_t count,
+                       char* out, size_t cap, size_t& len) {
+  bool escaped = false;
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t bit = startBit + i * 7;
+    uint16_t word = data[bit / 8] | ((uint16_t)data[bit / 8 + 1] << 8);
+    uint8_t septet = (word >> (bit % 8)) & 0x7F;
+
+    if (septet == 0x1B && !escaped) {
+      escaped = true;
+      continue;
+    }
+    uint16_t cp = GSM7_BASIC[septet];
+    if (escaped) {
+      // An unknown escape shows the basic character
+      for (uint8_t k = 0; k < sizeof(GSM7_EXT) / sizeof(GSM7_EXT[0]); k++) {
+        if (GSM7_EXT[k].septet == septet) cp = GSM7_EXT[k].cp;
+      }
+      escaped = false;
+    }
+    if (!putUtf8(cp, out, cap, len)) return;
+  }
+}
+
+bool smsDecodePdu(const char* hex, char* number, size_t numberCap, char* utf8, size_t textCap) {
+  // SMSC (12) + the largest SMS-DELIVER TPDU (1 + 12 + 1 + 1 + 7 + 1 + 140)
+  uint8_t pdu[176];
+  size_t n = 0;
+  while (hex[0] != '\0' && hex[1] != '\0') {
+    int8_t hi = hexValue(hex[0]);
+    int8_t lo = hexValue(hex[1]);
+    if (hi < 0 || lo < 0 || n + 1 >= sizeof(pdu)) return false;
+    pdu[n++] = (uint8_t)((hi << 4) | lo);
+    hex += 2;
+  }
+  pdu[n] = 0;  // Lets the septet reader look one octet past the end
+  if (numberCap == 0 || textCap == 0) return false;
+  number[0] = '\0';
+  utf8[0] = '\0';
+
+  size_t p = 0;
+  if (n == 0) return false;
+  p += 1 + pdu[0];  // SMSC address
+  if (p + 2 > n) return false;
+  uint8_t firstOctet = pdu[p++];
+  if ((firstOctet & 0x03) != 0x00) return false;  // Not SMS-DELIVER
+
+  // Originating address: length in semi-octets, type, then the digits
+  uint8_t oaDigits = pdu[p++];
+  uint8_t oaOctets = (oaDigits + 1) / 2;
+  if (p + 11 + oaOctets > n) return false;  // Through TP-UDL
+  uint8_t toa = pdu[p++];
+  size_t numLen = 0;
+  if ((toa & 0x70) == 0x50) {
+    // Alphanumeric sender ("SCHOOL"), packed like 7-bit user data
+    gsm7Decode(pdu + p, 0, oaDigits * 4 / 7, number, numberCap, numLen);
+  } else {
+    if ((toa & 0x70) == 0x10 && numberCap > 1) number[numLen++] = '+';
+    for (uint8_t i = 0; i < oaDigits && numLen + 1 < numberCap; i++) {
+      uint8_t nibble = (i & 1) ? pdu[p + i / 2] >> 4 : pdu[p + i / 2] & 0x0F;
+      if (nibble <= 9) number[numLen++] = '0' + nibble;
+      else if (nibble == 0x0A) number[numLen++] = '*';
+      else if (nibble == 0x0B) number[numLen++] = '#';
+    }
+    number[numLen] = '\0';
+  }
+  p += oaOctets;
+
+  p++;  // TP-PID
+  uint8_t dcs = pdu[p++];
+  p += 7;  // TP-SCTS, the service centre time stamp
+  uint8_t udl = pdu[p++];
+
+  SmsEncoding enc;
+  bool eightBit = false;
+  if ((dcs & 0xF0) == 0xF0) {
+    enc = SMS_ENC_GSM7;
+    eightBit = (dcs & 0x04) != 0;
+  } else if ((dcs & 0xF0) == 0xE0) {
+    enc = SMS_ENC_UCS2;
+  } else if ((dcs & 0xE0) == 0xC0) {
+    enc = SMS_ENC_GSM7;  // Message waiting indication
+  } else {
+    if (dcs & 0x20) return false;  // Compressed
+    uint8_t alphabet = (dcs >> 2) & 0x03;
+    if (alphabet == 3) return false;
+    enc = alphabet == 2 ? SMS_ENC_UCS2 : SMS_ENC_GSM7;
+    eightBit = alphabet == 1;
+  }
+
+  const uint8_t* ud = pdu + p;
+  size_t udOctets = n - p;
+  uint8_t udhOctets = 0;
+  if (firstOctet & 0x40) {
+    if (udOctets == 0) return false;
+    udhOctets = ud[0] + 1;
+  }
+
+  size_t textLen = 0;
+  if (enc == SMS_ENC_GSM7 && !eightBit) {
+    if (udl > 160 || ((size_t)udl * 7 + 7) / 8 > udOctets) return false;
+    // Text starts on the first septet boundary after the header
+    uint16_t startBit = ((udhOctets * 8 + 6) / 7) * 7;
+    if (startBit / 7 > udl) return false;
+    gsm7Decode(ud, startBit, udl - startBit / 7, utf8, textCap, textLen);
+    return true;
+  }
+
+  if (udl > udOctets || udhOctets > udl) return false;
+  if (eightBit) {
+    // No character set is defined for 8-bit data; show it as Latin-1
+    for (uint8_t i = udhOctets; i < udl; i++) {
+      if (!putUtf8(ud[i], utf8, textCap, textLen)) break;
+    }
+    return true;
+  }
+
+  for (uint8_t i = udhOctets; i + 1 < udl; i += 2) {
+    uint32_t cp = ((uint16_t)ud[i] << 8) | ud[i + 1];
+    if (cp >= 0xD800 && cp < 0xDC00 && i + 3 < udl) {
+      uint16_t low = ((uint16_t)ud[i + 2] << 8) | ud[i + 3];
+      if (low >= 0xDC00 && low < 0xE000) {
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        i += 2;
+      }
+    }
+    if (!putUtf8(cp, utf8, textCap, textLen)) break;
+  }
+  return true;
+}
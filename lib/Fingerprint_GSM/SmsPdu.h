@@ -0,0 +1,56 @@
+/**
+ * @file SmsPdu.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief SMS-SUBMIT PDU encoder and SMS-DELIVER decoder (GSM 03.38 7-bit, UCS2, concatenation)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Plain C++ with no Arduino dependencies so it can be checked on the host
+ * against known PDU vectors.
+ */
+#ifndef SMS_PDU_H
+#define SMS_PDU_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Septets per part: single message / part of a concatenated message
+#define SMS_GSM7_SINGLE 160
+#define SMS_GSM7_MULTI 153
+// UTF-16 code units per part
+#define SMS_UCS2_SINGLE 70
+#define SMS_UCS2_MULTI 67
+
+// "00" SMSC prefix + largest TPDU (12 header octets + 140 user data) in hex
+#define SMS_PDU_HEX_MAX 328
+
+enum SmsEncoding : uint8_t {
+  SMS_ENC_GSM7 = 0,
+  SMS_ENC_UCS2 = 1
+};
+
+// Encoding needed for a UTF-8 string: GSM7 unless a character falls
+// outside the GSM 03.38 default alphabet and its extension table.
+SmsEncoding smsPickEncoding(const char* utf8);
+
+// Number of SMS parts the text needs (1 when it fits a single message)
+uint8_t smsPartCount(const char* utf8);
+
+// Build the hex PDU for part `index` (0-based) of `total` parts, prefixed
+// with "00" so the SIM's default SMSC is used. `ref` is the concatenation
+// reference shared by all parts. Returns the TPDU length in octets for
+// AT+CMGS=<length>, or 0 if the inputs do not fit.
+uint8_t smsEncodePdu(const char* number, const char* utf8, uint8_t index, uint8_t total,
+                     uint8_t ref, char* hexOut, size_t hexCap);
+
+// Decode a received SMS-DELIVER PDU, hex with the SMSC prefix as +CMT and
+// +CMGR give it. The sender goes to `number` ("+" first for international
+// numbers) and the text to `utf8` as UTF-8, cut at a character boundary
+// to fit. A user data header is skipped, so each part of a concatenated
+// message decodes on its own. Returns false if the PDU is not a well-formed
+// SMS-DELIVER.
+bool smsDecodePdu(const char* hex, char* number, size_t numberCap, char* utf8, size_t textCap);
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file SpscQueue.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Bounded single-producer/single-consumer lock-free queue
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Exactly one task may call push() and exactly one task may call pop().
+ * The producer only writes `head`, the consumer only writes `tail`, so no
+ * lock is needed; acquire/release ordering publishes the slot contents.
+ */
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint16_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+  public:
+    SpscQueue() : head(0), tail(0), drops(0) {}
+
+    // Producer side. Returns false (and counts a drop) when full.
+    bool push(const T& item) {
+      uint32_t h = head.load(std::memory_order_relaxed);
+      if (h - tail.load(std::memory_order_acquire) >= N) {
+        drops++;
+        return false;
+      }
+      slots[h & (N - 1)] = item;
+      head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item) {
+      uint32_t t = tail.load(std::memory_order_relaxed);
+      if (t == head.load(std::memory_order_acquire)) return false;
+      item = slots[t & (N - 1)];
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    uint16_t size() const {
+      return (uint16_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+    uint16_t capacity() const { return N; }
+    uint32_t dropCount() const { return drops; }
+
+  private:
+    T slots[N];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    uint32_t drops;  // Written by the producer only
+};
+
+#endif
@@ -0,0 +1,475 @@
+/**
+ * @file TemplatePager.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Pages templates between ESP32 flash and the sensor's library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "TemplatePager.h"
+
+TemplatePager::TemplatePager(FingerprintLink* link, TemplateStore* store) {
+  this->link = link;
+  this->store = store;
+  this->slotIds = nullptr;
+  this->slotUsed = nullptr;
+  this->slotCount = 0;
+  this->clock = 0;
+  this->scheduleCount = 0;
+  this->scheduleCursor = 0;
+  this->fallbackBudget = 10;
+  this->fallbackCursor = 0;
+  this->hotSlots = 0;
+  this->promoteCount = 0;
+  this->chunkSlots = 0;
+  this->dirtyChunks = 0;
+  this->dirtyPersisted = 0;
+  this->dirtySince = 0;
+  memset(this->resident, 0, sizeof(this->resident));
+  memset(this->scheduled, 0, sizeof(this->scheduled));
+  memset(&this->stats, 0, sizeof(this->stats));
+}
+
+TemplatePager::~TemplatePager() {
+  delete[] slotIds;
+  delete[] slotUsed;
+}
+
+void TemplatePager::setBit(uint8_t* bits, uint16_t id, bool on) {
+  if (on) {
+    bits[id >> 3] |= 1 << (id & 7);
+  } else {
+    bits[id >> 3] &= ~(1 << (id & 7));
+  }
+}
+
+bool TemplatePager::begin(uint16_t slots) {
+  slotCount = slots;
+  chunkSlots = (slots + MAP_CHUNKS - 1) / MAP_CHUNKS;
+  slotIds = new uint16_t[slots];
+  slotUsed = new uint32_t[slots];
+  memset(slotIds, 0, slots * sizeof(uint16_t));
+  memset(slotUsed, 0, slots * sizeof(uint32_t));
+
+  if (!prefs.begin("pager", false)) {
+    Serial.println("[FP] ERROR: Cannot open pager state");
+    return false;
+  }
+
+  if (!loadMap() && !importLibrary()) return false;
+
+  for (uint16_t s = 0; s < slotCount; s++) {
+    if (slotIds[s] != 0) setBit(resident, slotIds[s], true);
+  }
+  setHotSlots(hotSlots);
+
+  Serial.print("[FP] Template pager: ");
+  Serial.print(slotCount);
+  Serial.print(" library slots, ");
+  Serial.print(store->count());
+  Serial.println(" templates in flash");
+  return true;
+}
+
+bool TemplatePager::importLibrary() {
+  // Library slots used before paging keep their number as the global ID
+  uint16_t imported = 0;
+  for (uint16_t s = 1; s < slotCount && s < TemplateStore::MAX_TEMPLATES; s++) {
+    if (link->loadChar(1, s) != FINGERPRINT_OK) continue;
+
+    uint16_t length;
+    if (link->uploadChar(1, buffer, sizeof(buffer), &length) != FINGERPRINT_OK ||
+        length != TemplateStore::TEMPLATE_SIZE || !store->save(s, buffer)) {
+      Serial.print("[FP] ERROR: Cannot import slot ");
+      Serial.println(s);
+      continue;
+    }
+    slotIds[s] = s;
+    imported++;
+  }
+
+  for (uint16_t s = 0; s < slotCount; s++) markSlot(s);
+  flushMap();
+  Serial.print("[FP] Imported ");
+  Serial.print(imported);
+  Serial.println(" templates from the sensor");
+  return true;
+}
+
+bool TemplatePager::loadMap() {
+  size_t mapSize = slotCount * sizeof(uint16_t);
+  char key[5];
+  for (uint8_t c = 0; c < MAP_CHUNKS && c * chunkSlots < slotCount; c++) {
+    uint16_t first = c * chunkSlots;
+    size_t length = chunkLength(c) * sizeof(uint16_t);
+    snprintf(key, sizeof(key), "m%u", c);
+    if (prefs.getBytes(key, slotIds + first, length) != length) {
+      memset(slotIds, 0, mapSize);
+      return false;
+    }
+  }
+
+  uint32_t dirty = prefs.getUInt("dirty", 0);
+  if (dirty != 0) recoverMap(dirty);
+  return true;
+}
+
+void TemplatePager::recoverMap(uint32_t chunks) {
+  // The library changed after these pieces were written: empty their slots
+  // so nothing is identified under a stale ID, and page them in again
+  uint16_t cleared = 0;
+  for (uint8_t c = 0; c < MAP_CHUNKS && c * chunkSlots < slotCount; c++) {
+    if (!(chunks & (1UL << c))) continue;
+    uint16_t first = c * chunkSlots;
+    uint16_t count = chunkLength(c);
+    link->deleteChar(first, count);
+    memset(slotIds + first, 0, count * sizeof(uint16_t));
+    dirtyChunks |= 1UL << c;
+    cleared += count;
+  }
+  dirtyPersisted = chunks;
+  flushMap();
+
+  Serial.print("[FP] Template pager: map not saved before power loss, emptied ");
+  Serial.print(cleared);
+  Serial.println(" slots");
+}
+
+uint16_t TemplatePager::chunkLength(uint8_t chunk) const {
+  uint16_t first = chunk * chunkSlots;
+  return slotCount - first < chunkSlots ? slotCount - first : chunkSlots;
+}
+
+void TemplatePager::guardSlot(uint16_t slot) {
+  // The dirty bit reaches NVS before the library slot changes, so a power
+  // cut in between still finds the slot's piece marked at begin()
+  uint32_t bit = 1UL << (slot / chunkSlots);
+  if (dirtyPersisted & bit) return;
+  dirtyPersisted |= bit;
+  prefs.putUInt("dirty", dirtyPersisted);
+}
+
+void TemplatePager::markSlot(uint16_t slot) {
+  dirtyChunks |= 1UL << (slot / chunkSlots);
+  dirtySince = millis();
+}
+
+void TemplatePager::writeChunk(uint8_t chunk) {
+  char key[5];
+  snprintf(key, sizeof(key), "m%u", chunk);
+  prefs.putBytes(key, slotIds + chunk * chunkSlots, chunkLength(chunk) * sizeof(uint16_t));
+}
+
+void TemplatePager::flushMap() {
+  if (dirtyChunks == 0) return;
+  for (uint8_t c = 0; c < MAP_CHUNKS; c++) {
+    if (dirtyChunks & (1UL << c)) writeChunk(c);
+  }
+  dirtyChunks = 0;
+  if (dirtyPersisted != 0) {
+    prefs.putUInt("dirty", 0);
+    dirtyPersisted = 0;
+  }
+}
+
+bool TemplatePager::isResident(uint16_t id) const {
+  return id != 0 && id < TemplateStore::MAX_TEMPLATES && testBit(resident, id);
+}
+
+uint16_t TemplatePager::slotOf(uint16_t id) const {
+  if (!isResident(id)) return NOT_RESIDENT;
+  for (uint16_t s = 0; s < slotCount; s++) {
+    if (slotIds[s] == id) return s;
+  }
+  return NOT_RESIDENT;
+}
+
+void TemplatePager::setSchedule(const uint16_t* ids, uint16_t count) {
+  memset(scheduled, 0, sizeof(scheduled));
+  scheduleCount = 0;
+  for (uint16_t i = 0; i < count && scheduleCount < SCHEDULE_MAX; i++) {
+    if (ids[i] == 0 || ids[i] >= TemplateStore::MAX_TEMPLATES) continue;
+    schedule[scheduleCount++] = ids[i];
+    setBit(scheduled, ids[i], true);
+  }
+  scheduleCursor = 0;
+}
+
+void TemplatePager::setHotSlots(uint16_t count) {
+  // The rest of the library must keep at least one slot
+  if (slotCount > 0 && count >= slotCount) count = slotCount - 1;
+  hotSlots = count;
+  promoteCount = 0;
+  scheduleCursor = 0;  // Scheduled templates outside the region move in
+}
+
+uint16_t TemplatePager::pickVictim(uint16_t first, uint16_t end) {
+  // An empty slot, else the least recently used unscheduled one, else the LRU slot
+  uint16_t lru = first;
+  uint16_t lruUnscheduled = NOT_RESIDENT;
+  for (uint16_t s = first; s < end; s++) {
+    if (slotIds[s] == 0) return s;
+    if (slotUsed[s] < slotUsed[lru]) lru = s;
+    if (!testBit(scheduled, slotIds[s]) &&
+        (lruUnscheduled == NOT_RESIDENT || slotUsed[s] < slotUsed[lruUnscheduled])) {
+      lruUnscheduled = s;
+    }
+  }
+  return lruUnscheduled != NOT_RESIDENT ? lruUnscheduled : lru;
+}
+
+uint16_t TemplatePager::slotFor(uint16_t id) {
+  // Scheduled templates go to the hot region unless it is full of them
+  if (hotSlots > 0 && testBit(scheduled, id)) {
+    uint16_t slot = pickVictim(0, hotSlots);
+    if (slotIds[slot] == 0 || !testBit(scheduled, slotIds[slot])) return slot;
+  }
+  return pickVictim(hotSlots, slotCount);
+}
+
+bool TemplatePager::place(uint8_t charBuffer, uint16_t id) {
+  uint16_t slot = slotFor(id);
+  guardSlot(slot);
+  if (link->storeChar(charBuffer, slot) != FINGERPRINT_OK) return false;
+
+  if (slotIds[slot] != 0) {
+    setBit(resident, slotIds[slot], false);
+    stats.evictions++;
+  }
+  slotIds[slot] = id;
+  slotUsed[slot] = ++clock;
+  setBit(resident, id, true);
+  stats.loads++;
+  markSlot(slot);
+  return true;
+}
+
+bool TemplatePager::moveHot(uint16_t slot) {
+  uint16_t id = slotIds[slot];
+  uint16_t hot = pickVictim(0, hotSlots);
+  uint16_t other = slotIds[hot];
+  // Scheduled templates keep their hot slots
+  if (other != 0 && testBit(scheduled, other)) return false;
+
+  // Swap through the two CharBuffers; an empty hot slot is a plain move
+  guardSlot(slot);
+  guardSlot(hot);
+  if (link->loadChar(2, slot) != FINGERPRINT_OK) return false;
+  if (other != 0 && (link->loadChar(1, hot) != FINGERPRINT_OK || link->storeChar(1, slot) != FINGERPRINT_OK)) {
+    return false;
+  }
+  if (link->storeChar(2, hot) != FINGERPRINT_OK) {
+    if (other != 0) {
+      // `slot` already holds a copy of the other template
+      link->deleteChar(slot);
+      slotIds[slot] = 0;
+      setBit(resident, id, false);
+      markSlot(slot);
+    }
+    return false;
+  }
+  if (other == 0) link->deleteChar(slot);
+
+  uint32_t used = slotUsed[slot];
+  slotIds[slot] = other;
+  slotUsed[slot] = slotUsed[hot];
+  slotIds[hot] = id;
+  slotUsed[hot] = used;
+  stats.moves++;
+  markSlot(slot);
+  markSlot(hot);
+  return true;
+}
+
+void TemplatePager::queuePromotion(uint16_t id) {
+  for (uint8_t i = 0; i < promoteCount; i++) {
+    if (promote[i] == id) return;
+  }
+  if (promoteCount == PROMOTE_MAX) {
+    memmove(promote, promote + 1, (PROMOTE_MAX - 1) * sizeof(uint16_t));
+    promoteCount--;
+  }
+  promote[promoteCount++] = id;
+}
+
+void TemplatePager::poll() {
+  // Slot map: guardSlot() already noted the changed pieces, write them once quiet
+  if (dirtyChunks != 0 && millis() - dirtySince >= MAP_FLUSH_MS) flushMap();
+
+  // Load or move at most one scheduled template per call, never at another's expense
+  while (scheduleCursor < scheduleCount) {
+    uint16_t id = schedule[scheduleCursor++];
+    if (!store->exists(id)) continue;
+    if (isResident(id)) {
+      uint16_t slot = slotOf(id);
+      if (slot < hotSlots || hotSlots == 0) continue;
+      if (moveHot(slot)) return;
+      continue;
+    }
+
+    uint16_t victim = slotFor(id);
+    if (slotIds[victim] != 0 && testBit(scheduled, slotIds[victim])) {
+      scheduleCursor = scheduleCount;  // Library full of scheduled templates
+      return;
+    }
+    if (store->load(id, buffer) &&
+        link->downloadChar(2, buffer, TemplateStore::TEMPLATE_SIZE) == FINGERPRINT_OK) {
+      place(2, id);
+    }
+    return;
+  }
+
+  // Then one recently seen template from outside the hot region
+  while (promoteCount > 0) {
+    uint16_t id = promote[0];
+    memmove(promote, promote + 1, (promoteCount - 1) * sizeof(uint16_t));
+    promoteCount--;
+    uint16_t slot = slotOf(id);
+    if (slot == NOT_RESIDENT || slot < hotSlots) continue;
+    if (moveHot(slot)) return;
+  }
+}
+
+bool TemplatePager::tryCandidate(uint16_t id, uint16_t* score) {
+  stats.candidates++;
+  if (!store->load(id, buffer)) return false;
+  if (link->downloadChar(2, buffer, TemplateStore::TEMPLATE_SIZE) != FINGERPRINT_OK) return false;
+  if (link->match(score) != FINGERPRINT_OK) return false;
+
+  // Promote it so the next scan is a library hit
+  place(2, id);
+  return true;
+}
+
+uint8_t TemplatePager::identify(uint16_t* id, uint16_t* score) {
+  // The hot region first, the rest of the library only on a miss
+  uint16_t slot;
+  uint8_t rc = FINGERPRINT_NOTFOUND;
+  if (hotSlots > 0) rc = link->search(1, 0, hotSlots, &slot, score);
+  if (rc == FINGERPRINT_NOTFOUND) rc = link->search(1, hotSlots, slotCount - hotSlots, &slot, score);
+  if (rc != FINGERPRINT_OK && rc != FINGERPRINT_NOTFOUND) return rc;
+
+  stats.lookups++;
+  if (rc == FINGERPRINT_OK && slot < slotCount && slotIds[slot] != 0) {
+    slotUsed[slot] = ++clock;
+    stats.hits++;
+    if (slot < hotSlots) {
+      stats.hotHits++;
+    } else if (hotSlots > 0) {
+      queuePromotion(slotIds[slot]);
+    }
+    *id = slotIds[slot];
+    return FINGERPRINT_OK;
+  }
+
+  // Library miss: scheduled templates that are not loaded yet are the likeliest
+  unsigned long start = millis();
+  uint16_t tried = 0;
+  uint16_t found = 0;
+  for (uint16_t i = 0; i < scheduleCount && !found && tried < fallbackBudget; i++) {
+    uint16_t candidate = schedule[i];
+    if (isResident(candidate) || !store->exists(candidate)) continue;
+    tried++;
+    if (tryCandidate(candidate, score)) found = candidate;
+  }
+  // Then the rest of flash, from where the last miss stopped
+  uint16_t first = 0;
+  uint16_t candidate = store->next(fallbackCursor);
+  if (candidate == 0) candidate = store->next(0);
+  while (candidate != 0 && candidate != first && !found && tried < fallbackBudget) {
+    if (first == 0) first = candidate;
+    if (!isResident(candidate) && !testBit(scheduled, candidate)) {
+      tried++;
+      fallbackCursor = candidate;
+      if (tryCandidate(candidate, score)) found = candidate;
+    }
+    candidate = store->next(candidate);
+    if (candidate == 0) candidate = store->next(0);
+  }
+
+  uint32_t penalty = millis() - start;
+  stats.penaltySumMs += penalty;
+  if (penalty > stats.penaltyMaxMs) stats.penaltyMaxMs = penalty;
+
+  if (!found) {
+    stats.misses++;
+    return FINGERPRINT_NOTFOUND;
+  }
+  stats.fallbackHits++;
+  if (hotSlots > 0 && slotOf(found) >= hotSlots) queuePromotion(found);
+  *id = found;
+  return FINGERPRINT_OK;
+}
+
+bool TemplatePager::enroll(uint16_t id) {
+  if (id == 0 || id >= TemplateStore::MAX_TEMPLATES) return false;
+
+  uint16_t length;
+  if (link->uploadChar(1, buffer, sizeof(buffer), &length) != FINGERPRINT_OK ||
+      length != TemplateStore::TEMPLATE_SIZE) {
+    return false;
+  }
+  if (!store->save(id, buffer)) return false;
+
+  // Re-enrolling overwrites the slot the old template was in
+  uint16_t slot = slotOf(id);
+  if (slot != NOT_RESIDENT) {
+    slotUsed[slot] = ++clock;
+    return link->storeChar(1, slot) == FINGERPRINT_OK;
+  }
+  bool ok = place(1, id);
+  flushMap();
+  return ok;
+}
+
+bool TemplatePager::remove(uint16_t id) {
+  uint16_t slot = slotOf(id);
+  if (slot != NOT_RESIDENT) {
+    guardSlot(slot);
+    link->deleteChar(slot);
+    slotIds[slot] = 0;
+    slotUsed[slot] = 0;
+    setBit(resident, id, false);
+    markSlot(slot);
+    flushMap();
+  }
+  return store->remove(id);
+}
+
+void TemplatePager::printStats() {
+  Serial.println("\n[FP] === Template Paging ===");
+  Serial.print("Library slots: "); Serial.println(slotCount);
+  Serial.print("Templates in flash: "); Serial.println(store->count());
+  Serial.print("Lookups: "); Serial.println(stats.lookups);
+  if (stats.lookups > 0) {
+    Serial.print("Hit rate: ");
+    Serial.print(stats.hits * 100UL / stats.lookups);
+    Serial.println("%");
+  }
+  if (hotSlots > 0) {
+    Serial.print("Hot region: "); Serial.print(hotSlots); Serial.println(" slots");
+    if (stats.lookups > 0) {
+      Serial.print("Hot hit rate: ");
+      Serial.print(stats.hotHits * 100UL / stats.lookups);
+      Serial.println("%");
+    }
+    Serial.print("Moved in: "); Serial.println(stats.moves);
+  }
+  Serial.print("Fallback hits: "); Serial.println(stats.fallbackHits);
+  Serial.print("Misses: "); Serial.println(stats.misses);
+  uint32_t fallbacks = stats.fallbackHits + stats.misses;
+  if (fallbacks > 0) {
+    Serial.print("Miss penalty: avg ");
+    Serial.print(stats.penaltySumMs / fallbacks);
+    Serial.print(" ms, max ");
+    Serial.print(stats.penaltyMaxMs);
+    Serial.print(" ms, ");
+    Serial.print(stats.candidates / fallbacks);
+    Serial.println(" templates compared");
+  }
+  Serial.print("Loads: "); Serial.print(stats.loads);
+  Serial.print(" Evictions: "); Serial.println(stats.evictions);
+  Serial.println("============================\n");
+}
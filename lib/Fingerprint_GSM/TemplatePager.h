@@ -0,0 +1,140 @@
+/**
+ * @file TemplatePager.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Pages templates between ESP32 flash and the sensor's library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The sensor library acts as a cache of the full template set held in
+ * TemplateStore. Fingerprints are known by a global ID (1..2047); the pager
+ * maps library slots to global IDs. Templates scheduled for the current
+ * period are loaded ahead of time; other slots are recycled least recently
+ * used first. A library miss falls back to matching paged-out templates one
+ * by one (DownChar into CharBuffer2, then Match), and a fallback hit is
+ * promoted into the library.
+ *
+ * With a hot region (setHotSlots), slots 0..n-1 hold the scheduled and most
+ * recently seen templates and are searched before the rest of the library.
+ * Scheduled templates are loaded straight into it; a hit outside it is
+ * moved in by poll(), swapping with the least recently used hot slot.
+ *
+ * The slot map is kept in NVS in MAP_CHUNKS pieces. Before a library slot
+ * changes, its piece is added to a small dirty mask in NVS (once per piece
+ * until the next flush); poll() writes the pieces themselves after
+ * MAP_FLUSH_MS without changes. After a power cut the slots in pieces
+ * still marked dirty are emptied at begin() and paged in again from flash,
+ * so a stale map never names the wrong ID.
+ */
+#ifndef TEMPLATE_PAGER_H
+#define TEMPLATE_PAGER_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "FingerprintLink.h"
+#include "TemplateStore.h"
+
+struct PagerStats {
+  uint32_t lookups;       // identify() calls that reached the library
+  uint32_t hits;          // Found in the sensor library
+  uint32_t hotHits;       // ... in the hot region
+  uint32_t moves;         // Templates moved into the hot region
+  uint32_t fallbackHits;  // Found among paged-out templates
+  uint32_t misses;        // Not found, or fallback budget used up
+  uint32_t candidates;    // Paged-out templates compared after a library miss
+  uint32_t loads;         // Templates written into the library
+  uint32_t evictions;
+  uint32_t penaltySumMs;  // Time spent in fallback searches
+  uint32_t penaltyMaxMs;
+};
+
+class TemplatePager {
+  public:
+    static const uint16_t SCHEDULE_MAX = 256;
+    static const uint8_t PROMOTE_MAX = 8;  // Cold hits waiting to move into the hot region
+    static const uint16_t NOT_RESIDENT = 0xFFFF;
+    static const uint8_t MAP_CHUNKS = 32;
+    static const uint32_t MAP_FLUSH_MS = 5000;
+
+    TemplatePager(FingerprintLink* link, TemplateStore* store);
+    ~TemplatePager();
+
+    // Manage library slots 0..slots-1. On first use, templates already in the
+    // library are imported into flash under their slot number.
+    bool begin(uint16_t slots);
+
+    // Global IDs expected this period; poll() loads them one per call
+    void setSchedule(const uint16_t* ids, uint16_t count);
+    // Most paged-out templates compared per library miss (about 90 ms each).
+    // The walk resumes where the last miss stopped, so a finger that is
+    // tried again reaches the next templates.
+    void setFallbackBudget(uint16_t candidates) { fallbackBudget = candidates; }
+    // Slots 0..count-1 form the hot region, searched first; 0 turns it off
+    void setHotSlots(uint16_t count);
+    uint16_t hotSlotCount() const { return hotSlots; }
+    void poll();
+    // Write pending slot map changes now
+    void flushMap();
+
+    // Features must already be in CharBuffer1 (image2Tz). Returns
+    // FINGERPRINT_OK with the global ID, FINGERPRINT_NOTFOUND, or a link error.
+    uint8_t identify(uint16_t* id, uint16_t* score);
+    // After createModel: keep CharBuffer1 in flash and load it into the library
+    bool enroll(uint16_t id);
+    bool remove(uint16_t id);
+
+    bool isResident(uint16_t id) const;
+    uint16_t slotOf(uint16_t id) const;
+    const PagerStats& getStats() const { return stats; }
+    void printStats();
+
+  private:
+    FingerprintLink* link;
+    TemplateStore* store;
+    Preferences prefs;
+
+    uint16_t* slotIds;    // Global ID held by each library slot, 0 = empty
+    uint32_t* slotUsed;   // LRU stamp per slot
+    uint16_t slotCount;
+    uint32_t clock;
+    uint8_t resident[TemplateStore::MAX_TEMPLATES / 8];
+    uint8_t scheduled[TemplateStore::MAX_TEMPLATES / 8];
+
+    uint16_t schedule[SCHEDULE_MAX];
+    uint16_t scheduleCount;
+    uint16_t scheduleCursor;
+    uint16_t fallbackBudget;
+    uint16_t fallbackCursor;  // Last paged-out ID compared
+    uint16_t hotSlots;
+    uint16_t promote[PROMOTE_MAX];  // Global IDs, oldest first
+    uint8_t promoteCount;
+
+    uint16_t chunkSlots;
+    uint32_t dirtyChunks;      // Pieces of the map not yet in NVS
+    uint32_t dirtyPersisted;   // The mask as last written to NVS
+    unsigned long dirtySince;  // millis() of the last change
+
+    uint8_t buffer[TemplateStore::TEMPLATE_SIZE];
+    PagerStats stats;
+
+    static bool testBit(const uint8_t* bits, uint16_t id) { return bits[id >> 3] & (1 << (id & 7)); }
+    static void setBit(uint8_t* bits, uint16_t id, bool on);
+
+    // Slot to reuse among [first, end)
+    uint16_t pickVictim(uint16_t first, uint16_t end);
+    uint16_t slotFor(uint16_t id);
+    bool place(uint8_t charBuffer, uint16_t id);
+    bool moveHot(uint16_t slot);
+    void queuePromotion(uint16_t id);
+    bool tryCandidate(uint16_t id, uint16_t* score);
+    bool importLibrary();
+    bool loadMap();
+    void recoverMap(uint32_t chunks);
+    uint16_t chunkLength(uint8_t chunk) const;  // Slots in one piece of the map
+    void guardSlot(uint16_t slot);
+    void markSlot(uint16_t slot);
+    void writeChunk(uint8_t chunk);
+};
+
+#endif
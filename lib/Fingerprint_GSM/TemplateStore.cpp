@@ -0,0 +1,117 @@
+/**
+ * @file TemplateStore.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Full fingerprint template set kept in ESP32 flash (LittleFS)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "TemplateStore.h"
+
+static const char* TEMPLATE_DIR = "/t";
+static const char* PRESENCE_FILE = "/templates.map";
+
+static void templatePath(uint16_t id, char* path, size_t size) {
+  snprintf(path, size, "%s/%u", TEMPLATE_DIR, id);
+}
+
+TemplateStore::TemplateStore() {
+  this->stored = 0;
+  this->ready = false;
+  memset(this->present, 0, sizeof(this->present));
+}
+
+bool TemplateStore::begin() {
+  if (!LittleFS.begin(true)) {
+    Serial.println("[FP] ERROR: Cannot mount template storage");
+    return false;
+  }
+
+  File map = LittleFS.open(PRESENCE_FILE, "r");
+  if (map) {
+    map.read(present, sizeof(present));
+    map.close();
+  }
+  LittleFS.mkdir(TEMPLATE_DIR);
+
+  stored = 0;
+  for (uint16_t i = 0; i < sizeof(present); i++) {
+    stored += __builtin_popcount(present[i]);
+  }
+  ready = true;
+
+  Serial.print("[FP] Template store: ");
+  Serial.print(stored);
+  Serial.println(" templates in flash");
+  return true;
+}
+
+bool TemplateStore::writePresence() {
+  File map = LittleFS.open(PRESENCE_FILE, "w");
+  if (!map) return false;
+  bool ok = map.write(present, sizeof(present)) == sizeof(present);
+  map.close();
+  return ok;
+}
+
+bool TemplateStore::exists(uint16_t id) const {
+  if (id == 0 || id >= MAX_TEMPLATES) return false;
+  return present[id >> 3] & (1 << (id & 7));
+}
+
+uint16_t TemplateStore::next(uint16_t id) const {
+  for (uint16_t i = id + 1; i < MAX_TEMPLATES; i++) {
+    if (present[i >> 3] == 0) {
+      i |= 7;  // Skip the rest of an empty byte
+      continue;
+    }
+    if (present[i >> 3] & (1 << (i & 7))) return i;
+  }
+  return 0;
+}
+
+bool TemplateStore::save(uint16_t id, const uint8_t* data) {
+  if (!ready || id == 0 || id >= MAX_TEMPLATES) return false;
+
+  char path[12];
+  templatePath(id, path, sizeof(path));
+  File file = LittleFS.open(path, "w");
+  if (!file) return false;
+  bool ok = file.write(data, TEMPLATE_SIZE) == TEMPLATE_SIZE;
+  file.close();
+  if (!ok) return false;
+
+  // The bitmap is written after the data, so a power cut never exposes a torn template
+  if (!exists(id)) {
+    present[id >> 3] |= 1 << (id & 7);
+    stored++;
+    return writePresence();
+  }
+  return true;
+}
+
+bool TemplateStore::load(uint16_t id, uint8_t* data) {
+  if (!exists(id)) return false;
+
+  char path[12];
+  templatePath(id, path, sizeof(path));
+  File file = LittleFS.open(path, "r");
+  if (!file) return false;
+  bool ok = file.read(data, TEMPLATE_SIZE) == TEMPLATE_SIZE;
+  file.close();
+  return ok;
+}
+
+bool TemplateStore::remove(uint16_t id) {
+  if (!exists(id)) return false;
+  present[id >> 3] &= ~(1 << (id & 7));
+  stored--;
+  if (!writePresence()) return false;
+
+  char path[12];
+  templatePath(id, path, sizeof(path));
+  LittleFS.remove(path);
+  return true;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file TemplateStore.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Full fingerprint template set kept in ESP32 flash (LittleFS)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Each template is its own 512-byte file, /t/<id>. LittleFS is copy-on-write,
+ * so a write into the middle of one large file would copy everything after
+ * it; a file per ID keeps enrolment to one 512-byte write however full the
+ * library is. A 256-byte presence bitmap, loaded at begin(), says which IDs
+ * are in use.
+ */
+#ifndef TEMPLATE_STORE_H
+#define TEMPLATE_STORE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "FingerprintLink.h"
+
+class TemplateStore {
+  public:
+    static const uint16_t MAX_TEMPLATES = 2048;  // Global IDs 1..2047
+    static const uint16_t TEMPLATE_SIZE = FingerprintLink::TEMPLATE_SIZE;
+
+    TemplateStore();
+
+    // Mount LittleFS (formatting it on first use) and load the bitmap
+    bool begin();
+
+    bool save(uint16_t id, const uint8_t* data);
+    bool load(uint16_t id, uint8_t* data);
+    bool remove(uint16_t id);
+    bool exists(uint16_t id) const;
+    uint16_t count() const { return stored; }
+    // Next stored ID after `id` (pass 0 to start), 0 when there are no more
+    uint16_t next(uint16_t id) const;
+
+  private:
+    uint8_t present[MAX_TEMPLATES / 8];
+    uint16_t stored;
+    bool ready;
+
+    bool writePresence();
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file TextBuffer.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Fixed-size text buffer for messages and screen lines
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The size is a template parameter and the buffer lives wherever it is
+ * declared (usually the stack), so building a message never touches the
+ * heap. Message templates are printf formats; format() carries the printf
+ * attribute, so the compiler checks the arguments against a literal
+ * template. Text that does not fit is cut off and truncated() says so.
+ */
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+template <size_t N>
+class TextBuffer {
+  public:
+    TextBuffer() { clear(); }
+
+    void clear() {
+      len = 0;
+      cut = false;
+      text[0] = '\0';
+    }
+
+    TextBuffer& add(const char* s) {
+      while (*s != '\0' && len < N - 1) text[len++] = *s++;
+      if (*s != '\0') cut = true;
+      text[len] = '\0';
+      return *this;
+    }
+
+    TextBuffer& add(char c) {
+      if (len < N - 1) {
+        text[len++] = c;
+        text[len] = '\0';
+      } else {
+        cut = true;
+      }
+      return *this;
+    }
+
+    // Append printf-style
+    TextBuffer& format(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+      va_list args;
+      va_start(args, fmt);
+      int n = vsnprintf(text + len, N - len, fmt, args);
+      va_end(args);
+      if (n < 0) {
+        text[len] = '\0';
+      } else if ((size_t)n >= N - len) {
+        len = N - 1;
+        cut = true;
+      } else {
+        len += n;
+      }
+      return *this;
+    }
+
+    const char* c_str() const { return text; }
+    operator const char*() const { return text; }
+    size_t length() const { return len; }
+    bool truncated() const { return cut; }
+    static size_t capacity() { return N - 1; }
+
+  private:
+    char text[N];
+    size_t len;
+    bool cut;
+};
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file UserHash.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Open-addressing hash from a key hash to user IDs
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "UserHash.h"
+
+static const uint16_t DELETED = 0xFFFF;
+
+// Slots that hold `entries` at three-quarters load. Not rounded to a power
+// of two: that would cost up to a third more memory for a cheaper modulo.
+static uint16_t slotsFor(uint16_t entries) {
+  uint32_t slots = (uint32_t)entries * 4 / 3 + 1;
+  return slots < UserHash::MIN_SLOTS ? UserHash::MIN_SLOTS : slots;
+}
+
+UserHash::UserHash() {
+  this->ids = nullptr;
+  this->tags = nullptr;
+  this->slots = 0;
+  this->used = 0;
+  this->deleted = 0;
+}
+
+UserHash::~UserHash() {
+  delete[] ids;
+  delete[] tags;
+}
+
+bool UserHash::reset(uint16_t entries) {
+  uint16_t size = slotsFor(entries);
+  if (size != slots) {
+    delete[] ids;
+    delete[] tags;
+    ids = new uint16_t[size];
+    tags = new uint8_t[size];
+    slots = size;
+  }
+  memset(ids, 0, slots * sizeof(uint16_t));
+  used = 0;
+  deleted = 0;
+  return true;
+}
+
+uint16_t UserHash::grow() const {
+  // Tombstones count against the load, a rebuild drops them
+  if (slots > 0 && (uint32_t)(used + deleted + 1) * 4 <= (uint32_t)slots * 3) return 0;
+  return used + 1;
+}
+
+void UserHash::insert(uint32_t hash, uint16_t id) {
+  if (slots == 0) return;
+  for (uint16_t i = 0, s = home(hash); i < slots; i++, s = s + 1 < slots ? s + 1 : 0) {
+    if (ids[s] == 0 || ids[s] == DELETED) {
+      if (ids[s] == DELETED) deleted--;
+      ids[s] = id;
+      tags[s] = tagOf(hash);
+      used++;
+      return;
+    }
+  }
+}
+
+void UserHash::erase(uint32_t hash, uint16_t id) {
+  if (slots == 0) return;
+  for (uint16_t i = 0, s = home(hash); i < slots && ids[s] != 0; i++, s = s + 1 < slots ? s + 1 : 0) {
+    if (ids[s] == id) {
+      ids[s] = DELETED;
+      used--;
+      deleted++;
+      return;
+    }
+  }
+}
+
+uint16_t UserHash::find(uint32_t hash, uint16_t& cursor) const {
+  uint8_t tag = tagOf(hash);
+  while (cursor < slots) {
+    uint16_t s = home(hash) + cursor;
+    if (s >= slots) s -= slots;
+    cursor++;
+    if (ids[s] == 0) break;  // End of the probe run
+    if (ids[s] != DELETED && tags[s] == tag) return ids[s];
+  }
+  cursor = END;
+  return 0;
+}
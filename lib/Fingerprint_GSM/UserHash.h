@@ -0,0 +1,56 @@
+/**
+ * @file UserHash.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Open-addressing hash from a key hash to user IDs
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * A slot is three bytes: the user ID and eight bits of the key hash (the
+ * tag). Keys themselves are not kept; the caller checks a candidate against
+ * the user record, and the tag makes a wrong candidate rare. Several IDs may
+ * share a key (siblings with one guardian phone), so find() walks every
+ * candidate. Linear probing, tombstones on erase, and the owner rebuilds the
+ * table when grow() says it is time.
+ */
+#ifndef USER_HASH_H
+#define USER_HASH_H
+
+#include <Arduino.h>
+
+class UserHash {
+  public:
+    static const uint16_t MIN_SLOTS = 16;
+    static const uint16_t END = 0xFFFF;  // find() cursor past the last slot
+
+    UserHash();
+    ~UserHash();
+
+    // Empty table with room for `entries` at the load limit
+    bool reset(uint16_t entries);
+    // Slots needed for the entries plus one more, 0 if the table is fine
+    uint16_t grow() const;
+
+    void insert(uint32_t hash, uint16_t id);
+    void erase(uint32_t hash, uint16_t id);
+
+    // Candidates for `hash`: start with cursor = 0, returns 0 when done
+    uint16_t find(uint32_t hash, uint16_t& cursor) const;
+
+    uint16_t size() const { return slots; }
+    uint16_t count() const { return used; }
+    size_t memoryUsed() const { return (size_t)slots * (sizeof(uint16_t) + sizeof(uint8_t)); }
+
+  private:
+    uint16_t* ids;       // 0 empty, DELETED tombstone
+    uint8_t* tags;
+    uint16_t slots;
+    uint16_t used;
+    uint16_t deleted;
+
+    uint16_t home(uint32_t hash) const { return hash % slots; }
+    static uint8_t tagOf(uint32_t hash) { return hash >> 24; }
+};
+
+#endif
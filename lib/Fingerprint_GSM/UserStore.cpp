@@ -0,0 +1,475 @@
+/**
+ * @file UserStore.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Persistent user records in a dedicated flash partition
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "UserStore.h"
+
+static const uint32_t USER_MAGIC = 0x52535555;  // "UUSR"
+static const uint8_t USERS_SUBTYPE = 0x41;
+static const uint8_t RECORD_LIVE = 0xFE;
+static const uint8_t RECORD_DEAD = 0x00;
+static const uint32_t ERASED_SEQ = 0xFFFFFFFF;
+
+// Bytes covered by the check byte; the erased spare area is not read
+static const uint8_t RECORD_USED = 8 + sizeof(UserData);
+
+UserStore::UserStore(uint16_t maxIds) {
+  this->partition = nullptr;
+  this->maxIds = maxIds;
+  this->slotOf = new uint16_t[maxIds];
+  this->stored = 0;
+  this->sectors = 0;
+  this->head = -1;
+  this->headFill = SLOTS_PER_SECTOR;
+  this->headSeq = 0;
+  this->nextSeq = 1;
+  this->cacheClock = 0;
+  this->hits = 0;
+  this->misses = 0;
+  memset(this->slotOf, 0xFF, maxIds * sizeof(uint16_t));
+  memset(this->cache, 0, sizeof(this->cache));
+#ifdef ARDUINO_ARCH_ESP32
+  this->lock = xSemaphoreCreateMutex();
+#endif
+}
+
+UserStore::~UserStore() {
+  delete[] slotOf;
+}
+
+void UserStore::take() {
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreTake(lock, portMAX_DELAY);
+#endif
+}
+
+void UserStore::give() {
+#ifdef ARDUINO_ARCH_ESP32
+  xSemaphoreGive(lock);
+#endif
+}
+
+uint8_t UserStore::checkByte(const Record& record) {
+  const uint8_t* b = (const uint8_t*)&record;
+  uint8_t x = 0x5A;
+  for (uint8_t i = 0; i < RECORD_USED; i++) {
+    if (i == offsetof(Record, state) || i == offsetof(Record, check)) continue;
+    x ^= b[i];
+  }
+  return x;
+}
+
+uint16_t UserStore::capacity() const {
+  if (sectors < 3) return 0;
+  return (sectors - 2) * (SLOTS_PER_SECTOR - 1);
+}
+
+bool UserStore::begin(const char* label) {
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)USERS_SUBTYPE, label);
+  if (partition == nullptr) {
+    Serial.println("[USER] ERROR: User partition not found");
+    return false;
+  }
+
+  sectors = partition->size / SECTOR_SIZE;
+  if (sectors < 3) {
+    Serial.println("[USER] ERROR: User partition too small");
+    partition = nullptr;
+    return false;
+  }
+
+  // The head is the sector opened last
+  for (uint16_t s = 0; s < sectors; s++) {
+    SectorHeader header;
+    esp_partition_read(partition, (uint32_t)s * SECTOR_SIZE, &header, sizeof(header));
+    if (header.magic == USER_MAGIC && (head < 0 || header.seq > headSeq)) {
+      head = s;
+      headSeq = header.seq;
+    }
+  }
+
+  // Records are indexed where they lie. A user found twice (power cut
+  // between writing a new copy and killing the old one) keeps the newer,
+  // or on a tie the copy in the head sector.
+  for (uint16_t s = 0; s < sectors; s++) {
+    SectorHeader header;
+    esp_partition_read(partition, (uint32_t)s * SECTOR_SIZE, &header, sizeof(header));
+    if (header.magic != USER_MAGIC) continue;
+
+    for (uint8_t i = 1; i < SLOTS_PER_SECTOR; i++) {
+      uint16_t slot = s * SLOTS_PER_SECTOR + i;
+      Record record;
+      esp_partition_read(partition, offsetOf(slot), &record, RECORD_USED);
+      if (record.seq == ERASED_SEQ) break;  // Written in order, the rest is empty
+      if (record.seq >= nextSeq) nextSeq = record.seq + 1;
+      if (record.state != RECORD_LIVE || record.check != checkByte(record)) continue;
+
+      uint16_t id = record.user.id;
+      if (id == 0 || id >= maxIds) continue;
+      if (slotOf[id] != NO_SLOT) {
+        uint32_t otherSeq;
+        esp_partition_read(partition, offsetOf(slotOf[id]), &otherSeq, sizeof(otherSeq));
+        if (otherSeq > record.seq || (otherSeq == record.seq && s != head)) {
+          markDead(slot);
+          continue;
+        }
+        markDead(slotOf[id]);
+      } else {
+        stored++;
+      }
+      slotOf[id] = slot;
+    }
+  }
+
+  if (head >= 0) {
+    // The first erased slot of the head sector
+    headFill = 1;
+    while (headFill < SLOTS_PER_SECTOR) {
+      uint32_t seq;
+      esp_partition_read(partition, offsetOf(head * SLOTS_PER_SECTOR + headFill), &seq, sizeof(seq));
+      if (seq == ERASED_SEQ) break;
+      headFill++;
+    }
+    // Finish a turnover that a power cut interrupted
+    reclaim((head + 1) % sectors);
+  }
+
+  rebuildIndexes();
+
+  Serial.print("[USER] User store: ");
+  Serial.print(stored);
+  Serial.print(" users, room for ");
+  Serial.println(capacity());
+  return true;
+}
+
+bool UserStore::readRecord(uint16_t slot, Record& record) {
+  if (esp_partition_read(partition, offsetOf(slot), &record, RECORD_USED) != ESP_OK) return false;
+  return record.state == RECORD_LIVE && record.check == checkByte(record);
+}
+
+void UserStore::markDead(uint16_t slot) {
+  // Flash bits can be cleared without an erase
+  uint8_t dead = RECORD_DEAD;
+  esp_partition_write(partition, offsetOf(slot) + offsetof(Record, state), &dead, 1);
+}
+
+bool UserStore::openSector() {
+  uint16_t next = head < 0 ? 0 : (head + 1) % sectors;
+  if (esp_partition_erase_range(partition, (uint32_t)next * SECTOR_SIZE, SECTOR_SIZE) != ESP_OK) {
+    return false;
+  }
+
+  SectorHeader header = {USER_MAGIC, headSeq + 1};
+  if (esp_partition_write(partition, (uint32_t)next * SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) {
+    return false;
+  }
+  head = next;
+  headSeq = header.seq;
+  headFill = 1;
+
+  // The sector after the head holds the oldest records; move the live ones
+  // now so it is free by the time the head gets there
+  reclaim((next + 1) % sectors);
+  return true;
+}
+
+void UserStore::reclaim(uint16_t sector) {
+  SectorHeader header;
+  esp_partition_read(partition, (uint32_t)sector * SECTOR_SIZE, &header, sizeof(header));
+  if (header.magic != USER_MAGIC || sector == head) return;
+
+  for (uint8_t i = 1; i < SLOTS_PER_SECTOR; i++) {
+    uint16_t slot = sector * SLOTS_PER_SECTOR + i;
+    Record record;
+    esp_partition_read(partition, offsetOf(slot), &record, RECORD_USED);
+    if (record.seq == ERASED_SEQ) break;
+    if (record.state != RECORD_LIVE) continue;
+
+    uint16_t id = record.user.id;
+    if (id == 0 || id >= maxIds || slotOf[id] != slot) continue;
+
+    // At most 31 live records, and the head was just opened, so it fits
+    if (headFill >= SLOTS_PER_SECTOR) return;
+    memset(record.spare, 0xFF, sizeof(record.spare));
+    uint16_t copy = head * SLOTS_PER_SECTOR + headFill;
+    if (esp_partition_write(partition, offsetOf(copy), &record, sizeof(record)) != ESP_OK) return;
+    headFill++;
+    slotOf[id] = copy;
+    markDead(slot);
+  }
+}
+
+uint16_t UserStore::writeRecord(const Record& record) {
+  // A reclaimed sector can fill the new head completely; the capacity
+  // limit guarantees a sector with room within one lap
+  for (uint16_t tries = 0; head < 0 || headFill >= SLOTS_PER_SECTOR; tries++) {
+    if (tries >= sectors || !openSector()) return NO_SLOT;
+  }
+
+  uint16_t slot = head * SLOTS_PER_SECTOR + headFill;
+  if (esp_partition_write(partition, offsetOf(slot), &record, sizeof(record)) != ESP_OK) return NO_SLOT;
+  headFill++;
+  return slot;
+}
+
+bool UserStore::put(const UserData& user) {
+  if (partition == nullptr || user.id == 0 || user.id >= maxIds) return false;
+
+  take();
+  if (slotOf[user.id] == NO_SLOT && stored >= capacity()) {
+    give();
+    Serial.println("[USER] ERROR: User store full");
+    return false;
+  }
+
+  Record record;
+  memset(&record, 0xFF, sizeof(record));
+  record.seq = nextSeq++;
+  record.state = RECORD_LIVE;
+  record.reserved = 0;
+  record.user = user;
+  record.check = checkByte(record);
+
+  UserData old;
+  bool replacing = load(user.id, old);
+
+  uint16_t slot = writeRecord(record);
+  if (slot == NO_SLOT) {
+    give();
+    Serial.println("[USER] ERROR: Cannot write user record");
+    return false;
+  }
+
+  // Looked up after the write: opening a sector may have moved the old copy
+  if (slotOf[user.id] != NO_SLOT) {
+    markDead(slotOf[user.id]);
+  } else {
+    stored++;
+  }
+  slotOf[user.id] = slot;
+
+  if (replacing) unindex(old);
+  index(user);
+  forget(user.id);
+  remember(user);
+  give();
+  return true;
+}
+
+bool UserStore::remove(uint16_t id) {
+  // Checked under the lock: a second remove() of the same ID must not free its slot twice
+  take();
+  if (!contains(id)) {
+    give();
+    return false;
+  }
+
+  UserData old;
+  if (load(id, old)) unindex(old);
+  markDead(slotOf[id]);
+  slotOf[id] = NO_SLOT;
+  stored--;
+  forget(id);
+  give();
+  return true;
+}
+
+bool UserStore::load(uint16_t id, UserData& user) {
+  if (!contains(id)) return false;
+
+  Record record;
+  if (!readRecord(slotOf[id], record) || record.user.id != id) return false;
+  user = record.user;
+  return true;
+}
+
+void UserStore::remember(const UserData& user) {
+  uint8_t victim = 0;
+  for (uint8_t i = 1; i < CACHE_SLOTS; i++) {
+    if (cache[i].used < cache[victim].used) victim = i;
+  }
+  cache[victim].user = user;
+  cache[victim].used = ++cacheClock;
+}
+
+void UserStore::forget(uint16_t id) {
+  for (uint8_t i = 0; i < CACHE_SLOTS; i++) {
+    if (cache[i].user.id == id) {
+      cache[i].user.id = 0;
+      cache[i].used = 0;
+    }
+  }
+}
+
+bool UserStore::get(uint16_t id, UserData& user) {
+  if (!contains(id)) return false;
+
+  take();
+  for (uint8_t i = 0; i < CACHE_SLOTS; i++) {
+    if (cache[i].user.id == id) {
+      cache[i].used = ++cacheClock;
+      user = cache[i].user;
+      hits++;
+      give();
+      return true;
+    }
+  }
+
+  misses++;
+  bool found = load(id, user);
+  if (found) remember(user);
+  give();
+  return found;
+}
+
+bool UserStore::peek(uint16_t id, UserData& user) {
+  take();
+  bool found = load(id, user);
+  give();
+  return found;
+}
+
+uint16_t UserStore::next(uint16_t id) const {
+  for (uint16_t i = id + 1; i < maxIds; i++) {
+    if (slotOf[i] != NO_SLOT) return i;
+  }
+  return 0;
+}
+
+// Keys for the secondary indexes
+
+uint8_t UserStore::phoneKey(const char* number, char* key) {
+  // The last PHONE_DIGITS digits: "+639171234567", "639171234567" and
+  // "09171234567" all give "9171234567"
+  char digits[USER_PHONE_MAX + 8];
+  uint8_t len = 0;
+  for (; *number != '\0' && len < sizeof(digits); number++) {
+    if (*number >= '0' && *number <= '9') digits[len++] = *number;
+  }
+  if (len < 7) return 0;  // Too short to be a phone number
+  uint8_t from = len > PHONE_DIGITS ? len - PHONE_DIGITS : 0;
+  memcpy(key, digits + from, len - from);
+  return len - from;
+}
+
+bool UserStore::samePhone(const char* a, const char* b) {
+  char keyA[USER_PHONE_MAX + 8];
+  char keyB[USER_PHONE_MAX + 8];
+  uint8_t len = phoneKey(a, keyA);
+  return len > 0 && phoneKey(b, keyB) == len && memcmp(keyA, keyB, len) == 0;
+}
+
+bool UserStore::validPhone(const char* number) {
+  char key[USER_PHONE_MAX + 8];
+  return phoneKey(number, key) > 0;
+}
+
+uint8_t UserStore::foldName(const char* name, char* key, uint8_t max) {
+  uint8_t len = 0;
+  for (; *name != '\0' && len < max; name++) {
+    char c = *name;
+    if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) key[len++] = c;
+  }
+  return len;
+}
+
+uint32_t UserStore::hashKey(const char* key, uint8_t len) {
+  uint32_t h = 2166136261UL;  // FNV-1a
+  for (uint8_t i = 0; i < len; i++) {
+    h ^= (uint8_t)key[i];
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+void UserStore::index(const UserData& user) {
+  if (byPhone.grow() != 0 || byName.grow() != 0) {
+    rebuildIndexes();  // Includes `user`, it is already stored
+    return;
+  }
+
+  char key[USER_NAME_MAX];
+  uint8_t len = phoneKey(user.phoneNumber, key);
+  if (len > 0) byPhone.insert(hashKey(key, len), user.id);
+  len = foldName(user.name, key, NAME_KEY);
+  if (len > 0) byName.insert(hashKey(key, len), user.id);
+}
+
+void UserStore::unindex(const UserData& user) {
+  char key[USER_NAME_MAX];
+  uint8_t len = phoneKey(user.phoneNumber, key);
+  if (len > 0) byPhone.erase(hashKey(key, len), user.id);
+  len = foldName(user.name, key, NAME_KEY);
+  if (len > 0) byName.erase(hashKey(key, len), user.id);
+}
+
+void UserStore::rebuildIndexes() {
+  // Sized for what is stored now plus headroom, so this stays rare
+  byPhone.reset(stored + stored / 4 + 1);
+  byName.reset(stored + stored / 4 + 1);
+
+  UserData user;
+  char key[USER_NAME_MAX];
+  for (uint16_t id = next(0); id != 0; id = next(id)) {
+    if (!load(id, user)) continue;
+    uint8_t len = phoneKey(user.phoneNumber, key);
+    if (len > 0) byPhone.insert(hashKey(key, len), id);
+    len = foldName(user.name, key, NAME_KEY);
+    if (len > 0) byName.insert(hashKey(key, len), id);
+  }
+}
+
+uint8_t UserStore::findByPhone(const char* number, uint16_t* ids, uint8_t max) {
+  char key[USER_PHONE_MAX + 8];
+  uint8_t len = phoneKey(number, key);
+  if (len == 0) return 0;
+  uint32_t hash = hashKey(key, len);
+
+  take();
+  uint8_t found = 0;
+  uint16_t cursor = 0;
+  UserData user;
+  char other[USER_PHONE_MAX + 8];
+  for (uint16_t id = byPhone.find(hash, cursor); id != 0 && found < max; id = byPhone.find(hash, cursor)) {
+    // The tag can match by chance, the record has the last word
+    if (!load(id, user)) continue;
+    if (phoneKey(user.phoneNumber, other) == len && memcmp(key, other, len) == 0) ids[found++] = id;
+  }
+  give();
+  return found;
+}
+
+uint8_t UserStore::findByName(const char* prefix, uint16_t* ids, uint8_t max) {
+  char key[USER_NAME_MAX];
+  uint8_t len = foldName(prefix, key, sizeof(key));
+  if (len == 0) return 0;
+
+  take();
+  uint8_t found = 0;
+  UserData user;
+  char name[USER_NAME_MAX];
+  if (len >= NAME_KEY) {
+    uint32_t hash = hashKey(key, NAME_KEY);
+    uint16_t cursor = 0;
+    for (uint16_t id = byName.find(hash, cursor); id != 0 && found < max; id = byName.find(hash, cursor)) {
+      if (!load(id, user)) continue;
+      if (foldName(user.name, name, sizeof(name)) >= len && memcmp(key, name, len) == 0) ids[found++] = id;
+    }
+  } else {
+    // Too short for the index
+    for (uint16_t id = next(0); id != 0 && found < max; id = next(id)) {
+      if (!load(id, user)) continue;
+      if (foldName(user.name, name, sizeof(name)) >= len && memcmp(key, name, len) == 0) ids[found++] = id;
+    }
+  }
+  give();
+  return found;
+}
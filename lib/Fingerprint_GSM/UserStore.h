@@ -0,0 +1,161 @@
+/**
+ * @file UserStore.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Persistent user records in a dedicated flash partition
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The "users" partition is a ring of 4 KB sectors, each holding a small
+ * header in slot 0 and 31 fixed 128-byte records. A record is the UserData
+ * struct itself plus a sequence number, so nothing is parsed at boot:
+ * begin() reads the records once and builds a RAM index of two bytes per
+ * ID (ID -> slot). Changes are appended at the head and the old copy is
+ * marked dead in place. Opening a new head sector first moves the live
+ * records of the sector after it, the oldest, which is reused next.
+ *
+ * get() copies a record out through a small cache of recently seen users,
+ * so repeat scans of the same student never touch flash.
+ *
+ * Two hash indexes answer "who has this phone" and "whose name starts with
+ * this" without a scan: one keyed on the last ten digits of the phone
+ * number, one on the first four letters/digits of the name, lowercased.
+ * put() and remove() keep them current.
+ */
+#ifndef USER_STORE_H
+#define USER_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "UserHash.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+#define USER_NAME_MAX  32
+#define USER_PHONE_MAX 16
+#define USER_GRADE_MAX 16
+
+// One user, stored as-is in flash
+struct UserData {
+  uint16_t id;
+  char name[USER_NAME_MAX];
+  char phoneNumber[USER_PHONE_MAX];
+  char grade[USER_GRADE_MAX];
+  bool notifyOnAccess;
+};
+
+class UserStore {
+  public:
+    static const uint16_t SECTOR_SIZE = 4096;
+    static const uint8_t RECORD_SIZE = 128;
+    static const uint8_t SLOTS_PER_SECTOR = SECTOR_SIZE / RECORD_SIZE;  // Slot 0 is the header
+    static const uint8_t CACHE_SLOTS = 8;
+    static const uint16_t NO_SLOT = 0xFFFF;
+    static const uint8_t PHONE_DIGITS = 10;  // Trailing digits that identify a number
+    static const uint8_t NAME_KEY = 4;       // Folded name characters in the name index
+
+    // IDs 1..maxIds-1 can be stored
+    UserStore(uint16_t maxIds = 2048);
+    ~UserStore();
+
+    // Find the partition and index the records in it
+    bool begin(const char* label = "users");
+
+    // Add a user or replace the one with the same ID
+    bool put(const UserData& user);
+    bool remove(uint16_t id);
+    // Copy a user out, through the cache. False if the ID is not stored.
+    bool get(uint16_t id, UserData& user);
+    // Same without filling the cache (listings, reports)
+    bool peek(uint16_t id, UserData& user);
+
+    bool contains(uint16_t id) const { return id > 0 && id < maxIds && slotOf[id] != NO_SLOT; }
+    // Next stored ID after `id`, 0 when there is none
+    uint16_t next(uint16_t id) const;
+    uint16_t count() const { return stored; }
+    // Users the partition can hold; two sectors are kept for turnover
+    uint16_t capacity() const;
+    uint16_t maxId() const { return maxIds - 1; }
+
+    // IDs of users with this phone number, in any common format ("+63917...",
+    // "0917..."). Returns how many were written to `ids`, at most `max`.
+    uint8_t findByPhone(const char* number, uint16_t* ids, uint8_t max);
+    // True when both are phone numbers and they match the way findByPhone() does
+    static bool samePhone(const char* a, const char* b);
+    // True when findByPhone() could ever match this number
+    static bool validPhone(const char* number);
+    // IDs of users whose name starts with `prefix`, ignoring case, spaces and
+    // punctuation. Prefixes shorter than NAME_KEY fall back to a scan.
+    uint8_t findByName(const char* prefix, uint16_t* ids, uint8_t max);
+    size_t indexMemory() const { return byPhone.memoryUsed() + byName.memoryUsed(); }
+
+    uint32_t cacheHits() const { return hits; }
+    uint32_t cacheMisses() const { return misses; }
+
+  private:
+    struct Record {
+      uint32_t seq;
+      uint8_t state;       // RECORD_LIVE, cleared to RECORD_DEAD in place
+      uint8_t check;       // Detects a record torn by a power cut
+      uint16_t reserved;
+      UserData user;
+      uint8_t spare[RECORD_SIZE - 8 - sizeof(UserData)];  // Left erased for later fields
+    };
+
+    struct SectorHeader {
+      uint32_t magic;
+      uint32_t seq;
+    };
+
+    struct CacheEntry {
+      UserData user;       // id 0 = empty
+      uint32_t used;
+    };
+
+    const esp_partition_t* partition;
+    uint16_t maxIds;
+    uint16_t* slotOf;        // ID -> slot, the RAM index
+    uint16_t stored;
+    uint16_t sectors;
+    int32_t head;            // Sector being filled, -1 before the first write
+    uint8_t headFill;        // Next free slot in the head sector
+    uint32_t headSeq;
+    uint32_t nextSeq;
+
+    CacheEntry cache[CACHE_SLOTS];
+    uint32_t cacheClock;
+    uint32_t hits;
+    uint32_t misses;
+
+    UserHash byPhone;
+    UserHash byName;
+
+#ifdef ARDUINO_ARCH_ESP32
+    SemaphoreHandle_t lock;  // The scan, GSM and LCD tasks all look users up
+#endif
+
+    void take();
+    void give();
+    uint32_t offsetOf(uint16_t slot) const { return (uint32_t)slot * RECORD_SIZE; }
+    bool readRecord(uint16_t slot, Record& record);
+    uint16_t writeRecord(const Record& record);
+    bool openSector();
+    void reclaim(uint16_t sector);
+    void markDead(uint16_t slot);
+    bool load(uint16_t id, UserData& user);
+    void remember(const UserData& user);
+    void forget(uint16_t id);
+    void index(const UserData& user);
+    void unindex(const UserData& user);
+    void rebuildIndexes();
+    static uint8_t phoneKey(const char* number, char* key);
+    static uint8_t foldName(const char* name, char* key, uint8_t max);
+    static uint32_t hashKey(const char* key, uint8_t len);
+    static uint8_t checkByte(const Record& record);
+};
+
+#endif
@@ -3,6 +3,18 @@
 #include <LiquidCrystal_I2C.h>
 #include "RTClib.h"
 #include <HardwareSerial.h>
+#include <AtEngine.h>
+#include <SmsOutbox.h>
+#include <SmsDigest.h>
+#include <PresenceIndex.h>
+#include <AttendanceReport.h>
+#include <AttendanceState.h>
+#include <UserStore.h>
+#include <SmsCommands.h>
+#include <TextBuffer.h>
+#include <LatencyStats.h>
+#include <FingerprintLink.h>
+#include <HotSearch.h>
 
 // ----------------------
 // HARDWARE SETUP
@@ -12,6 +24,9 @@ HardwareSerial sim(1);         // UART1 for SIM800L
 
 LiquidCrystal_I2C lcd(0x27, 16, 2);
 RTC_DS3231 rtc;
+AtEngine modem(&sim);
+SmsOutbox outbox(&modem);
+SmsDigest digest(&outbox);
 
 // SIM800L UART pins
 #define SIM_RX 25   // SIM800L TX
@@ -20,13 +35,19 @@ RTC_DS3231 rtc;
 // ----------------------
 // USER DATABASE
 // ----------------------
-struct User {
-  uint8_t id;
-  String name;
-  String grade;
+// Users live in the "users" flash partition (see partitions.csv) and
+// survive a reboot. IDs 1..MAX_IDS-1; the R307 holds up to 1000 fingers.
+#define MAX_IDS 1024
+UserStore users(MAX_IDS);
+
+// Written to the store on first boot only
+struct Student {
+  uint16_t id;
+  const char* name;
+  const char* grade;
 };
 
-User users[] = {
+const Student defaultStudents[] = {
   {1, "Jella Rosales", "Grade 11"},
   {2, "Mica Gunsat",   "Grade 11"},
   {3, "Pearl Abad",    "Grade 11"},
@@ -34,24 +55,62 @@ User users[] = {
   {5, "Kathleen Mira", "Grade 11"}
 };
 
-uint8_t totalUsers = sizeof(users) / sizeof(users[0]);
-
 Adafruit_Fingerprint finger = Adafruit_Fingerprint(&fpSerial);
 
+// Students expected at this gate are enrolled under consecutive IDs and
+// searched first; the rest of the library only on a miss
+#define HOT_FIRST_ID 1
+#define HOT_COUNT    40
+FingerprintLink fpLink(&fpSerial);
+HotSearch fingerSearch(&fpLink);
+
 // ----------------------
 // SMS CONTROL
 // ----------------------
-String phoneNumber = "+639176215111";
-bool smsSent = false;
-unsigned long lastScanTime = 0;
+const char* phoneNumber = "+639176215111";
+
+// In/out state per student: repeat scans of the same student within the
+// cooldown are ignored, other students are never held up by them
+#define SCAN_COOLDOWN_MS 10000UL
+AttendanceState attendance(MAX_IDS);
+bool fingerHeld = false;   // A matched finger is still on the sensor
+uint8_t currentDay = 0;
+
+// Digest mode: collect scans and send one SMS per window instead of per student
+bool digestMode = true;
+#define DIGEST_WINDOW_MS  (5UL * 60UL * 1000UL)
+#define DIGEST_MAX_EVENTS 12  // About what one digest (three SMS parts) holds
+
+// Daily summary: absentees and late arrivals per grade, one SMS at cut-off
+#define REPORT_CUTOFF_HOUR  9
+#define REPORT_CUTOFF_MIN   0
+#define LATE_HOUR           7
+#define LATE_MIN            30
+
+bool lookupUser(uint16_t id, const char** name, const char** grade, void* ctx);
+PresenceIndex presence(MAX_IDS);
+AttendanceReport report(&presence, &outbox, lookupUser, nullptr);
+
+// SMS commands (STATUS, ABSENT, ADDUSER, DELUSER) from the admin phone and
+// registered guardians, answered one per loop()
+SmsCommands commands(&modem, &outbox, &users);
+
+// Time spent in each stage of a scan; type "stats" in the serial monitor
+LatencyStats latency;
+#define CONSOLE_LINE_MAX 16
+char consoleLine[CONSOLE_LINE_MAX];
+uint8_t consoleLength = 0;
 
 // ----------------------
 // FUNCTION DECLARATIONS
 // ----------------------
 int getFingerprintID();
-void displayUser(uint8_t id);
-void sendSMS(String message);
-String readSIM(unsigned long timeout);
+void displayUser(uint16_t id, ScanDecision decision);
+void seedUsers();
+void sendSMS(const char* message);
+DateTime readRtc();
+void onSmsResult(SmsHandle handle, SmsStatus status, void* ctx);
+void serviceConsole();
 
 // ----------------------
 // SETUP
@@ -86,16 +145,45 @@ void setup() {
     lcd.print("Sensor Error!");
     while (1);
   }
+  finger.getParameters();
+  fingerSearch.begin(finger.capacity);
+  fingerSearch.setHotRange(HOT_FIRST_ID, HOT_COUNT);
 
   // SIM800L
   sim.begin(9600, SERIAL_8N1, SIM_RX, SIM_TX);
   delay(1000);
-  sim.println("AT");
-  delay(500);
-  sim.println("AT+CMGF=1");
-  delay(500);
-  sim.println("AT+CNMI=1,2,0,0,0");
-  delay(500);
+  modem.setSmsCallback(onSmsResult, nullptr);
+  modem.runCommand("AT");
+  modem.runCommand("ATE0");
+  modem.runCommand("AT+CMGF=0");  // PDU mode: digests go out as concatenated SMS
+  commands.setPduMode(true);
+  commands.setAdminPhone(phoneNumber);
+  commands.begin();
+  modem.runCommand("AT+CNMI=1,2,0,0,0");
+  outbox.setPduMode(true);
+  outbox.begin();
+  digest.setWindow(DIGEST_WINDOW_MS, DIGEST_MAX_EVENTS);
+
+  // Users
+  if (!users.begin()) {
+    lcd.clear();
+    lcd.print("User DB Error!");
+    while (1);
+  }
+  if (users.count() == 0) seedUsers();
+
+  // Attendance summary
+  presence.begin();
+  for (uint16_t id = users.next(0); id != 0; id = users.next(id)) {
+    presence.setEnrolled(id, true);
+  }
+  commands.setPresence(&presence);
+  report.begin();
+  report.setCutoff(REPORT_CUTOFF_HOUR, REPORT_CUTOFF_MIN);
+  report.setLateTime(LATE_HOUR, LATE_MIN);
+  report.addRecipient(phoneNumber);
+  attendance.setCooldown(SCAN_COOLDOWN_MS);
+  currentDay = rtc.now().day();
 
   lcd.clear();
   lcd.print("System Ready");
@@ -107,10 +195,28 @@ void setup() {
 // MAIN LOOP
 // ----------------------
 void loop() {
-  int id = getFingerprintID();
+  modem.poll();
+  digest.poll();
+  outbox.poll();
+  presence.poll();
+  serviceConsole();
+
+  DateTime now = readRtc();
+  report.poll(now.unixtime());
+  commands.poll(now.unixtime());
+  if (now.day() != currentDay) {
+    attendance.reset();  // Everyone starts the day checked out
+    currentDay = now.day();
+  }
 
-  if (id == -1) {
-    smsSent = false;  // finger removed
+  if (fingerHeld) {
+    // Only watch for the finger to lift; no image processing or search
+    uint32_t started = latency.start();
+    int r = finger.getImage();
+    latency.stop(LatencyStats::STAGE_GET_IMAGE, started);
+    if (r == FINGERPRINT_NOFINGER) fingerHeld = false;
+  } else {
+    getFingerprintID();
   }
 
   delay(300);
@@ -120,91 +226,152 @@ void loop() {
 // FINGERPRINT FUNCTIONS
 // ----------------------
 int getFingerprintID() {
+  uint32_t started = latency.start();
   int r = finger.getImage();
+  latency.stop(LatencyStats::STAGE_GET_IMAGE, started);
   if (r != FINGERPRINT_OK) return -1;
 
+  started = latency.start();
   r = finger.image2Tz();
+  latency.stop(LatencyStats::STAGE_IMAGE_TO_TZ, started);
   if (r != FINGERPRINT_OK) return -1;
 
-  r = finger.fingerFastSearch();
+  uint16_t id, score;
+  started = latency.start();
+  r = fingerSearch.search(&id, &score);
+  latency.stop(LatencyStats::STAGE_SEARCH, started);
   if (r != FINGERPRINT_OK) {
     lcd.clear();
     lcd.print("No Match");
     return -1;
   }
 
-  displayUser(finger.fingerID);
-  return finger.fingerID;
+  fingerHeld = true;
+  ScanDecision decision = attendance.decide(id, millis());
+  displayUser(id, decision);
+  return id;
 }
 
 // ----------------------
 // LCD + SMS FUNCTION
 // ----------------------
-void displayUser(uint8_t id) {
-  DateTime now = rtc.now();
+void displayUser(uint16_t id, ScanDecision decision) {
+  DateTime now = readRtc();
 
-  char timeStr[10];
-  char dateStr[12];
-  sprintf(timeStr, "%02d:%02d:%02d", now.hour(), now.minute(), now.second());
-  sprintf(dateStr, "%02d/%02d/%04d", now.month(), now.day(), now.year());
-
-  for (int i = 0; i < totalUsers; i++) {
-    if (users[i].id == id) {
-
-      lcd.clear();
-      lcd.print(users[i].name);
-      lcd.setCursor(0, 1);
-      lcd.print(users[i].grade);
-      lcd.setCursor(10, 1);
-      lcd.print(timeStr);
-
-      if (!smsSent || millis() - lastScanTime > 10000) {
-        String sms =
-          "Attendance Alert\n"
-          "Name: " + users[i].name + "\n" +
-          "Grade: " + users[i].grade + "\n" +
-          "Date: " + String(dateStr) + "\n" +
-          "Time: " + String(timeStr);
-
-        sendSMS(sms);
-        smsSent = true;
-        lastScanTime = millis();
-      }
-      return;
-    }
+  TextBuffer<10> timeStr;
+  TextBuffer<12> dateStr;
+  timeStr.format("%02d:%02d:%02d", now.hour(), now.minute(), now.second());
+  dateStr.format("%02d/%02d/%04d", now.month(), now.day(), now.year());
+
+  // Indexed lookup; a student scanning again is served from the RAM cache
+  UserData user;
+  if (!users.get(id, user)) {
+    lcd.clear();
+    lcd.print("Unknown ID:");
+    lcd.print(id);
+    return;
   }
 
+  uint32_t started = latency.start();
   lcd.clear();
-  lcd.print("Unknown ID:");
-  lcd.print(id);
+  lcd.print(user.name);
+  lcd.setCursor(0, 1);
+  lcd.print(user.grade);
+  lcd.setCursor(10, 1);
+  lcd.print(timeStr.c_str());
+  latency.stop(LatencyStats::STAGE_LCD_UPDATE, started);
+
+  if (decision == SCAN_DUPLICATE) return;
+
+  presence.mark(id, now.unixtime());
+  const char* status = decision == SCAN_CHECK_IN ? "IN" : "OUT";
+
+  started = latency.start();
+  if (digestMode) {
+    TextBuffer<16> stamp;
+    stamp.format("%s %s", timeStr.c_str(), status);
+    if (!digest.add(phoneNumber, user.name, user.grade, stamp)) {
+      Serial.println("SMS digest full, scan not reported");
+    }
+  } else {
+    // Formatted on the stack, no heap traffic per scan
+    TextBuffer<OUTBOX_TEXT_MAX + 1> sms;
+    sms.format("Attendance Alert\nName: %s\nGrade: %s\nStatus: %s\nDate: %s\nTime: %s",
+               user.name, user.grade, status, dateStr.c_str(), timeStr.c_str());
+    sendSMS(sms);
+  }
+  latency.stop(LatencyStats::STAGE_SMS_ENQUEUE, started);
+}
+
+// Name and grade for the daily report. The report copies them before the
+// next lookup, so one buffer is enough.
+bool lookupUser(uint16_t id, const char** name, const char** grade, void* ctx) {
+  (void)ctx;
+  static UserData user;
+  if (!users.peek(id, user)) return false;
+  *name = user.name;
+  *grade = user.grade;
+  return true;
+}
+
+// First boot: store the built-in class list
+void seedUsers() {
+  for (uint8_t i = 0; i < sizeof(defaultStudents) / sizeof(defaultStudents[0]); i++) {
+    UserData user;
+    memset(&user, 0, sizeof(user));
+    user.id = defaultStudents[i].id;
+    strncpy(user.name, defaultStudents[i].name, sizeof(user.name) - 1);
+    strncpy(user.grade, defaultStudents[i].grade, sizeof(user.grade) - 1);
+    users.put(user);
+  }
 }
 
 // ----------------------
 // SMS FUNCTIONS
 // ----------------------
-void sendSMS(String message) {
-  sim.println("AT+CMGF=1");
-  delay(300);
-
-  sim.print("AT+CMGS=\"");
-  sim.print(phoneNumber);
-  sim.println("\"");
-  delay(300);
+// Stores the message in the flash outbox and returns at once; outbox.poll()
+// in loop() sends it and retries with backoff until the modem confirms.
+void sendSMS(const char* message) {
+  if (!outbox.append(phoneNumber, message)) {
+    Serial.println("SMS outbox full");
+  }
+}
 
-  sim.print(message);
-  delay(300);
-  sim.write(26); // CTRL+Z
+// ----------------------
+// INSTRUMENTATION
+// ----------------------
+DateTime readRtc() {
+  uint32_t started = latency.start();
+  DateTime now = rtc.now();
+  latency.stop(LatencyStats::STAGE_RTC_READ, started);
+  return now;
+}
 
-  readSIM(8000);
+// The modem reports every SMS it finishes, with how long it took
+void onSmsResult(SmsHandle handle, SmsStatus status, void* ctx) {
+  (void)handle;
+  (void)status;
+  (void)ctx;
+  if (latency.enabled()) latency.record(LatencyStats::STAGE_SMS_SEND, modem.lastSmsLatency());
 }
 
-String readSIM(unsigned long timeout) {
-  unsigned long start = millis();
-  String response = "";
-  while (millis() - start < timeout) {
-    while (sim.available()) {
-      response += char(sim.read());
+// "stats" prints the latency table, "stats reset" clears it
+void serviceConsole() {
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c != '\r' && c != '\n') {
+      if (consoleLength < CONSOLE_LINE_MAX - 1) consoleLine[consoleLength++] = c;
+      continue;
+    }
+    if (consoleLength == 0) continue;
+    consoleLine[consoleLength] = '\0';
+    consoleLength = 0;
+    if (strcmp(consoleLine, "stats") == 0) {
+      latency.print();
+    } else if (strcmp(consoleLine, "stats reset") == 0) {
+      latency.reset();
+      Serial.println("Stats cleared");
     }
+    return;
   }
-  return response;
 }
@@ -0,0 +1,182 @@
+/**
+ * @file Adafruit_Fingerprint.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the Adafruit Fingerprint Sensor Library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Speaks the real packet protocol on the UART, so a sensor emulator can sit
+ * on the other end.
+ */
+#include "Adafruit_Fingerprint.h"
+
+Adafruit_Fingerprint::Adafruit_Fingerprint(HardwareSerial* hs, uint32_t password)
+    : fingerID(0), confidence(0), templateCount(0), mySerial(hs), thePassword(password) {}
+
+void Adafruit_Fingerprint::begin(uint32_t baud) {
+  delay(1);
+  mySerial->begin(baud);
+}
+
+void Adafruit_Fingerprint::writeStructuredPacket(const Adafruit_Fingerprint_Packet& packet) {
+  mySerial->write((uint8_t)(packet.start_code >> 8));
+  mySerial->write((uint8_t)(packet.start_code & 0xFF));
+  for (int i = 0; i < 4; i++) mySerial->write(packet.address[i]);
+  mySerial->write(packet.type);
+  uint16_t wire_length = packet.length + 2;
+  mySerial->write((uint8_t)(wire_length >> 8));
+  mySerial->write((uint8_t)(wire_length & 0xFF));
+  uint16_t sum = (wire_length >> 8) + (wire_length & 0xFF) + packet.type;
+  for (uint8_t i = 0; i < packet.length; i++) {
+    mySerial->write(packet.data[i]);
+    sum += packet.data[i];
+  }
+  mySerial->write((uint8_t)(sum >> 8));
+  mySerial->write((uint8_t)(sum & 0xFF));
+}
+
+uint8_t Adafruit_Fingerprint::getStructuredPacket(Adafruit_Fingerprint_Packet* packet, uint16_t timeout) {
+  uint8_t byte;
+  uint16_t idx = 0, timer = 0;
+  for (;;) {
+    while (!mySerial->available()) {
+      delay(1);
+      timer++;
+      if (timer >= timeout) return FINGERPRINT_TIMEOUT;
+    }
+    byte = mySerial->read();
+    switch (idx) {
+      case 0:
+        if (byte != (FINGERPRINT_STARTCODE >> 8)) continue;
+        packet->start_code = (uint16_t)byte << 8;
+        break;
+      case 1:
+        packet->start_code |= byte;
+        if (packet->start_code != FINGERPRINT_STARTCODE) return FINGERPRINT_BADPACKET;
+        break;
+      case 2: case 3: case 4: case 5:
+        packet->address[idx - 2] = byte;
+        break;
+      case 6:
+        packet->type = byte;
+        break;
+      case 7:
+        packet->length = (uint16_t)byte << 8;
+        break;
+      case 8:
+        packet->length |= byte;
+        break;
+      default:
+        if (idx - 9 < 64) packet->data[idx - 9] = byte;
+        if ((idx - 8) == packet->length) return FINGERPRINT_OK;
+        break;
+    }
+    idx++;
+    if ((idx + 9) >= 64 + 9 + 2) return FINGERPRINT_BADPACKET;
+  }
+}
+
+uint8_t Adafruit_Fingerprint::sendCommand(const uint8_t* data, uint16_t len, uint8_t* reply,
+                                          uint16_t replyCap, uint16_t* replyLen) {
+  Adafruit_Fingerprint_Packet packet(FINGERPRINT_COMMANDPACKET, len, (uint8_t*)data);
+  writeStructuredPacket(packet);
+  if (getStructuredPacket(&packet) != FINGERPRINT_OK) return FINGERPRINT_PACKETRECIEVEERR;
+  if (packet.type != FINGERPRINT_ACKPACKET) return FINGERPRINT_PACKETRECIEVEERR;
+  uint16_t n = packet.length >= 2 ? packet.length - 2 : 0;
+  if (n > replyCap) n = replyCap;
+  memcpy(reply, packet.data, n);
+  if (replyLen) *replyLen = n;
+  return packet.data[0];
+}
+
+#define FP_CMD(...)                                                        \
+  uint8_t cmd[] = {__VA_ARGS__};                                           \
+  uint8_t reply[64];                                                       \
+  uint16_t replyLen = 0;                                                   \
+  uint8_t rc = sendCommand(cmd, sizeof(cmd), reply, sizeof(reply), &replyLen); \
+  (void)replyLen
+
+bool Adafruit_Fingerprint::verifyPassword() {
+  FP_CMD(FINGERPRINT_VERIFYPASSWORD, (uint8_t)(thePassword >> 24), (uint8_t)(thePassword >> 16),
+         (uint8_t)(thePassword >> 8), (uint8_t)(thePassword & 0xFF));
+  return rc == FINGERPRINT_OK;
+}
+
+uint8_t Adafruit_Fingerprint::getParameters() {
+  FP_CMD(FINGERPRINT_READSYSPARAM);
+  if (rc != FINGERPRINT_OK || replyLen < 17) return rc;
+  status_reg = ((uint16_t)reply[1] << 8) | reply[2];
+  system_id = ((uint16_t)reply[3] << 8) | reply[4];
+  capacity = ((uint16_t)reply[5] << 8) | reply[6];
+  security_level = ((uint16_t)reply[7] << 8) | reply[8];
+  device_addr = ((uint32_t)reply[9] << 24) | ((uint32_t)reply[10] << 16) | ((uint32_t)reply[11] << 8) | reply[12];
+  packet_len = ((uint16_t)reply[13] << 8) | reply[14];
+  packet_len = packet_len == 0 ? 32 : packet_len == 1 ? 64 : packet_len == 2 ? 128 : 256;
+  baud_rate = (((uint16_t)reply[15] << 8) | reply[16]) * 9600;
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::getImage() { FP_CMD(FINGERPRINT_GETIMAGE); return rc; }
+uint8_t Adafruit_Fingerprint::image2Tz(uint8_t slot) { FP_CMD(FINGERPRINT_IMAGE2TZ, slot); return rc; }
+uint8_t Adafruit_Fingerprint::createModel() { FP_CMD(FINGERPRINT_REGMODEL); return rc; }
+uint8_t Adafruit_Fingerprint::emptyDatabase() { FP_CMD(FINGERPRINT_EMPTY); return rc; }
+
+uint8_t Adafruit_Fingerprint::storeModel(uint16_t location) {
+  FP_CMD(FINGERPRINT_STORE, 0x01, (uint8_t)(location >> 8), (uint8_t)(location & 0xFF));
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::loadModel(uint16_t location) {
+  FP_CMD(FINGERPRINT_LOAD, 0x01, (uint8_t)(location >> 8), (uint8_t)(location & 0xFF));
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::getModel() { FP_CMD(FINGERPRINT_UPLOAD, 0x01); return rc; }
+
+uint8_t Adafruit_Fingerprint::deleteModel(uint16_t location) {
+  FP_CMD(FINGERPRINT_DELETE, (uint8_t)(location >> 8), (uint8_t)(location & 0xFF), 0x00, 0x01);
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::fingerSearch(uint8_t slot) {
+  FP_CMD(FINGERPRINT_SEARCH, slot, 0x00, 0x00, (uint8_t)(capacity >> 8), (uint8_t)(capacity & 0xFF));
+  fingerID = ((uint16_t)reply[1] << 8) | reply[2];
+  confidence = ((uint16_t)reply[3] << 8) | reply[4];
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::fingerFastSearch() {
+  FP_CMD(FINGERPRINT_HISPEEDSEARCH, 0x01, 0x00, 0x00, 0x00, 0xA3);
+  fingerID = ((uint16_t)reply[1] << 8) | reply[2];
+  confidence = ((uint16_t)reply[3] << 8) | reply[4];
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::getTemplateCount() {
+  FP_CMD(FINGERPRINT_TEMPLATECOUNT);
+  templateCount = ((uint16_t)reply[1] << 8) | reply[2];
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::setPassword(uint32_t password) {
+  FP_CMD(FINGERPRINT_SETPASSWORD, (uint8_t)(password >> 24), (uint8_t)(password >> 16),
+         (uint8_t)(password >> 8), (uint8_t)(password & 0xFF));
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::setBaudRate(uint8_t baudrate) {
+  FP_CMD(0x0E, FINGERPRINT_BAUD_REG_ADDR, baudrate);
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::setSecurityLevel(uint8_t level) {
+  FP_CMD(0x0E, FINGERPRINT_SECURITY_REG_ADDR, level);
+  return rc;
+}
+
+uint8_t Adafruit_Fingerprint::setPacketSize(uint8_t size) {
+  FP_CMD(0x0E, FINGERPRINT_PACKET_REG_ADDR, size);
+  return rc;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file Adafruit_Fingerprint.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the Adafruit Fingerprint Sensor Library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef ADAFRUIT_FINGERPRINT_MOCK_H
+#define ADAFRUIT_FINGERPRINT_MOCK_H
+
+#include "Arduino.h"
+
+#define FINGERPRINT_OK 0x00
+#define FINGERPRINT_PACKETRECIEVEERR 0x01
+#define FINGERPRINT_NOFINGER 0x02
+#define FINGERPRINT_IMAGEFAIL 0x03
+#define FINGERPRINT_IMAGEMESS 0x06
+#define FINGERPRINT_FEATUREFAIL 0x07
+#define FINGERPRINT_NOMATCH 0x08
+#define FINGERPRINT_NOTFOUND 0x09
+#define FINGERPRINT_ENROLLMISMATCH 0x0A
+#define FINGERPRINT_BADLOCATION 0x0B
+#define FINGERPRINT_DBREADFAIL 0x0C
+#define FINGERPRINT_UPLOADFEATUREFAIL 0x0D
+#define FINGERPRINT_PACKETRESPONSEFAIL 0x0E
+#define FINGERPRINT_UPLOADFAIL 0x0F
+#define FINGERPRINT_DELETEFAIL 0x10
+#define FINGERPRINT_DBCLEARFAIL 0x11
+#define FINGERPRINT_PASSFAIL 0x13
+#define FINGERPRINT_INVALIDIMAGE 0x15
+#define FINGERPRINT_FLASHERR 0x18
+#define FINGERPRINT_INVALIDREG 0x1A
+#define FINGERPRINT_ADDRCODE 0x20
+#define FINGERPRINT_PASSVERIFY 0x21
+
+#define FINGERPRINT_STARTCODE 0xEF01
+#define FINGERPRINT_COMMANDPACKET 0x1
+#define FINGERPRINT_DATAPACKET 0x2
+#define FINGERPRINT_ACKPACKET 0x7
+#define FINGERPRINT_ENDDATAPACKET 0x8
+
+#define FINGERPRINT_TIMEOUT 0xFF
+#define FINGERPRINT_BADPACKET 0xFE
+
+#define FINGERPRINT_GETIMAGE 0x01
+#define FINGERPRINT_IMAGE2TZ 0x02
+#define FINGERPRINT_SEARCH 0x04
+#define FINGERPRINT_REGMODEL 0x05
+#define FINGERPRINT_STORE 0x06
+#define FINGERPRINT_LOAD 0x07
+#define FINGERPRINT_UPLOAD 0x08
+#define FINGERPRINT_DELETE 0x0C
+#define FINGERPRINT_EMPTY 0x0D
+#define FINGERPRINT_READSYSPARAM 0x0F
+#define FINGERPRINT_SETPASSWORD 0x12
+#define FINGERPRINT_VERIFYPASSWORD 0x13
+#define FINGERPRINT_HISPEEDSEARCH 0x1B
+#define FINGERPRINT_TEMPLATECOUNT 0x1D
+
+#define FINGERPRINT_BAUD_REG_ADDR 0x4
+#define FINGERPRINT_BAUDRATE_9600 0x1
+#define FINGERPRINT_BAUDRATE_19200 0x2
+#define FINGERPRINT_BAUDRATE_28800 0x3
+#define FINGERPRINT_BAUDRATE_38400 0x4
+#define FINGERPRINT_BAUDRATE_48000 0x5
+#define FINGERPRINT_BAUDRATE_57600 0x6
+#define FINGERPRINT_BAUDRATE_67200 0x7
+#define FINGERPRINT_BAUDRATE_76800 0x8
+#define FINGERPRINT_BAUDRATE_86400 0x9
+#define FINGERPRINT_BAUDRATE_96000 0xA
+#define FINGERPRINT_BAUDRATE_105600 0xB
+#define FINGERPRINT_BAUDRATE_115200 0xC
+#define FINGERPRINT_SECURITY_REG_ADDR 0x5
+#define FINGERPRINT_PACKET_REG_ADDR 0x6
+#define FINGERPRINT_PACKET_SIZE_32 0x0
+#define FINGERPRINT_PACKET_SIZE_64 0x1
+#define FINGERPRINT_PACKET_SIZE_128 0x2
+#define FINGERPRINT_PACKET_SIZE_256 0x3
+
+#define DEFAULTTIMEOUT 1000
+
+struct Adafruit_Fingerprint_Packet {
+  Adafruit_Fingerprint_Packet(uint8_t type, uint16_t length, uint8_t* data) {
+    this->start_code = FINGERPRINT_STARTCODE;
+    this->type = type;
+    this->length = length;
+    address[0] = address[1] = address[2] = address[3] = 0xFF;
+    if (length < 64) memcpy(this->data, data, length);
+    else memcpy(this->data, data, 64);
+  }
+  uint16_t start_code;
+  uint8_t address[4];
+  uint8_t type;
+  uint16_t length;
+  uint8_t data[64];
+};
+
+class Adafruit_Fingerprint {
+  public:
+    Adafruit_Fingerprint(HardwareSerial* hs, uint32_t password = 0x0);
+    void begin(uint32_t baud);
+    bool verifyPassword();
+    uint8_t getParameters();
+    uint8_t getImage();
+    uint8_t image2Tz(uint8_t slot = 1);
+    uint8_t createModel();
+    uint8_t emptyDatabase();
+    uint8_t storeModel(uint16_t id);
+    uint8_t loadModel(uint16_t id);
+    uint8_t getModel();
+    uint8_t deleteModel(uint16_t id);
+    uint8_t fingerSearch(uint8_t slot = 1);
+    uint8_t fingerFastSearch();
+    uint8_t getTemplateCount();
+    uint8_t setPassword(uint32_t password);
+    uint8_t setBaudRate(uint8_t baudrate);
+    uint8_t setSecurityLevel(uint8_t level);
+    uint8_t setPacketSize(uint8_t size);
+    void writeStructuredPacket(const Adafruit_Fingerprint_Packet& p);
+    uint8_t getStructuredPacket(Adafruit_Fingerprint_Packet* p, uint16_t timeout = DEFAULTTIMEOUT);
+
+    uint16_t fingerID;
+    uint16_t confidence;
+    uint16_t templateCount;
+    uint16_t status_reg = 0x0;
+    uint16_t system_id = 0x0;
+    uint16_t capacity = 64;
+    uint16_t security_level = 0;
+    uint32_t device_addr = 0xFFFFFFFF;
+    uint16_t packet_len = 64;
+    uint16_t baud_rate = 57600;
+
+  private:
+    HardwareSerial* mySerial;
+    uint32_t thePassword;
+    uint8_t sendCommand(const uint8_t* data, uint16_t len, uint8_t* reply, uint16_t replyCap, uint16_t* replyLen);
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file Arduino.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the Arduino core (String, Print, Stream, HardwareSerial, ESP)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "Arduino.h"
+#include "MockHost.h"
+
+#include <stdarg.h>
+#include <vector>
+
+HardwareSerial Serial(0);
+
+namespace {
+uint64_t g_nowUs = 0;
+uint32_t g_autoAdvanceUs = 1;
+struct Ticker { mock::TickFn fn; void* ctx; };
+std::vector<Ticker> g_tickers;
+int g_pins[64];
+void (*g_isr[64])() = {nullptr};
+void (*g_isrArg[64])(void*) = {nullptr};
+void* g_isrArgCtx[64] = {nullptr};
+bool g_inTick = false;
+uint32_t g_i2cByteUs = 0;
+
+void runTickers() {
+  if (g_inTick) return;
+  g_inTick = true;
+  for (size_t i = 0; i < g_tickers.size(); i++) g_tickers[i].fn(g_nowUs, g_tickers[i].ctx);
+  g_inTick = false;
+}
+}  // namespace
+
+namespace mock {
+uint64_t nowUs() { return g_nowUs; }
+void setNowUs(uint64_t us) { g_nowUs = us; }
+void advanceUs(uint64_t us) { g_nowUs += us; runTickers(); }
+void setAutoAdvanceUs(uint32_t us) { g_autoAdvanceUs = us; }
+void addTicker(TickFn fn, void* ctx) { g_tickers.push_back({fn, ctx}); }
+void removeTicker(TickFn fn, void* ctx) {
+  for (size_t i = 0; i < g_tickers.size(); i++) {
+    if (g_tickers[i].fn == fn && g_tickers[i].ctx == ctx) {
+      g_tickers.erase(g_tickers.begin() + i);
+      return;
+    }
+  }
+}
+void clearTickers() { g_tickers.clear(); }
+void setI2cByteUs(uint32_t us) { g_i2cByteUs = us; }
+void i2cTransfer(uint32_t bytes) { if (g_i2cByteUs > 0) advanceUs((uint64_t)bytes * g_i2cByteUs); }
+void setPin(uint8_t pin, int level) { if (pin < 64) g_pins[pin] = level; }
+void fireInterrupt(uint8_t pin) {
+  if (pin < 64 && g_isr[pin]) g_isr[pin]();
+  if (pin < 64 && g_isrArg[pin]) g_isrArg[pin](g_isrArgCtx[pin]);
+}
+void reset() {
+  g_nowUs = 0;
+  g_autoAdvanceUs = 1;
+  g_i2cByteUs = 0;
+  g_tickers.clear();
+  for (int i = 0; i < 64; i++) { g_pins[i] = 0; g_isr[i] = nullptr; g_isrArg[i] = nullptr; }
+}
+}  // namespace mock
+
+unsigned long micros() { mock::advanceUs(g_autoAdvanceUs); return (unsigned long)g_nowUs; }
+unsigned long millis() { mock::advanceUs(g_autoAdvanceUs); return (unsigned long)(g_nowUs / 1000); }
+void delay(unsigned long ms) { mock::advanceUs((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { mock::advanceUs(us); }
+void yield() { mock::advanceUs(g_autoAdvanceUs); }
+
+void pinMode(uint8_t, uint8_t) {}
+int digitalRead(uint8_t pin) { return pin < 64 ? g_pins[pin] : 0; }
+void digitalWrite(uint8_t pin, uint8_t val) { if (pin < 64) g_pins[pin] = val; }
+int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int irq, void (*isr)(), int) { if (irq >= 0 && irq < 64) g_isr[irq] = isr; }
+void detachInterrupt(int irq) { if (irq >= 0 && irq < 64) { g_isr[irq] = nullptr; g_isrArg[irq] = nullptr; } }
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int) { if (pin < 64) { g_isrArg[pin] = isr; g_isrArgCtx[pin] = arg; } }
+
+int Print::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  write(buf);
+  return n;
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+  } while (millis() - start < timeout_);
+  return -1;
+}
+
+size_t Stream::readBytes(uint8_t* buf, size_t n) {
+  size_t count = 0;
+  while (count < n) {
+    int c = timedRead();
+    if (c < 0) break;
+    buf[count++] = (uint8_t)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  std::string s;
+  int c;
+  while ((c = timedRead()) >= 0) s += (char)c;
+  return String(s);
+}
+
+String Stream::readStringUntil(char term) {
+  std::string s;
+  int c;
+  while ((c = timedRead()) >= 0 && c != term) s += (char)c;
+  return String(s);
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t, int8_t, int8_t) { baud_ = baud; }
+
+int HardwareSerial::available() { service(); return (int)rx.size(); }
+
+int HardwareSerial::read() {
+  service();
+  if (rx.empty()) return -1;
+  uint8_t c = rx.front();
+  rx.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() { service(); return rx.empty() ? -1 : rx.front(); }
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (echoToStdout) fputc(c, stdout);
+  else if (captureTx) tx.push_back(c);
+  return 1;
+}
+
+EspClass ESP;
+uint32_t EspClass::getCycleCount() { return (uint32_t)(mock::nowUs() * 240); }
@@ -0,0 +1,215 @@
+/**
+ * @file Arduino.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the Arduino core (String, Print, Stream, HardwareSerial, ESP)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef ARDUINO_MOCK_H
+#define ARDUINO_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <deque>
+
+#define IRAM_ATTR
+#define SERIAL_8N1 0x800001c
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+#define OUTPUT 0x03
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define DEC 10
+#define HEX 16
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(int irq, void (*isr)(), int mode);
+void detachInterrupt(int irq);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+
+class String {
+  public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    String(const __FlashStringHelper* s) : s_(reinterpret_cast<const char*>(s)) {}
+    explicit String(char c) : s_(1, c) {}
+    explicit String(int v, unsigned char base = DEC) { fromLong(v, base); }
+    explicit String(unsigned int v, unsigned char base = DEC) { fromULong(v, base); }
+    explicit String(long v, unsigned char base = DEC) { fromLong(v, base); }
+    explicit String(unsigned long v, unsigned char base = DEC) { fromULong(v, base); }
+    explicit String(unsigned char v, unsigned char base = DEC) { fromULong(v, base); }
+    explicit String(float v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+    explicit String(double v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+
+    unsigned int length() const { return s_.size(); }
+    const char* c_str() const { return s_.c_str(); }
+    bool reserve(unsigned int n) { s_.reserve(n); return true; }
+    char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    int indexOf(const String& s, unsigned int from = 0) const {
+      size_t p = s_.find(s.s_, from);
+      return p == std::string::npos ? -1 : (int)p;
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+      size_t p = s_.find(c, from);
+      return p == std::string::npos ? -1 : (int)p;
+    }
+    String substring(unsigned int from) const { return from >= s_.size() ? String() : String(s_.substr(from)); }
+    String substring(unsigned int from, unsigned int to) const {
+      if (from >= s_.size() || to <= from) return String();
+      return String(s_.substr(from, to - from));
+    }
+    void trim() {
+      size_t b = s_.find_first_not_of(" \t\r\n");
+      size_t e = s_.find_last_not_of(" \t\r\n");
+      s_ = (b == std::string::npos) ? std::string() : s_.substr(b, e - b + 1);
+    }
+    bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+    bool equals(const String& o) const { return s_ == o.s_; }
+    int toInt() const { return atoi(s_.c_str()); }
+
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    String& operator+=(const char* o) { s_ += o; return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+    bool operator==(const String& o) const { return s_ == o.s_; }
+    bool operator==(const char* o) const { return s_ == o; }
+    bool operator!=(const String& o) const { return s_ != o.s_; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a) + b.s_); }
+    friend String operator+(const String& a, char b) { return String(a.s_ + b); }
+
+  private:
+    std::string s_;
+    void fromLong(long v, unsigned char base) {
+      if (v < 0 && base == DEC) { fromULong((unsigned long)(-v), base); s_.insert(s_.begin(), '-'); }
+      else fromULong((unsigned long)v, base);
+    }
+    void fromULong(unsigned long v, unsigned char base) {
+      char buf[34];
+      snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%lu", v);
+      s_ = buf;
+    }
+    void fromDouble(double v, unsigned int decimals) {
+      char buf[48];
+      snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+      s_ = buf;
+    }
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t n) {
+      size_t w = 0;
+      while (n--) w += write(*buf++);
+      return w;
+    }
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, (unsigned char)base)); }
+    size_t print(double v, int digits = 2) { return print(String(v, (unsigned int)digits)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    void setTimeout(unsigned long ms) { timeout_ = ms; }
+    size_t readBytes(uint8_t* buf, size_t n);
+    size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
+    String readString();
+    String readStringUntil(char term);
+  protected:
+    unsigned long timeout_ = 1000;
+    int timedRead();
+};
+
+class HardwareSerial : public Stream {
+  public:
+    explicit HardwareSerial(int uartNum = 0) : uart_(uartNum) {}
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end() {}
+    void updateBaudRate(unsigned long baud) { baud_ = baud; }
+    unsigned long baudRate() const { return baud_; }
+    operator bool() const { return true; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    // Host side: bytes the device under test has transmitted and bytes it will receive.
+    std::deque<uint8_t> tx;
+    std::deque<uint8_t> rx;
+    void inject(const char* s) { while (*s) rx.push_back((uint8_t)*s++); }
+    void inject(const uint8_t* b, size_t n) { while (n--) rx.push_back(*b++); }
+    std::string drainTx() { std::string s(tx.begin(), tx.end()); tx.clear(); return s; }
+    // Optional hook so an emulator can react to traffic as soon as it happens.
+    void (*onActivity)(HardwareSerial* port, void* ctx) = nullptr;
+    void* activityCtx = nullptr;
+    bool echoToStdout = false;
+    // Off: what the device prints is dropped, so benchmarks do not time the deque
+    bool captureTx = true;
+
+  private:
+    int uart_;
+    unsigned long baud_ = 0;
+    void service() { if (onActivity) onActivity(this, activityCtx); }
+};
+
+extern HardwareSerial Serial;
+
+// ESP32 core stand-in: the cycle counter runs at 240 cycles per virtual microsecond.
+class EspClass {
+  public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+};
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file FS.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the ESP32 fs::FS / fs::File API, backed by memory
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "LittleFS.h"
+
+namespace {
+std::map<std::string, std::string>& files() { static std::map<std::string, std::string> f; return f; }
+uint32_t g_written = 0;
+bool g_mountable = true;
+}
+
+namespace mock {
+uint32_t fsBytesWritten() { return g_written; }
+void fsErase() { files().clear(); g_written = 0; }
+void fsSetMountable(bool ok) { g_mountable = ok; }
+}
+
+namespace fs {
+size_t File::write(const uint8_t* buf, size_t len) {
+  if (!data_ || !writable_) return 0;
+  if (data_->size() < pos_ + len) data_->resize(pos_ + len, '\0');
+  memcpy(&(*data_)[pos_], buf, len);
+  pos_ += len;
+  g_written += len;
+  return len;
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+  if (!data_ || pos_ >= data_->size()) return 0;
+  size_t n = data_->size() - pos_ < len ? data_->size() - pos_ : len;
+  memcpy(buf, data_->data() + pos_, n);
+  pos_ += n;
+  return n;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!data_) return false;
+  size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos_ : data_->size();
+  pos_ = base + pos;
+  return true;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  auto& f = files();
+  auto it = f.find(path);
+  std::string m(mode);
+  if (m == "r") {
+    if (it == f.end()) return File();
+    return File(&it->second, false, false);
+  }
+  if (m == "w" || m == "w+") {
+    f[path].clear();
+    return File(&f[path], true, false);
+  }
+  if (m == "a" || m == "a+") return File(&f[path], true, true);
+  if (m == "r+") {
+    if (it == f.end()) return File();
+    return File(&it->second, true, false);
+  }
+  return File();
+}
+
+bool FS::exists(const char* path) { return files().count(path) > 0; }
+bool FS::remove(const char* path) { return files().erase(path) > 0; }
+}  // namespace fs
+
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) { return g_mountable; }
+bool LittleFSFS::format() { files().clear(); return true; }
+size_t LittleFSFS::usedBytes() { size_t n = 0; for (auto& kv : files()) n += kv.second.size(); return n; }
+
+LittleFSFS LittleFS;
@@ -0,0 +1,64 @@
+/**
+ * @file FS.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the ESP32 fs::FS / fs::File API, backed by memory
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef FS_MOCK_H
+#define FS_MOCK_H
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+
+namespace fs {
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+  public:
+    File() {}
+    File(std::string* data, bool writable, bool append) : data_(data), writable_(writable), pos_(append ? data->size() : 0) {}
+    operator bool() const { return data_ != nullptr; }
+    size_t write(const uint8_t* buf, size_t len);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t read(uint8_t* buf, size_t len);
+    int read() { uint8_t c; return read(&c, 1) == 1 ? c : -1; }
+    int available() { return data_ ? (int)(data_->size() - pos_) : 0; }
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const { return pos_; }
+    size_t size() const { return data_ ? data_->size() : 0; }
+    void flush() {}
+    void close() { data_ = nullptr; }
+  private:
+    std::string* data_ = nullptr;
+    bool writable_ = false;
+    size_t pos_ = 0;
+};
+
+class FS {
+  public:
+    File open(const char* path, const char* mode = "r", bool create = false);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool mkdir(const char*) { return true; }
+};
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+namespace mock {
+// Bytes written to the mock filesystem, and a way to wipe it.
+uint32_t fsBytesWritten();
+void fsErase();
+void fsSetMountable(bool ok);
+}
+
+#endif
@@ -0,0 +1,11 @@
+/**
+ * @file HardwareSerial.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for HardwareSerial (declared in Arduino.h)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "Arduino.h"
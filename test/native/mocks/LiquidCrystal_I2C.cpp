@@ -0,0 +1,56 @@
+/**
+ * @file LiquidCrystal_I2C.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for LiquidCrystal_I2C that keeps a character grid
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "LiquidCrystal_I2C.h"
+#include "MockHost.h"
+
+static LiquidCrystal_I2C* g_lastLcd = nullptr;
+
+LiquidCrystal_I2C* mock::lastLcd() { return g_lastLcd; }
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows)
+    : cols_(cols > 40 ? 40 : cols), rows_(rows > 4 ? 4 : rows), col_(0), row_(0), backlight_(false) {
+  (void)addr;
+  memset(grid_, ' ', sizeof(grid_));
+  g_lastLcd = this;
+}
+
+void LiquidCrystal_I2C::init() { clear(); }
+
+void LiquidCrystal_I2C::clear() {
+  memset(grid_, ' ', sizeof(grid_));
+  col_ = row_ = 0;
+  clears++;
+  countByte();
+  delayMicroseconds(2000);  // HD44780 clear-display execution time
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row) {
+  col_ = col;
+  row_ = row < rows_ ? row : rows_ - 1;
+  countByte();
+}
+
+void LiquidCrystal_I2C::backlight() { backlight_ = true; i2cBytes += 2; mock::i2cTransfer(2); }
+void LiquidCrystal_I2C::noBacklight() { backlight_ = false; i2cBytes += 2; mock::i2cTransfer(2); }
+
+size_t LiquidCrystal_I2C::write(uint8_t c) {
+  if (col_ < cols_) grid_[row_][col_] = (char)c;
+  col_++;
+  countByte();
+  return 1;
+}
+
+// Two 4-bit nibbles, each sent as three expander writes of address plus data
+void LiquidCrystal_I2C::countByte() {
+  lcdBytes++;
+  i2cBytes += 12;
+  mock::i2cTransfer(12);
+}
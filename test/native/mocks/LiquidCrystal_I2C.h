@@ -0,0 +1,50 @@
+/**
+ * @file LiquidCrystal_I2C.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for LiquidCrystal_I2C that keeps a character grid
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef LIQUIDCRYSTAL_I2C_MOCK_H
+#define LIQUIDCRYSTAL_I2C_MOCK_H
+
+#include "Arduino.h"
+
+class LiquidCrystal_I2C : public Print {
+  public:
+    LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows);
+    void init();
+    void begin(uint8_t cols, uint8_t rows) { (void)cols; (void)rows; init(); }
+    void clear();
+    void home() { setCursor(0, 0); }
+    void setCursor(uint8_t col, uint8_t row);
+    void backlight();
+    void noBacklight();
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    // Host side inspection.
+    char cell(uint8_t col, uint8_t row) const { return grid_[row][col]; }
+    std::string rowText(uint8_t row) const { return std::string(grid_[row], cols_); }
+    bool backlightOn() const { return backlight_; }
+    // Bytes pushed to the HD44780 (characters plus commands) and I2C bytes that took.
+    uint32_t lcdBytes = 0;
+    uint32_t i2cBytes = 0;
+    uint32_t clears = 0;
+
+  private:
+    uint8_t cols_, rows_, col_, row_;
+    bool backlight_;
+    char grid_[4][40];
+    void countByte();
+};
+
+namespace mock {
+// The display created last, for tests that cannot reach it otherwise
+LiquidCrystal_I2C* lastLcd();
+}
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * @file LittleFS.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for LittleFS, backed by memory
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef LITTLEFS_MOCK_H
+#define LITTLEFS_MOCK_H
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+  public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    bool format();
+    size_t totalBytes() { return 1441792; }
+    size_t usedBytes();
+    void end() {}
+};
+
+extern LittleFSFS LittleFS;
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @file MockHost.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host-side controls for the stand-ins: virtual clock, pins and device hooks
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef MOCK_HOST_H
+#define MOCK_HOST_H
+
+#include <stdint.h>
+
+namespace mock {
+
+// Virtual time in microseconds. Every clock read advances it by autoAdvanceUs so
+// busy-wait loops in the code under test always terminate.
+uint64_t nowUs();
+void setNowUs(uint64_t us);
+void advanceUs(uint64_t us);
+void setAutoAdvanceUs(uint32_t us);
+
+// Devices registered here are ticked whenever virtual time moves forward.
+typedef void (*TickFn)(uint64_t nowUs, void* ctx);
+void addTicker(TickFn fn, void* ctx);
+void removeTicker(TickFn fn, void* ctx);
+void clearTickers();
+
+// Time I2C devices (LCD, RTC) spend per byte on the bus; 0, the default,
+// makes the bus free. 90 us is one byte at 100 kHz.
+void setI2cByteUs(uint32_t us);
+void i2cTransfer(uint32_t bytes);
+
+void setPin(uint8_t pin, int level);
+void fireInterrupt(uint8_t pin);
+
+void reset();
+
+}  // namespace mock
+
+#endif
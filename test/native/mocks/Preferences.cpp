@@ -0,0 +1,71 @@
+/**
+ * @file Preferences.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the ESP32 Preferences (NVS) library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "Preferences.h"
+
+#include <map>
+#include <vector>
+
+namespace {
+std::map<std::string, std::map<std::string, std::vector<uint8_t> > > g_nvs;
+uint32_t g_writes = 0;
+}
+
+uint32_t mock::nvsWrites() { return g_writes; }
+void mock::nvsErase() { g_nvs.clear(); g_writes = 0; }
+
+bool Preferences::begin(const char* name, bool readOnly) {
+  ns_ = name;
+  open_ = true;
+  readOnly_ = readOnly;
+  return true;
+}
+
+void Preferences::end() { open_ = false; }
+
+bool Preferences::clear() {
+  if (!open_ || readOnly_) return false;
+  g_nvs[ns_].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!open_ || readOnly_) return false;
+  g_writes++;
+  return g_nvs[ns_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  return open_ && g_nvs[ns_].count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (!open_ || readOnly_) return 0;
+  const uint8_t* p = (const uint8_t*)value;
+  g_nvs[ns_][key] = std::vector<uint8_t>(p, p + len);
+  g_writes++;
+  return len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  if (!open_) return 0;
+  std::map<std::string, std::vector<uint8_t> >& m = g_nvs[ns_];
+  std::map<std::string, std::vector<uint8_t> >::iterator it = m.find(key);
+  if (it == m.end() || it->second.size() > maxLen) return 0;
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!open_) return 0;
+  std::map<std::string, std::vector<uint8_t> >& m = g_nvs[ns_];
+  std::map<std::string, std::vector<uint8_t> >::iterator it = m.find(key);
+  return it == m.end() ? 0 : it->second.size();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file Preferences.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the ESP32 Preferences (NVS) library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Contents live for the whole process, so a test can simulate a reboot by
+ * opening the same namespace again.
+ */
+#ifndef PREFERENCES_MOCK_H
+#define PREFERENCES_MOCK_H
+
+#include "Arduino.h"
+
+class Preferences {
+  public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    size_t getBytesLength(const char* key);
+
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, 1); }
+    uint8_t getUChar(const char* key, uint8_t def = 0) { uint8_t v = def; getBytes(key, &v, 1); return v; }
+    size_t putUShort(const char* key, uint16_t value) { return putBytes(key, &value, 2); }
+    uint16_t getUShort(const char* key, uint16_t def = 0) { uint16_t v = def; getBytes(key, &v, 2); return v; }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, 4); }
+    uint32_t getUInt(const char* key, uint32_t def = 0) { uint32_t v = def; getBytes(key, &v, 4); return v; }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    uint32_t getULong(const char* key, uint32_t def = 0) { return getUInt(key, def); }
+
+  private:
+    std::string ns_;
+    bool open_ = false;
+    bool readOnly_ = false;
+};
+
+namespace mock {
+// Number of NVS writes since the last reset, and a way to wipe all namespaces.
+uint32_t nvsWrites();
+void nvsErase();
+}
+
+#endif
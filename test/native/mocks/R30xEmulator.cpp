@@ -0,0 +1,490 @@
+/**
+ * @file R30xEmulator.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host emulator of an R30x/AS608 fingerprint sensor on a mock HardwareSerial
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "R30xEmulator.h"
+#include "Adafruit_Fingerprint.h"
+#include "MockHost.h"
+
+// Instruction codes Adafruit_Fingerprint.h does not name
+#define R30X_MATCH      0x03
+#define R30X_DOWNCHAR   0x09
+#define R30X_SETSYSPARA 0x0E
+
+static const uint8_t TEMPLATE_MARK[2] = {0x03, 0x01};
+static const size_t PACKET_OVERHEAD = 11;  // Start code, address, type, length, checksum
+
+R30xEmulator::R30xEmulator(HardwareSerial* port, const R30xConfig& config) {
+  this->port = port;
+  this->settings = config;
+  this->random = config.seed != 0 ? config.seed : 1;
+  this->library.assign(config.capacity, 0);
+  this->cursor = 0;
+  this->touchPin = -1;
+  this->touchActiveHigh = true;
+  this->pinDown = false;
+  this->image = Capture{0, -1};
+  this->buffers[0] = Capture{0, -1};
+  this->buffers[1] = Capture{0, -1};
+  this->busyUntilUs = 0;
+  this->lastSearched = -1;
+  this->arrivedUs = 0;
+  this->downloading = false;
+  this->downloadBuffer = 1;
+  memset(&this->counters, 0, sizeof(this->counters));
+
+  port->onActivity = onActivity;
+  port->activityCtx = this;
+}
+
+R30xEmulator::~R30xEmulator() {
+  if (port->activityCtx == this) {
+    port->onActivity = nullptr;
+    port->activityCtx = nullptr;
+  }
+  if (touchPin >= 0) mock::removeTicker(onTick, this);
+}
+
+void R30xEmulator::onActivity(HardwareSerial*, void* ctx) {
+  static_cast<R30xEmulator*>(ctx)->service();
+}
+
+void R30xEmulator::onTick(uint64_t nowUs, void* ctx) {
+  R30xEmulator* self = static_cast<R30xEmulator*>(ctx);
+  bool down = self->touchAt(nowUs) >= 0;
+  if (down == self->pinDown) return;
+  self->pinDown = down;
+  mock::setPin(self->touchPin, down == self->touchActiveHigh ? HIGH : LOW);
+  if (down) mock::fireInterrupt(self->touchPin);
+}
+
+uint32_t R30xEmulator::nextRandom() {
+  // xorshift32: repeatable from the seed
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  return random;
+}
+
+uint32_t R30xEmulator::uartUs(size_t bytes) const {
+  // 10 bits per byte on the wire
+  unsigned long baud = port->baudRate() > 0 ? port->baudRate() : 57600;
+  return (uint32_t)((uint64_t)bytes * 10 * 1000000 / baud);
+}
+
+// ----------------------
+// LIBRARY AND SCRIPT
+// ----------------------
+void R30xEmulator::templateFor(uint32_t finger, uint8_t* out) {
+  out[0] = TEMPLATE_MARK[0];
+  out[1] = TEMPLATE_MARK[1];
+  out[2] = (uint8_t)(finger >> 24);
+  out[3] = (uint8_t)(finger >> 16);
+  out[4] = (uint8_t)(finger >> 8);
+  out[5] = (uint8_t)finger;
+  uint32_t x = finger | 1;
+  for (uint16_t i = 6; i < TEMPLATE_SIZE; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    out[i] = (uint8_t)x;
+  }
+}
+
+uint32_t R30xEmulator::keyOf(const uint8_t* data, size_t length) {
+  if (length != TEMPLATE_SIZE || data[0] != TEMPLATE_MARK[0] || data[1] != TEMPLATE_MARK[1]) return 0;
+  return ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 8) | data[5];
+}
+
+void R30xEmulator::enroll(uint16_t slot) {
+  if (slot < library.size()) library[slot] = fingerFor(slot);
+}
+
+void R30xEmulator::enrollRange(uint16_t first, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++) enroll(first + i);
+}
+
+uint16_t R30xEmulator::templateCount() const {
+  uint16_t n = 0;
+  for (uint32_t key : library) n += key != 0;
+  return n;
+}
+
+void R30xEmulator::touch(uint32_t finger, uint32_t holdMs, uint32_t afterMs) {
+  Touch t;
+  t.startUs = mock::nowUs() + (uint64_t)afterMs * 1000;
+  t.endUs = t.startUs + (uint64_t)holdMs * 1000;
+  t.finger = finger;
+  t.served = false;
+  size_t i = script.size();
+  while (i > cursor && script[i - 1].startUs > t.startUs) i--;
+  script.insert(script.begin() + i, t);
+  counters.touches++;
+}
+
+void R30xEmulator::scriptRush(uint32_t count, uint32_t gapMs, uint32_t holdMs, uint8_t knownPercent) {
+  std::vector<uint16_t> enrolled;
+  for (uint16_t slot = 0; slot < library.size(); slot++) {
+    if (library[slot] != 0) enrolled.push_back(slot);
+  }
+  uint64_t now = mock::nowUs();
+  uint64_t at = scriptEndUs() > now ? scriptEndUs() : now;
+  for (uint32_t i = 0; i < count; i++) {
+    at += (uint64_t)gapMs * 1000;
+    uint32_t finger;
+    if (!enrolled.empty() && nextRandom() % 100 < knownPercent) {
+      finger = library[enrolled[nextRandom() % enrolled.size()]];
+    } else {
+      finger = strangerFinger((uint16_t)(i + 1));
+    }
+    touch(finger, holdMs, (uint32_t)((at - now) / 1000));
+    at += (uint64_t)holdMs * 1000;
+  }
+}
+
+int32_t R30xEmulator::touchAt(uint64_t us) {
+  while (cursor < script.size() && script[cursor].endUs <= us) cursor++;
+  if (cursor < script.size() && script[cursor].startUs <= us) return (int32_t)cursor;
+  return -1;
+}
+
+bool R30xEmulator::fingerDown() {
+  return touchAt(mock::nowUs()) >= 0;
+}
+
+void R30xEmulator::lift() {
+  int32_t index = touchAt(mock::nowUs());
+  if (index >= 0) script[index].endUs = mock::nowUs();
+}
+
+uint32_t R30xEmulator::missedTouches() {
+  uint64_t now = mock::nowUs();
+  uint32_t missed = 0;
+  for (const Touch& t : script) {
+    if (t.endUs <= now && !t.served) missed++;
+  }
+  return missed;
+}
+
+void R30xEmulator::setTouchPin(uint8_t pin, bool activeHigh) {
+  if (touchPin < 0) mock::addTicker(onTick, this);
+  touchPin = pin;
+  touchActiveHigh = activeHigh;
+  pinDown = false;
+  mock::setPin(pin, activeHigh ? LOW : HIGH);
+}
+
+// ----------------------
+// WIRE PROTOCOL
+// ----------------------
+void R30xEmulator::service() {
+  while (!port->tx.empty()) {
+    uint8_t c = port->tx.front();
+    port->tx.pop_front();
+    receive(c);
+  }
+
+  uint64_t now = mock::nowUs();
+  size_t released = 0;
+  while (released < outputs.size() && outputs[released].dueUs <= now) {
+    const std::string& bytes = outputs[released].bytes;
+    port->inject((const uint8_t*)bytes.data(), bytes.size());
+    released++;
+  }
+  if (released > 0) outputs.erase(outputs.begin(), outputs.begin() + released);
+}
+
+void R30xEmulator::receive(uint8_t c) {
+  // Resynchronise on the start code
+  if ((rx.size() == 0 && c != (FINGERPRINT_STARTCODE >> 8)) ||
+      (rx.size() == 1 && c != (FINGERPRINT_STARTCODE & 0xFF))) {
+    rx.clear();
+    return;
+  }
+  rx += (char)c;
+  if (rx.size() < 9) return;
+
+  const uint8_t* b = (const uint8_t*)rx.data();
+  uint16_t length = ((uint16_t)b[7] << 8) | b[8];
+  if (length < 2 || length > 2 + 256) {
+    rx.clear();
+    return;
+  }
+  if (rx.size() < 9 + (size_t)length) return;
+
+  uint16_t sum = b[6] + b[7] + b[8];
+  for (uint16_t i = 0; i < length - 2; i++) sum += b[9 + i];
+  uint16_t given = ((uint16_t)b[7 + length] << 8) | b[8 + length];
+  // A corrupted packet is dropped, as the sensor does; the host times out
+  if (sum == given) {
+    arrivedUs = mock::nowUs() + uartUs(rx.size());
+    packet(b[6], b + 9, length - 2);
+  }
+  rx.clear();
+}
+
+void R30xEmulator::packet(uint8_t type, const uint8_t* data, uint16_t length) {
+  if (type == FINGERPRINT_COMMANDPACKET) {
+    if (length > 0) command(data, length);
+    return;
+  }
+  if (!downloading) return;
+  if (type == FINGERPRINT_DATAPACKET || type == FINGERPRINT_ENDDATAPACKET) {
+    downloadData.append((const char*)data, length);
+    busyUntilUs = busyUntilUs > arrivedUs ? busyUntilUs : arrivedUs;
+  }
+  if (type == FINGERPRINT_ENDDATAPACKET) {
+    downloading = false;
+    bufferFor(downloadBuffer) = Capture{keyOf((const uint8_t*)downloadData.data(), downloadData.size()), -1};
+    downloadData.clear();
+  }
+}
+
+uint64_t R30xEmulator::send(uint64_t afterUs, uint8_t type, const uint8_t* data, uint16_t length) {
+  std::string bytes;
+  bytes += (char)(FINGERPRINT_STARTCODE >> 8);
+  bytes += (char)(FINGERPRINT_STARTCODE & 0xFF);
+  bytes.append(4, (char)0xFF);
+  bytes += (char)type;
+  bytes += (char)((length + 2) >> 8);
+  bytes += (char)((length + 2) & 0xFF);
+  uint16_t sum = type + ((length + 2) >> 8) + ((length + 2) & 0xFF);
+  for (uint16_t i = 0; i < length; i++) {
+    bytes += (char)data[i];
+    sum += data[i];
+  }
+  bytes += (char)(sum >> 8);
+  bytes += (char)(sum & 0xFF);
+
+  Output out;
+  out.dueUs = afterUs + uartUs(bytes.size());
+  out.bytes = bytes;
+  size_t i = outputs.size();
+  while (i > 0 && outputs[i - 1].dueUs > out.dueUs) i--;
+  outputs.insert(outputs.begin() + i, out);
+  return out.dueUs;
+}
+
+uint64_t R30xEmulator::ack(uint32_t us, uint8_t code, const uint8_t* data, uint16_t length) {
+  uint8_t payload[32];
+  payload[0] = code;
+  if (length > sizeof(payload) - 1) length = sizeof(payload) - 1;
+  if (length > 0) memcpy(payload + 1, data, length);
+
+  uint64_t start = busyUntilUs > arrivedUs ? busyUntilUs : arrivedUs;
+  busyUntilUs = send(start + us, FINGERPRINT_ACKPACKET, payload, length + 1);
+  return busyUntilUs;
+}
+
+void R30xEmulator::command(const uint8_t* data, uint16_t length) {
+  counters.commands++;
+  uint8_t code = data[0];
+  uint32_t commandUs = settings.commandMs * 1000;
+  uint32_t flashUs = settings.flashMs * 1000;
+  uint16_t slot = length >= 4 ? ((uint16_t)data[2] << 8) | data[3] : 0;
+
+  switch (code) {
+    case FINGERPRINT_VERIFYPASSWORD: {
+      uint32_t given = length >= 5 ? ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) |
+                                     ((uint32_t)data[3] << 8) | data[4] : 0;
+      ack(commandUs, given == settings.password ? FINGERPRINT_OK : FINGERPRINT_PASSFAIL);
+      break;
+    }
+    case FINGERPRINT_SETPASSWORD:
+      if (length >= 5) {
+        settings.password = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 8) | data[4];
+      }
+      ack(commandUs, FINGERPRINT_OK);
+      break;
+
+    case FINGERPRINT_READSYSPARAM: {
+      uint16_t baud = (uint16_t)((port->baudRate() > 0 ? port->baudRate() : 57600) / 9600);
+      uint8_t params[16] = {
+        0x00, 0x00, 0x00, 0x09,
+        (uint8_t)(settings.capacity >> 8), (uint8_t)settings.capacity,
+        0x00, 0x03,
+        0xFF, 0xFF, 0xFF, 0xFF,
+        0x00, settings.packetSizeCode,
+        (uint8_t)(baud >> 8), (uint8_t)baud
+      };
+      ack(commandUs, FINGERPRINT_OK, params, sizeof(params));
+      break;
+    }
+    case R30X_SETSYSPARA:
+      if (length < 3) {
+        ack(commandUs, FINGERPRINT_PACKETRECIEVEERR);
+      } else if (data[1] == FINGERPRINT_PACKET_REG_ADDR && data[2] <= 3) {
+        settings.packetSizeCode = data[2];
+        ack(commandUs, FINGERPRINT_OK);
+      } else if (data[1] == FINGERPRINT_BAUD_REG_ADDR || data[1] == FINGERPRINT_SECURITY_REG_ADDR) {
+        ack(commandUs, FINGERPRINT_OK);  // The host moves the port itself
+      } else {
+        ack(commandUs, FINGERPRINT_INVALIDREG);
+      }
+      break;
+
+    case FINGERPRINT_TEMPLATECOUNT: {
+      uint16_t n = templateCount();
+      uint8_t reply[2] = {(uint8_t)(n >> 8), (uint8_t)n};
+      ack(commandUs, FINGERPRINT_OK, reply, sizeof(reply));
+      break;
+    }
+
+    case FINGERPRINT_GETIMAGE: {
+      counters.images++;
+      int32_t t = touchAt(arrivedUs);
+      if (t < 0) {
+        counters.idleImages++;
+        image = Capture{0, -1};
+        ack(settings.getImageMs * 1000, FINGERPRINT_NOFINGER);
+      } else {
+        image = Capture{script[t].finger, t};
+        ack(settings.getImageMs * 1000, FINGERPRINT_OK);
+      }
+      break;
+    }
+    case FINGERPRINT_IMAGE2TZ: {
+      uint8_t buffer = length >= 2 ? data[1] : 1;
+      if (image.key == 0) {
+        ack(settings.image2TzMs * 1000, FINGERPRINT_INVALIDIMAGE);
+      } else if (settings.imageFailPercent > 0 && nextRandom() % 100 < settings.imageFailPercent) {
+        ack(settings.image2TzMs * 1000, FINGERPRINT_IMAGEMESS);
+      } else {
+        Capture features = image;
+        // A smudged or misplaced finger: features that match nothing
+        if (settings.falseRejectPercent > 0 && nextRandom() % 100 < settings.falseRejectPercent) {
+          features.key ^= 0x40000000UL;
+        }
+        bufferFor(buffer) = features;
+        ack(settings.image2TzMs * 1000, FINGERPRINT_OK);
+      }
+      break;
+    }
+    case FINGERPRINT_SEARCH:
+    case FINGERPRINT_HISPEEDSEARCH:
+      if (length < 6) {
+        ack(commandUs, FINGERPRINT_PACKETRECIEVEERR);
+      } else {
+        search(data[1], ((uint16_t)data[2] << 8) | data[3], ((uint16_t)data[4] << 8) | data[5]);
+      }
+      break;
+
+    case R30X_MATCH: {
+      bool same = buffers[0].key != 0 && buffers[0].key == buffers[1].key;
+      uint16_t score = same ? 150 : 0;
+      uint8_t reply[2] = {(uint8_t)(score >> 8), (uint8_t)score};
+      ack(settings.matchMs * 1000, same ? FINGERPRINT_OK : FINGERPRINT_NOMATCH, reply, sizeof(reply));
+      break;
+    }
+    case FINGERPRINT_REGMODEL: {
+      bool same = buffers[0].key != 0 && buffers[0].key == buffers[1].key;
+      ack(settings.matchMs * 1000, same ? FINGERPRINT_OK : FINGERPRINT_ENROLLMISMATCH);
+      break;
+    }
+
+    case FINGERPRINT_STORE:
+      if (length < 4 || slot >= library.size()) {
+        ack(commandUs, FINGERPRINT_BADLOCATION);
+      } else {
+        library[slot] = bufferFor(data[1]).key;
+        ack(flashUs, FINGERPRINT_OK);
+      }
+      break;
+    case FINGERPRINT_LOAD:
+      if (length < 4 || slot >= library.size()) {
+        ack(commandUs, FINGERPRINT_BADLOCATION);
+      } else if (library[slot] == 0) {
+        ack(flashUs, FINGERPRINT_DBREADFAIL);
+      } else {
+        bufferFor(data[1]) = Capture{library[slot], -1};
+        ack(flashUs, FINGERPRINT_OK);
+      }
+      break;
+    case FINGERPRINT_DELETE: {
+      uint16_t first = length >= 3 ? ((uint16_t)data[1] << 8) | data[2] : 0;
+      uint16_t count = length >= 5 ? ((uint16_t)data[3] << 8) | data[4] : 0;
+      if (length < 5 || (uint32_t)first + count > library.size()) {
+        ack(commandUs, FINGERPRINT_DELETEFAIL);
+      } else {
+        for (uint16_t i = 0; i < count; i++) library[first + i] = 0;
+        ack(flashUs, FINGERPRINT_OK);
+      }
+      break;
+    }
+    case FINGERPRINT_EMPTY:
+      library.assign(library.size(), 0);
+      ack(flashUs, FINGERPRINT_OK);
+      break;
+
+    case FINGERPRINT_UPLOAD: {
+      const Capture& source = bufferFor(length >= 2 ? data[1] : 1);
+      if (source.key == 0) {
+        ack(commandUs, FINGERPRINT_UPLOADFEATUREFAIL);
+        break;
+      }
+      uint64_t at = ack(commandUs, FINGERPRINT_OK);
+      uint8_t bytes[TEMPLATE_SIZE];
+      templateFor(source.key, bytes);
+      uint16_t packetSize = 32 << settings.packetSizeCode;
+      for (uint16_t sent = 0; sent < TEMPLATE_SIZE; sent += packetSize) {
+        uint16_t n = TEMPLATE_SIZE - sent < packetSize ? TEMPLATE_SIZE - sent : packetSize;
+        bool last = sent + n >= TEMPLATE_SIZE;
+        at = send(at, last ? FINGERPRINT_ENDDATAPACKET : FINGERPRINT_DATAPACKET, bytes + sent, n);
+      }
+      busyUntilUs = at;
+      break;
+    }
+    case R30X_DOWNCHAR:
+      downloading = true;
+      downloadBuffer = length >= 2 ? data[1] : 1;
+      downloadData.clear();
+      ack(commandUs, FINGERPRINT_OK);
+      break;
+
+    default:
+      ack(commandUs, FINGERPRINT_PACKETRECIEVEERR);
+      break;
+  }
+}
+
+void R30xEmulator::search(uint8_t buffer, uint16_t start, uint16_t count) {
+  const Capture& probe = bufferFor(buffer);
+  counters.searches++;
+
+  // Only stored templates cost time; the search stops at the first hit
+  uint32_t compared = 0;
+  int32_t found = -1;
+  uint32_t end = (uint32_t)start + count;
+  if (end > library.size()) end = library.size();
+  for (uint32_t slot = start; slot < end && probe.key != 0; slot++) {
+    if (library[slot] == 0) continue;
+    compared++;
+    if (library[slot] == probe.key) {
+      found = (int32_t)slot;
+      break;
+    }
+  }
+
+  uint32_t us = settings.searchBaseMs * 1000 + compared * settings.searchUsPerTemplate;
+  uint16_t score = found >= 0 ? 100 + (uint16_t)(nextRandom() % 100) : 0;
+  uint16_t page = found >= 0 ? (uint16_t)found : 0;
+  uint8_t reply[4] = {(uint8_t)(page >> 8), (uint8_t)page, (uint8_t)(score >> 8), (uint8_t)score};
+  uint64_t due = ack(us, found >= 0 ? FINGERPRINT_OK : FINGERPRINT_NOTFOUND, reply, sizeof(reply));
+  if (found >= 0) counters.matches++;
+  lastSearched = probe.touch;
+
+  if (probe.touch >= 0 && !script[probe.touch].served) {
+    Touch& t = script[probe.touch];
+    t.served = true;
+    uint32_t latency = (uint32_t)(due - t.startUs);
+    counters.served++;
+    counters.latencySumUs += latency;
+    if (latency > counters.latencyMaxUs) counters.latencyMaxUs = latency;
+  }
+}
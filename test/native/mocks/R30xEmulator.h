@@ -0,0 +1,162 @@
+/**
+ * @file R30xEmulator.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host emulator of an R30x/AS608 fingerprint sensor on a mock HardwareSerial
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Answers the packet protocol Adafruit_Fingerprint and FingerprintLink
+ * speak: GenImg, Img2Tz, Search / HighSpeedSearch, Match, RegModel, Store,
+ * LoadChar, UpChar, DownChar, DeleteChar, Empty, ReadSysPara,
+ * SetSysPara, VfyPwd and TempleteNum.
+ *
+ * A finger is a 32-bit key. Its template is 512 synthetic bytes that carry
+ * the key, so templates survive UpChar / DownChar and match by key. Touches
+ * are scripted on the virtual clock (MockHost.h); GenImg sees a finger
+ * only while one is down. Each command answers after its configured time
+ * plus the UART time of both packets, and a touch counts as served once a
+ * search over its image has answered.
+ */
+#ifndef R30X_EMULATOR_H
+#define R30X_EMULATOR_H
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+struct R30xConfig {
+  uint16_t capacity = 1000;          // Library slots
+  uint8_t packetSizeCode = 2;        // 0..3 = 32, 64, 128, 256 bytes
+  uint32_t password = 0;
+  uint32_t getImageMs = 150;         // GenImg, finger or not
+  uint32_t image2TzMs = 250;         // Feature extraction
+  uint32_t searchBaseMs = 10;
+  uint32_t searchUsPerTemplate = 800;  // Per stored template compared
+  uint32_t matchMs = 40;             // One-to-one Match, RegModel
+  uint32_t flashMs = 30;             // Store, LoadChar, DeleteChar, Empty
+  uint32_t commandMs = 2;            // Everything else
+  uint8_t falseRejectPercent = 0;    // Known fingers whose features do not match
+  uint8_t imageFailPercent = 0;      // Img2Tz answers "image too messy"
+  uint32_t seed = 1;
+};
+
+struct R30xStats {
+  uint32_t commands;
+  uint32_t images;       // GenImg
+  uint32_t idleImages;   // GenImg with no finger down
+  uint32_t searches;
+  uint32_t matches;      // Searches that found a slot
+  uint32_t touches;      // Scripted
+  uint32_t served;       // Touches whose image was searched
+  uint64_t latencySumUs; // Touch down -> search answer, served touches
+  uint32_t latencyMaxUs;
+};
+
+class R30xEmulator {
+  public:
+    static const uint16_t TEMPLATE_SIZE = 512;
+
+    R30xEmulator(HardwareSerial* port, const R30xConfig& config = R30xConfig());
+    ~R30xEmulator();
+
+    // Settings may be changed at any time; they apply to the next command
+    R30xConfig& config() { return settings; }
+
+    // Synthetic fingers: enrolled ones are stored in their own slot
+    static uint32_t fingerFor(uint16_t slot) { return 0x10000UL + slot; }
+    static uint32_t strangerFinger(uint16_t n) { return 0x80000000UL | n; }
+    void enroll(uint16_t slot);
+    void enrollRange(uint16_t first, uint16_t count);
+    uint16_t templateCount() const;
+    // Key stored in `slot`, 0 when empty
+    uint32_t slotKey(uint16_t slot) const { return slot < library.size() ? library[slot] : 0; }
+
+    // Put `finger` down `afterMs` from now for `holdMs`. Touches must not
+    // overlap and are kept in time order.
+    void touch(uint32_t finger, uint32_t holdMs, uint32_t afterMs = 0);
+    // `count` touches, each down for `holdMs` with `gapMs` between a lift
+    // and the next touch: an enrolled finger `knownPercent` of the time, a
+    // stranger otherwise.
+    void scriptRush(uint32_t count, uint32_t gapMs, uint32_t holdMs, uint8_t knownPercent);
+    bool fingerDown();
+    // Lift the finger that is down now, cutting its touch short
+    void lift();
+    // Virtual time the last scripted touch lifts
+    uint64_t scriptEndUs() const { return script.empty() ? 0 : script.back().endUs; }
+
+    // Drive the touch output of the sensor (the blue wire) on `pin`
+    void setTouchPin(uint8_t pin, bool activeHigh = true);
+
+    // Take what the device wrote, release replies that are due
+    void service();
+
+    const R30xStats& stats() const { return counters; }
+    // Scripted touch the last search was over (-1 for none) and when it began
+    int32_t lastSearchedTouch() const { return lastSearched; }
+    uint64_t touchStartUs(int32_t index) const { return script[index].startUs; }
+    // Scripted touches that lifted without ever being searched
+    uint32_t missedTouches();
+    // Synthetic template bytes for `finger`
+    static void templateFor(uint32_t finger, uint8_t* out);
+    // Finger a template belongs to, 0 if it is not one of ours
+    static uint32_t keyOf(const uint8_t* data, size_t length);
+
+  private:
+    struct Touch {
+      uint64_t startUs;
+      uint64_t endUs;
+      uint32_t finger;
+      bool served;
+    };
+    // An image or feature buffer: the finger seen and the touch it came from
+    struct Capture {
+      uint32_t key;
+      int32_t touch;
+    };
+    struct Output {
+      uint64_t dueUs;
+      std::string bytes;
+    };
+
+    HardwareSerial* port;
+    R30xConfig settings;
+    uint32_t random;
+    std::vector<uint32_t> library;
+    std::vector<Touch> script;
+    size_t cursor;               // First touch that has not lifted
+    int16_t touchPin;
+    bool touchActiveHigh;
+    bool pinDown;
+
+    Capture image;
+    Capture buffers[2];
+    std::vector<Output> outputs;
+    uint64_t busyUntilUs;        // Commands run one after another
+    int32_t lastSearched;
+
+    std::string rx;              // Packet being received
+    uint64_t arrivedUs;          // When the last command finished arriving
+    bool downloading;
+    uint8_t downloadBuffer;
+    std::string downloadData;
+
+    R30xStats counters;
+
+    static void onActivity(HardwareSerial* port, void* ctx);
+    static void onTick(uint64_t nowUs, void* ctx);
+    int32_t touchAt(uint64_t us);
+    void receive(uint8_t c);
+    void packet(uint8_t type, const uint8_t* data, uint16_t length);
+    void command(const uint8_t* data, uint16_t length);
+    void search(uint8_t buffer, uint16_t start, uint16_t count);
+    // Queue the acknowledge `us` after the command arrived; returns when it is due
+    uint64_t ack(uint32_t us, uint8_t code, const uint8_t* data = nullptr, uint16_t length = 0);
+    uint64_t send(uint64_t afterUs, uint8_t type, const uint8_t* data, uint16_t length);
+    uint32_t uartUs(size_t bytes) const;
+    uint32_t nextRandom();
+    Capture& bufferFor(uint8_t id) { return buffers[id == 2 ? 1 : 0]; }
+};
+
+#endif
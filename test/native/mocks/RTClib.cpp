@@ -0,0 +1,77 @@
+/**
+ * @file RTClib.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for Adafruit RTClib (DateTime and RTC_DS3231 only)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "RTClib.h"
+#include "MockHost.h"
+
+static const uint8_t daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d) {
+  if (y >= 2000U) y -= 2000U;
+  uint16_t days = d;
+  for (uint8_t i = 1; i < m; ++i) days += daysInMonth[i - 1];
+  if (m > 2 && y % 4 == 0) ++days;
+  return days + 365 * y + (y + 3) / 4 - 1;
+}
+
+DateTime::DateTime(uint32_t t) {
+  t -= SECONDS_FROM_1970_TO_2000;
+  ss = t % 60; t /= 60;
+  mm = t % 60; t /= 60;
+  hh = t % 24;
+  uint16_t days = t / 24;
+  uint8_t leap;
+  for (yOff = 0;; ++yOff) {
+    leap = yOff % 4 == 0;
+    if (days < 365U + leap) break;
+    days -= 365 + leap;
+  }
+  for (m = 1; m < 12; ++m) {
+    uint8_t dim = daysInMonth[m - 1];
+    if (leap && m == 2) ++dim;
+    if (days < dim) break;
+    days -= dim;
+  }
+  d = days + 1;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec) {
+  if (year >= 2000U) year -= 2000U;
+  yOff = year; m = month; d = day; hh = hour; mm = min; ss = sec;
+}
+
+DateTime::DateTime(const __FlashStringHelper*, const __FlashStringHelper*) {
+  yOff = 25; m = 1; d = 1; hh = 0; mm = 0; ss = 0;
+}
+
+uint8_t DateTime::dayOfTheWeek() const {
+  uint16_t day = date2days(yOff, m, d);
+  return (day + 6) % 7;
+}
+
+uint32_t DateTime::unixtime() const {
+  uint16_t days = date2days(yOff, m, d);
+  return ((days * 24UL + hh) * 60 + mm) * 60 + ss + SECONDS_FROM_1970_TO_2000;
+}
+
+static uint32_t g_rtcBase = DateTime(2025, 11, 28, 7, 0, 0).unixtime();
+static uint64_t g_rtcSetAtUs = 0;
+
+void mock::setRtc(const DateTime& dt) {
+  g_rtcBase = dt.unixtime();
+  g_rtcSetAtUs = mock::nowUs();
+}
+
+void RTC_DS3231::adjust(const DateTime& dt) { mock::setRtc(dt); }
+
+DateTime RTC_DS3231::now() {
+  mock::i2cTransfer(10);  // Register pointer write, then seven time registers
+  return DateTime(g_rtcBase + (uint32_t)((mock::nowUs() - g_rtcSetAtUs) / 1000000ULL));
+}
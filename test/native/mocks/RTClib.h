@@ -0,0 +1,49 @@
+/**
+ * @file RTClib.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for Adafruit RTClib (DateTime and RTC_DS3231 only)
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef RTCLIB_MOCK_H
+#define RTCLIB_MOCK_H
+
+#include "Arduino.h"
+
+#define SECONDS_FROM_1970_TO_2000 946684800
+
+class DateTime {
+  public:
+    DateTime(uint32_t t = SECONDS_FROM_1970_TO_2000);
+    DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+    DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time);
+    uint16_t year() const { return 2000U + yOff; }
+    uint8_t month() const { return m; }
+    uint8_t day() const { return d; }
+    uint8_t hour() const { return hh; }
+    uint8_t minute() const { return mm; }
+    uint8_t second() const { return ss; }
+    uint8_t dayOfTheWeek() const;
+    uint32_t unixtime() const;
+  protected:
+    uint8_t yOff, m, d, hh, mm, ss;
+};
+
+class RTC_DS3231 {
+  public:
+    bool begin() { return true; }
+    bool lostPower() { return false; }
+    void adjust(const DateTime& dt);
+    DateTime now();
+    float getTemperature() { return 25.0f; }
+};
+
+namespace mock {
+// Wall clock offset applied on top of the virtual clock by RTC_DS3231::now().
+void setRtc(const DateTime& dt);
+}
+
+#endif
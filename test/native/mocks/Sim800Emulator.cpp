@@ -0,0 +1,355 @@
+/**
+ * @file Sim800Emulator.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host emulator of a SIM800L on the other end of a mock HardwareSerial
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "Sim800Emulator.h"
+#include "MockHost.h"
+
+static const char* const SCTS_TEXT = "25/11/28,07:00:00+32";
+static const char* const SCTS_PDU = "52118270000023";  // Same time, swapped semi-octets
+
+Sim800Emulator::Sim800Emulator(HardwareSerial* port, const Sim800Config& config) {
+  this->port = port;
+  this->settings = config;
+  this->random = config.seed != 0 ? config.seed : 1;
+  this->inPayload = false;
+  this->cmgsLength = 0;
+  this->echo = true;
+  this->pdu = false;
+  this->csdh = false;
+  this->cnmiMt = 0;
+  this->onNetwork = true;
+  this->regainAtUs = 0;
+  this->failCount = 0;
+  this->failCode = 500;
+  this->nextReference = 1;
+  this->nextIndex = 1;
+  this->commands = 0;
+  this->rejected = 0;
+
+  port->onActivity = onActivity;
+  port->activityCtx = this;
+}
+
+Sim800Emulator::~Sim800Emulator() {
+  if (port->activityCtx == this) {
+    port->onActivity = nullptr;
+    port->activityCtx = nullptr;
+  }
+}
+
+void Sim800Emulator::onActivity(HardwareSerial*, void* ctx) {
+  static_cast<Sim800Emulator*>(ctx)->service();
+}
+
+void Sim800Emulator::setRegistered(bool registered) {
+  onNetwork = registered;
+  regainAtUs = 0;
+}
+
+void Sim800Emulator::loseRegistrationFor(uint32_t ms) {
+  onNetwork = false;
+  regainAtUs = mock::nowUs() + (uint64_t)ms * 1000;
+}
+
+bool Sim800Emulator::registered() {
+  if (!onNetwork && regainAtUs != 0 && mock::nowUs() >= regainAtUs) {
+    onNetwork = true;
+    regainAtUs = 0;
+  }
+  return onNetwork;
+}
+
+void Sim800Emulator::failNext(uint16_t count, uint16_t code) {
+  failCount = count;
+  failCode = code;
+}
+
+uint32_t Sim800Emulator::nextRandom() {
+  // xorshift32: repeatable from the seed
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  return random;
+}
+
+uint32_t Sim800Emulator::uartMs(size_t bytes) const {
+  // 10 bits per byte on the wire
+  unsigned long baud = port->baudRate() > 0 ? port->baudRate() : 9600;
+  return (uint32_t)((bytes * 10 * 1000 + baud - 1) / baud);
+}
+
+void Sim800Emulator::service() {
+  while (!port->tx.empty()) {
+    uint8_t c = port->tx.front();
+    port->tx.pop_front();
+    receive(c);
+  }
+
+  uint64_t now = mock::nowUs();
+  size_t released = 0;
+  while (released < outputs.size() && outputs[released].dueUs <= now) {
+    Output& out = outputs[released];
+    port->inject(out.text.c_str());
+    if (out.confirms) accepted.push_back(out.sms);
+    released++;
+  }
+  if (released > 0) outputs.erase(outputs.begin(), outputs.begin() + released);
+}
+
+void Sim800Emulator::schedule(const Output& output) {
+  // Keep the order of equal due times: replies to one command stay together
+  size_t i = outputs.size();
+  while (i > 0 && outputs[i - 1].dueUs > output.dueUs) i--;
+  outputs.insert(outputs.begin() + i, output);
+}
+
+void Sim800Emulator::reply(uint32_t delayMs, const std::string& text) {
+  Output out;
+  out.dueUs = mock::nowUs() + (uint64_t)delayMs * 1000;
+  out.text = text;
+  out.confirms = false;
+  schedule(out);
+}
+
+void Sim800Emulator::receive(uint8_t c) {
+  if (inPayload) {
+    if (c == 26) {
+      inPayload = false;
+      submit();
+    } else if (c == 27) {
+      // ESC abandons the message
+      inPayload = false;
+      payload.clear();
+      reply(0, "\r\nOK\r\n");
+    } else {
+      payload += (char)c;
+    }
+    return;
+  }
+
+  if (c == '\n') return;  // Commands end at '\r'; "\r\n" is accepted too
+  if (c != '\r') {
+    line += (char)c;
+    return;
+  }
+  if (echo) reply(0, line + "\r");
+  if (!line.empty()) command(line);
+  line.clear();
+}
+
+void Sim800Emulator::command(const std::string& cmd) {
+  commands++;
+  last = cmd;
+  const char* ok = "\r\nOK\r\n";
+  char buffer[96];
+
+  if (cmd == "AT") {
+    reply(0, ok);
+  } else if (cmd == "ATE0" || cmd == "ATE1") {
+    echo = cmd == "ATE1";
+    reply(0, ok);
+  } else if (cmd == "AT+CPIN?") {
+    reply(0, "\r\n+CPIN: READY\r\n" + std::string(ok));
+  } else if (cmd == "AT+CSQ") {
+    snprintf(buffer, sizeof(buffer), "\r\n+CSQ: %u,0\r\n%s", registered() ? settings.signal : 99, ok);
+    reply(0, buffer);
+  } else if (cmd == "AT+CREG?") {
+    snprintf(buffer, sizeof(buffer), "\r\n+CREG: 0,%d\r\n%s", registered() ? 1 : 2, ok);
+    reply(0, buffer);
+  } else if (cmd == "AT+CMGF=0" || cmd == "AT+CMGF=1") {
+    pdu = cmd == "AT+CMGF=0";
+    reply(0, ok);
+  } else if (cmd == "AT+CSDH=0" || cmd == "AT+CSDH=1") {
+    csdh = cmd == "AT+CSDH=1";
+    reply(0, ok);
+  } else if (cmd.compare(0, 8, "AT+CNMI=") == 0) {
+    size_t comma = cmd.find(',');
+    cnmiMt = comma == std::string::npos ? 0 : atoi(cmd.c_str() + comma + 1);
+    reply(0, ok);
+  } else if (cmd.compare(0, 8, "AT+CMGS=") == 0) {
+    std::string arg = cmd.substr(8);
+    if (pdu) {
+      cmgsLength = atoi(arg.c_str());
+      cmgsNumber.clear();
+    } else {
+      cmgsLength = 0;
+      cmgsNumber = arg.size() >= 2 && arg[0] == '"' ? arg.substr(1, arg.size() - 2) : arg;
+    }
+    inPayload = true;
+    payload.clear();
+    reply(settings.promptDelayMs, "\r\n> ");
+  } else if (cmd.compare(0, 8, "AT+CMGR=") == 0) {
+    auto it = stored.find(atoi(cmd.c_str() + 8));
+    if (it == stored.end()) {
+      reply(0, "\r\n+CMS ERROR: 321\r\n");
+    } else if (pdu) {
+      size_t length = 0;
+      std::string hex = deliverPdu(it->second.number.c_str(), it->second.text.c_str(), &length);
+      snprintf(buffer, sizeof(buffer), "\r\n+CMGR: 0,,%u\r\n", (unsigned)length);
+      reply(0, buffer + hex + "\r\n" + ok);
+    } else {
+      reply(0, "\r\n+CMGR: \"REC UNREAD\",\"" + it->second.number + "\",\"\",\"" + SCTS_TEXT + "\"" +
+               textDetails(it->second.text) + "\r\n" + it->second.text + "\r\n" + ok);
+    }
+  } else if (cmd.compare(0, 8, "AT+CMGD=") == 0) {
+    stored.erase(atoi(cmd.c_str() + 8));
+    reply(0, ok);
+  } else if (cmd.compare(0, 3, "ATD") == 0) {
+    std::string number = cmd.substr(3);
+    if (!number.empty() && number.back() == ';') number.pop_back();
+    if (registered()) {
+      calls.push_back(number);
+      reply(settings.promptDelayMs, ok);
+    } else {
+      reply(settings.networkLatencyMs, "\r\nNO CARRIER\r\n");
+    }
+  } else if (cmd == "ATH") {
+    reply(0, ok);
+  } else {
+    reply(0, "\r\nERROR\r\n");
+  }
+}
+
+void Sim800Emulator::submit() {
+  uint32_t delay = uartMs(payload.size() + 1) + settings.networkLatencyMs;
+  if (settings.latencyJitterMs > 0) delay += nextRandom() % (settings.latencyJitterMs + 1);
+
+  int error = 0;
+  if (pdu && !validPdu(payload, cmgsLength)) {
+    error = 304;  // Invalid PDU mode parameter, found before anything is sent
+    delay = uartMs(payload.size() + 1);
+  } else if (!registered()) {
+    error = 331;  // No network service
+  } else if (failCount > 0) {
+    failCount--;
+    error = failCode;
+  } else if (settings.cmsErrorPercent > 0 && nextRandom() % 100 < settings.cmsErrorPercent) {
+    error = settings.cmsErrorCode;
+  }
+
+  Output out;
+  out.dueUs = mock::nowUs() + (uint64_t)delay * 1000;
+  char buffer[48];
+  if (error != 0) {
+    rejected++;
+    snprintf(buffer, sizeof(buffer), "\r\n+CMS ERROR: %d\r\n", error);
+    out.text = buffer;
+    out.confirms = false;
+  } else {
+    out.sms.number = cmgsNumber;
+    out.sms.payload = payload;
+    out.sms.pdu = pdu;
+    out.sms.reference = nextReference++;
+    out.sms.acceptedUs = out.dueUs;
+    snprintf(buffer, sizeof(buffer), "\r\n+CMGS: %u\r\n\r\nOK\r\n", out.sms.reference);
+    out.text = buffer;
+    out.confirms = true;
+  }
+  schedule(out);
+  payload.clear();
+}
+
+bool Sim800Emulator::deliverSms(const char* number, const char* text) {
+  if (!registered()) return false;
+
+  if (cnmiMt != 2) {
+    // Stored on the SIM; the device reads it back with AT+CMGR
+    int index = nextIndex++;
+    stored[index] = Stored{number, text};
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "\r\n+CMTI: \"SM\",%d\r\n", index);
+    reply(0, buffer);
+  } else if (pdu) {
+    size_t length = 0;
+    std::string hex = deliverPdu(number, text, &length);
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "\r\n+CMT: ,%u\r\n", (unsigned)length);
+    reply(0, buffer + hex + "\r\n");
+  } else {
+    reply(0, std::string("\r\n+CMT: \"") + number + "\",\"\",\"" + SCTS_TEXT + "\"" + textDetails(text) +
+             "\r\n" + text + "\r\n");
+  }
+  return true;
+}
+
+// ",<tooa>,<fo>,<pid>,<dcs>,<sca>,<tosca>,<length>" after a text-mode header
+std::string Sim800Emulator::textDetails(const std::string& text) const {
+  if (!csdh) return "";
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), ",145,4,0,0,\"+639170000000\",145,%u", (unsigned)text.size());
+  return buffer;
+}
+
+// GSM 03.38 septet for an ASCII character; the few without one become '?'
+static uint8_t gsm7Of(char c) {
+  switch (c) {
+    case '@': return 0x00;
+    case '$': return 0x02;
+    case '_': return 0x11;
+    case '`': case '[': case ']': case '{': case '}': case '\\': case '^': case '|': case '~':
+      return '?';
+    default:
+      return (c >= 0x20 && c < 0x7F) || c == '\n' || c == '\r' ? (uint8_t)c : '?';
+  }
+}
+
+std::string Sim800Emulator::deliverPdu(const char* number, const char* text, size_t* tpduLength) {
+  std::vector<uint8_t> tpdu;
+  tpdu.push_back(0x04);  // SMS-DELIVER, no more messages
+
+  bool international = number[0] == '+';
+  std::string digits = international ? number + 1 : number;
+  tpdu.push_back((uint8_t)digits.size());
+  tpdu.push_back(international ? 0x91 : 0x81);
+  for (size_t i = 0; i < digits.size(); i += 2) {
+    uint8_t low = digits[i] - '0';
+    uint8_t high = i + 1 < digits.size() ? digits[i + 1] - '0' : 0x0F;
+    tpdu.push_back((uint8_t)(high << 4 | low));
+  }
+  tpdu.push_back(0x00);  // PID
+  tpdu.push_back(0x00);  // DCS: GSM 7-bit
+  for (const char* s = SCTS_PDU; *s != '\0'; s += 2) {
+    tpdu.push_back((uint8_t)((s[0] - '0') << 4 | (s[1] - '0')));
+  }
+
+  size_t septets = strlen(text);
+  tpdu.push_back((uint8_t)septets);
+  uint32_t bits = 0;
+  uint8_t held = 0;
+  for (size_t i = 0; i < septets; i++) {
+    bits |= (uint32_t)gsm7Of(text[i]) << held;
+    held += 7;
+    while (held >= 8) {
+      tpdu.push_back((uint8_t)bits);
+      bits >>= 8;
+      held -= 8;
+    }
+  }
+  if (held > 0) tpdu.push_back((uint8_t)bits);
+
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  std::string hex = "00";  // No SMSC address
+  for (uint8_t b : tpdu) {
+    hex += HEX_DIGITS[b >> 4];
+    hex += HEX_DIGITS[b & 0x0F];
+  }
+  *tpduLength = tpdu.size();
+  return hex;
+}
+
+bool Sim800Emulator::validPdu(const std::string& hex, int tpduLength) {
+  if (hex.size() < 2 || hex.size() % 2 != 0 || tpduLength <= 0) return false;
+  for (char c : hex) {
+    if (!isxdigit((unsigned char)c)) return false;
+  }
+  // SMSC length octet, then the SMSC, then exactly tpduLength octets
+  int smscLength = (int)strtol(hex.substr(0, 2).c_str(), nullptr, 16);
+  return (int)hex.size() == 2 * (1 + smscLength + tpduLength);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file Sim800Emulator.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host emulator of a SIM800L on the other end of a mock HardwareSerial
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Speaks the AT subset the library uses: AT, ATE0/ATE1, AT+CPIN?, AT+CSQ,
+ * AT+CREG?, AT+CMGF, AT+CSDH, AT+CNMI, AT+CMGS (text and PDU), AT+CMGR, AT+CMGD,
+ * ATD and ATH, plus +CMT / +CMTI for incoming messages. Replies are due at
+ * a time on the virtual clock (MockHost.h) and reach the device the next
+ * time it reads the port, so the '>' prompt, the network and the SIM can
+ * be made slow, lossy or unregistered without real time passing.
+ */
+#ifndef SIM800_EMULATOR_H
+#define SIM800_EMULATOR_H
+
+#include "Arduino.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct Sim800Config {
+  uint32_t promptDelayMs = 20;       // AT+CMGS -> "> "
+  uint32_t networkLatencyMs = 3000;  // Upload done -> +CMGS or +CMS ERROR
+  uint32_t latencyJitterMs = 0;      // Uniform 0..jitter added to each send
+  uint8_t cmsErrorPercent = 0;       // Sends rejected at random
+  uint16_t cmsErrorCode = 500;       // "Unknown error"
+  uint8_t signal = 18;               // +CSQ RSSI
+  uint32_t seed = 1;
+};
+
+class Sim800Emulator {
+  public:
+    struct SentSms {
+      std::string number;   // Text mode only; PDU mode carries it in the PDU
+      std::string payload;  // Text, or the PDU in hex as sent
+      bool pdu;
+      uint8_t reference;    // +CMGS value
+      uint64_t acceptedUs;  // Virtual time of the +CMGS
+    };
+
+    Sim800Emulator(HardwareSerial* port, const Sim800Config& config = Sim800Config());
+    ~Sim800Emulator();
+
+    // Settings may be changed at any time; they apply to the next command
+    Sim800Config& config() { return settings; }
+
+    // Network registration. While it is lost, sends fail with +CMS ERROR: 331
+    // and calls with NO CARRIER.
+    void setRegistered(bool registered);
+    void loseRegistrationFor(uint32_t ms);
+    bool registered();
+
+    // Reject the next `count` sends with `code`, whatever the error rate
+    void failNext(uint16_t count, uint16_t code = 500);
+
+    // A message from `number` arrives: pushed as +CMT or stored and
+    // announced with +CMTI, depending on AT+CNMI. False while unregistered.
+    bool deliverSms(const char* number, const char* text);
+
+    // Take what the device wrote, release replies that are due. The port
+    // calls this whenever the device reads it.
+    void service();
+
+    const std::vector<SentSms>& sent() const { return accepted; }
+    const std::vector<std::string>& dialed() const { return calls; }
+    const std::string& lastCommand() const { return last; }
+    uint32_t commandCount() const { return commands; }
+    uint32_t rejectedCount() const { return rejected; }
+    bool pduMode() const { return pdu; }
+    bool echoOn() const { return echo; }
+    size_t storedCount() const { return stored.size(); }
+
+  private:
+    struct Output {
+      uint64_t dueUs;
+      std::string text;
+      bool confirms;  // Moves `sms` to accepted when released
+      SentSms sms;
+    };
+    struct Stored {
+      std::string number;
+      std::string text;
+    };
+
+    HardwareSerial* port;
+    Sim800Config settings;
+    uint32_t random;
+
+    std::string line;
+    bool inPayload;
+    std::string payload;
+    std::string cmgsNumber;
+    int cmgsLength;
+
+    bool echo;
+    bool pdu;
+    bool csdh;      // Text-mode headers end with the SMS details and <length>
+    int cnmiMt;
+    bool onNetwork;
+    uint64_t regainAtUs;  // 0 = no timed outage
+    uint16_t failCount;
+    uint16_t failCode;
+    uint8_t nextReference;
+    int nextIndex;
+
+    std::vector<Output> outputs;  // Ordered by dueUs
+    std::map<int, Stored> stored;
+    std::vector<SentSms> accepted;
+    std::vector<std::string> calls;
+    std::string last;
+    uint32_t commands;
+    uint32_t rejected;
+
+    static void onActivity(HardwareSerial* port, void* ctx);
+    void receive(uint8_t c);
+    void command(const std::string& cmd);
+    void submit();
+    std::string textDetails(const std::string& text) const;
+    void reply(uint32_t delayMs, const std::string& text);
+    void schedule(const Output& output);
+    uint32_t uartMs(size_t bytes) const;
+    uint32_t nextRandom();
+    static std::string deliverPdu(const char* number, const char* text, size_t* tpduLength);
+    static bool validPdu(const std::string& hex, int tpduLength);
+};
+
+#endif
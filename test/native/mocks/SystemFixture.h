@@ -0,0 +1,47 @@
+/**
+ * @file SystemFixture.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Boot and power-cycle helpers for the suites that run a whole FingerprintGSM
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Header only: the mocks library does not build against Fingerprint_GSM.
+ */
+#ifndef SYSTEM_FIXTURE_H
+#define SYSTEM_FIXTURE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <MockHost.h>
+#include <Preferences.h>
+#include "Fingerprint_GSM.h"
+
+namespace mock {
+
+// Power cut: the old system goes away, what it wrote to NVS, files and
+// partitions stays for the new one
+inline void powerCycle(FingerprintGSM*& system, HardwareSerial* fpSerial, HardwareSerial* gsmSerial) {
+  delete system;
+  system = new FingerprintGSM(fpSerial, gsmSerial);
+}
+
+// A new board: clock, pins, NVS, files and both serial lines start blank.
+// Partitions are left to the suite, which creates the ones it needs.
+inline void freshBoot(FingerprintGSM*& system, HardwareSerial* fpSerial, HardwareSerial* gsmSerial) {
+  delete system;
+  system = nullptr;
+  reset();
+  nvsErase();
+  fsErase();
+  fpSerial->rx.clear();
+  fpSerial->tx.clear();
+  gsmSerial->rx.clear();
+  gsmSerial->tx.clear();
+  system = new FingerprintGSM(fpSerial, gsmSerial);
+}
+
+}  // namespace mock
+
+#endif
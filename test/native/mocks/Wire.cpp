@@ -0,0 +1,12 @@
+/**
+ * @file Wire.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the Wire (I2C) library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "Wire.h"
+TwoWire Wire;
@@ -0,0 +1,19 @@
+/**
+ * @file Wire.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the Wire (I2C) library
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef WIRE_MOCK_H
+#define WIRE_MOCK_H
+#include "Arduino.h"
+class TwoWire {
+  public:
+    bool begin(int sda = -1, int scl = -1, uint32_t freq = 0) { (void)sda; (void)scl; (void)freq; return true; }
+};
+extern TwoWire Wire;
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file esp_partition.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the ESP-IDF partition API
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "esp_partition.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <string.h>
+
+namespace {
+struct Part { esp_partition_t info; std::vector<uint8_t> data; std::vector<uint32_t> erases; };
+std::map<std::string, Part>& parts() { static std::map<std::string, Part> p; return p; }
+uint32_t g_written = 0;
+uint32_t g_read = 0;
+Part* of(const esp_partition_t* p) { auto it = parts().find(p->label); return it == parts().end() ? nullptr : &it->second; }
+}
+
+namespace mock {
+void partitionCreate(const char* label, uint8_t subtype, uint32_t size) {
+  Part& p = parts()[label];
+  memset(&p.info, 0, sizeof(p.info));
+  p.info.type = ESP_PARTITION_TYPE_DATA;
+  p.info.subtype = (esp_partition_subtype_t)subtype;
+  p.info.size = size;
+  strncpy(p.info.label, label, 16);
+  p.data.assign(size, 0xFF);
+  p.erases.assign(size / SPI_FLASH_SEC_SIZE, 0);
+}
+uint32_t partitionErases(const char* label, uint32_t sector) { return parts()[label].erases[sector]; }
+uint32_t partitionBytesWritten() { return g_written; }
+uint32_t partitionBytesRead() { return g_read; }
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label) {
+  for (auto& kv : parts()) {
+    Part& p = kv.second;
+    if (p.info.type != type) continue;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.info.subtype != subtype) continue;
+    if (label && kv.first != label) continue;
+    return &p.info;
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t offset, void* dst, size_t size) {
+  Part* part = of(p);
+  if (!part || offset + size > part->data.size()) return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, &part->data[offset], size);
+  g_read += size;
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t offset, const void* src, size_t size) {
+  Part* part = of(p);
+  if (!part || offset + size > part->data.size()) return ESP_ERR_INVALID_SIZE;
+  const uint8_t* s = (const uint8_t*)src;
+  for (size_t i = 0; i < size; i++) part->data[offset + i] &= s[i];
+  g_written += size;
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t offset, size_t size) {
+  Part* part = of(p);
+  if (!part || offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE || offset + size > part->data.size())
+    return ESP_ERR_INVALID_ARG;
+  memset(&part->data[offset], 0xFF, size);
+  for (size_t s = offset / SPI_FLASH_SEC_SIZE; s < (offset + size) / SPI_FLASH_SEC_SIZE; s++) part->erases[s]++;
+  return ESP_OK;
+}
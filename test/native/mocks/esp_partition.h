@@ -0,0 +1,49 @@
+/**
+ * @file esp_partition.h
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host stand-in for the ESP-IDF partition API
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * NOR flash semantics: writes can only clear bits, erase sets a whole 4 KB
+ * sector to 0xFF.
+ */
+#ifndef ESP_PARTITION_MOCK_H
+#define ESP_PARTITION_MOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_SIZE 0x104
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0x00, ESP_PARTITION_TYPE_DATA = 0x01 } esp_partition_type_t;
+typedef enum { ESP_PARTITION_SUBTYPE_ANY = 0xff } esp_partition_subtype_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  esp_partition_subtype_t subtype;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+  bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t offset, size_t size);
+
+namespace mock {
+void partitionCreate(const char* label, uint8_t subtype, uint32_t size);
+uint32_t partitionErases(const char* label, uint32_t sector);  // Erase count per sector
+uint32_t partitionBytesWritten();
+uint32_t partitionBytesRead();
+}
+#endif
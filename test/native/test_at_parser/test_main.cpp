@@ -0,0 +1,96 @@
+/**
+ * @file test_main.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief AtParser on recorded SIM800L output
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Each test pushes a byte stream as the modem would send it and checks the
+ * sequence of responses. The SMS cases carry text that reads like result
+ * codes: it must come back as one AT_CODE_SMS_BODY and nothing else.
+ */
+#include <unity.h>
+#include <string.h>
+#include "AtParser.h"
+
+// Parse `stream` and compare the response codes with `expected`
+static void expectCodes(AtParser& parser, const char* stream, const AtCode* expected, uint8_t count,
+                        const char* body = nullptr) {
+  for (const char* c = stream; *c != '\0'; c++) TEST_ASSERT_TRUE(parser.push((uint8_t)*c));
+  AtResponse response;
+  for (uint8_t i = 0; i < count; i++) {
+    TEST_ASSERT_TRUE(parser.next(response));
+    TEST_ASSERT_EQUAL_UINT8(expected[i], response.code);
+    if (response.code == AT_CODE_SMS_BODY && body != nullptr) TEST_ASSERT_EQUAL_STRING(body, response.line);
+  }
+  TEST_ASSERT_FALSE(parser.next(response));
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_text_body_with_blank_line() {
+  AtParser parser;
+  parser.setTextMode(true);
+  // "hi", a blank line, then "OK": 6 characters by the header
+  const char stream[] =
+    "\r\n+CMGR: \"REC UNREAD\",\"+639170000001\",\"\",\"25/11/28,07:15:42+32\",145,4,0,0,\"+639170000000\",145,6\r\n"
+    "hi\n\nOK\r\n"
+    "\r\nOK\r\n";
+  const AtCode expected[] = {AT_CODE_CMGR, AT_CODE_SMS_BODY, AT_CODE_OK};
+  expectCodes(parser, stream, expected, 3, "hi\n\nOK");
+}
+
+void test_text_body_like_cmgs() {
+  AtParser parser;
+  parser.setTextMode(true);
+  parser.armPrompt(true);
+  const char stream[] =
+    "\r\n+CMT: \"+639170000001\",\"\",\"25/11/28,07:15:42+32\",145,4,0,0,\"+639170000000\",145,21\r\n"
+    "> x\r\n\r\n+CMGS: 5\r\n\r\nOK\r\n";
+  const AtCode expected[] = {AT_CODE_CMT, AT_CODE_SMS_BODY};
+  expectCodes(parser, stream, expected, 2, "> x\r\n\r\n+CMGS: 5\r\n\r\nOK");
+}
+
+void test_text_empty_body() {
+  AtParser parser;
+  parser.setTextMode(true);
+  const char stream[] =
+    "\r\n+CMT: \"+639170000001\",\"\",\"25/11/28,07:15:42+32\",145,4,0,0,\"+639170000000\",145,0\r\n"
+    "\r\n\r\nOK\r\n";
+  const AtCode expected[] = {AT_CODE_CMT, AT_CODE_SMS_BODY, AT_CODE_OK};
+  expectCodes(parser, stream, expected, 3, "");
+}
+
+void test_pdu_body_is_one_line() {
+  AtParser parser;
+  const char stream[] =
+    "\r\n+CMT: ,23\r\n"
+    "07916407058099F9040B916407281553F80000521182700000230AE8329BFD4697D9EC37\r\n"
+    "\r\nOK\r\n";
+  const AtCode expected[] = {AT_CODE_CMT, AT_CODE_SMS_BODY, AT_CODE_OK};
+  expectCodes(parser, stream, expected, 3);
+}
+
+void test_result_codes() {
+  AtParser parser;
+  const char stream[] =
+    "\r\n+CSQ: 18,0\r\n\r\nOK\r\n"
+    "\r\n+CMS ERROR: 331\r\n"
+    "\r\n+CMTI: \"SM\",3\r\n"
+    "\r\nOKAY\r\n";
+  const AtCode expected[] = {AT_CODE_CSQ, AT_CODE_OK, AT_CODE_CMS_ERROR, AT_CODE_CMTI, AT_CODE_LINE};
+  expectCodes(parser, stream, expected, 5);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_text_body_with_blank_line);
+  RUN_TEST(test_text_body_like_cmgs);
+  RUN_TEST(test_text_empty_body);
+  RUN_TEST(test_pdu_body_is_one_line);
+  RUN_TEST(test_result_codes);
+  return UNITY_END();
+}
@@ -0,0 +1,372 @@
+/**
+ * @file test_main.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief Host microbenchmarks: access events, message formatting, AT parsing, user lookup, LCD rendering
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Run with `pio test -e native -v`. Every benchmark prints one line
+ *   [BENCH] <name> <ns>/op <allocations>/op
+ * so runs can be diffed. Times are host times and only comparable with
+ * earlier runs on the same machine. Allocations are counted through the
+ * global operator new and match the board, where the library never calls
+ * malloc directly; the hot paths are asserted to allocate nothing.
+ */
+#include <unity.h>
+#include <chrono>
+#include <new>
+#include <Arduino.h>
+#include <MockHost.h>
+#include <Sim800Emulator.h>
+#include <esp_partition.h>
+#include <LiquidCrystal_I2C.h>
+#include "AtParser.h"
+#include "AttendanceLog.h"
+#include "Fingerprint_GSM.h"
+#include "LcdCompositor.h"
+#include "LcdFrame.h"
+#include "SmsOutbox.h"
+#include "SmsPdu.h"
+#include "TextBuffer.h"
+
+// ----------------------
+// ALLOCATION COUNTING
+// ----------------------
+static uint64_t allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  allocations++;
+  return malloc(size == 0 ? 1 : size);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ----------------------
+// HARNESS
+// ----------------------
+struct BenchResult {
+  double nsPerOp;
+  uint64_t allocations;  // Over all timed ops
+};
+
+// Results flow here so the optimizer cannot drop a benchmark body
+static volatile uint32_t sink = 0;
+
+static BenchResult report(const char* name, double ns, uint64_t allocated, double ops) {
+  BenchResult result;
+  result.nsPerOp = ns / ops;
+  result.allocations = allocated;
+  printf("[BENCH] %-28s %10.1f ns/op %8.2f allocs/op\n", name, result.nsPerOp,
+         (double)result.allocations / ops);
+  return result;
+}
+
+// Run `body(i)` for i in 0..calls-1 after a short warm-up. Each call does
+// `opsPerCall` operations (several parsed responses, say).
+template <typename Body>
+static BenchResult bench(const char* name, uint32_t calls, uint32_t opsPerCall, Body body) {
+  for (uint32_t i = 0; i < calls / 10 + 1; i++) body(i);
+
+  uint64_t allocationsBefore = allocations;
+  auto started = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < calls; i++) body(i);
+  auto elapsed = std::chrono::steady_clock::now() - started;
+  return report(name, std::chrono::duration<double, std::nano>(elapsed).count(),
+                allocations - allocationsBefore, (double)calls * opsPerCall);
+}
+
+// ----------------------
+// FIXTURES
+// ----------------------
+static const uint16_t BENCH_USERS = 300;
+static const char* const ADMIN = "+639170000001";
+
+static HardwareSerial fpSerial(2);
+static HardwareSerial gsmSerial(1);
+static FingerprintGSM* system_ = nullptr;
+static Sim800Emulator* modem_ = nullptr;
+static char phones[BENCH_USERS + 1][USER_PHONE_MAX];
+
+static void setupSystem() {
+  if (system_ != nullptr) return;
+  mock::partitionCreate("users", 0x41, 0x60000);
+  mock::partitionCreate("gatelog", 0x40, 0x60000);
+  mock::partitionCreate("outbox", 0x42, 0x8000);
+  // A quick modem, so the outbox drains between measured batches
+  Sim800Config config;
+  config.promptDelayMs = 1;
+  config.networkLatencyMs = 5;
+  modem_ = new Sim800Emulator(&gsmSerial, config);
+  system_ = new FingerprintGSM(&fpSerial, &gsmSerial);
+  system_->setPduMode(true);
+  system_->setAdminPhone(ADMIN);
+  system_->beginLCD(0x27, 16, 2);
+  TEST_ASSERT_TRUE(system_->beginUsers("users"));
+  TEST_ASSERT_TRUE(system_->beginLog("gatelog"));
+
+  char name[USER_NAME_MAX];
+  for (uint16_t id = 1; id <= BENCH_USERS; id++) {
+    snprintf(name, sizeof(name), "Student %03u Dela Cruz", id);
+    snprintf(phones[id], sizeof(phones[id]), "+6391712%05u", id);
+    TEST_ASSERT_TRUE(system_->addUser(id, name, phones[id], true, "Grade 7"));
+  }
+  TEST_ASSERT_TRUE(system_->beginPresence(BENCH_USERS + 1));
+  TEST_ASSERT_TRUE(system_->beginGSM(9600, 16, 17));
+}
+
+// Let the GSM side send everything queued so far (not timed)
+static void drainOutbox() {
+  while (system_->getOutbox()->size() > 0) {
+    system_->poll();
+    mock::advanceUs(1000);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ----------------------
+// ACCESS EVENT
+// ----------------------
+// What the tasks do for one granted scan: the LCD toast, the log record, the
+// presence bit and both SMS (admin and student) formatted into the outbox
+static void accessEvent(uint16_t id) {
+  UserData user;
+  if (system_->getUser(id, user)) system_->lcdShowAccessGranted(user.name);
+  system_->logAccess(id, true);
+  system_->getPresence()->mark(id, millis() / 1000);  // currentEpoch() without an RTC
+  system_->sendAccessNotification(id, true);
+}
+
+void test_access_event() {
+  setupSystem();
+  // Two SMS per event: batches stay well inside the outbox and the log stage
+  const uint32_t batches = 300;
+  const uint8_t perBatch = 8;
+  for (uint8_t k = 0; k < perBatch; k++) accessEvent(1 + k);
+
+  double ns = 0;
+  uint64_t allocated = 0;
+  for (uint32_t b = 0; b < batches; b++) {
+    drainOutbox();
+    uint64_t allocationsBefore = allocations;
+    auto started = std::chrono::steady_clock::now();
+    for (uint8_t k = 0; k < perBatch; k++) accessEvent(1 + (b * perBatch + k) * 37 % BENCH_USERS);
+    ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    allocated += allocations - allocationsBefore;
+  }
+  drainOutbox();
+
+  BenchResult r = report("access.event", ns, allocated, (double)batches * perBatch);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getOutbox()->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(2 * (batches + 1) * perBatch, (uint32_t)modem_->sent().size());
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+// ----------------------
+// MESSAGE FORMATTING
+// ----------------------
+void test_format_access_granted_string() {
+  // The String concatenation TextBuffer replaced in access.event, for comparison only
+  String name = "Juan Dela Cruz";
+  String stamp = "11/28/2025 07:15:42";
+  bench("format.access_granted_String", 200000, 1, [&](uint32_t i) {
+    String message = "ACCESS GRANTED\nUser: " + name + "\nID: " + String((i & 0xFF) + 1) + "\nTime: " + stamp;
+    sink = sink + message.length();
+  });
+}
+
+void test_format_pdu() {
+  const char* message = "ACCESS GRANTED\nUser: Juan Dela Cruz\nID: 42\nTime: 11/28/2025 07:15:42";
+  char hex[400];
+  uint8_t length = 0;
+  BenchResult r = bench("format.pdu_encode", 100000, 1, [&](uint32_t i) {
+    length = smsEncodePdu("+639171234567", message, 0, 1, (uint8_t)i, hex, sizeof(hex));
+    sink = sink + length;
+  });
+  TEST_ASSERT_TRUE(length > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+// ----------------------
+// AT PARSING
+// ----------------------
+// Echo, signal query, a sent SMS, a stored-SMS notice and a pushed SMS
+static const char AT_STREAM[] =
+  "AT+CSQ\r\r\n+CSQ: 18,0\r\n\r\nOK\r\n"
+  "\r\n+CMGS: 42\r\n\r\nOK\r\n"
+  "\r\n+CMTI: \"SM\",3\r\n"
+  "\r\n+CMT: \"+639171234567\",\"\",\"25/11/28,07:15:42+32\"\r\nSTATUS\r\n";
+
+static uint32_t parseStream(AtParser& parser) {
+  for (const char* c = AT_STREAM; *c != '\0'; c++) parser.push((uint8_t)*c);
+  AtResponse response;
+  uint32_t responses = 0;
+  while (parser.next(response)) responses++;
+  return responses;
+}
+
+void test_at_parse() {
+  AtParser parser;
+  uint32_t responses = parseStream(parser);
+  TEST_ASSERT_TRUE(responses >= 7);
+  TEST_ASSERT_TRUE(sizeof(AT_STREAM) < AtParser::RING_SIZE);
+
+  BenchResult r = bench("at.parse_response", 100000, responses, [&](uint32_t) {
+    sink = sink + parseStream(parser);
+  });
+  TEST_ASSERT_EQUAL_UINT32(0, parser.overflowCount());
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+// ----------------------
+// USER LOOKUP
+// ----------------------
+void test_get_user_cached() {
+  setupSystem();
+  UserData user;
+  // A student scanning again: well inside the RAM cache
+  BenchResult r = bench("user.getUser_cached", 200000, 1, [&](uint32_t i) {
+    sink = sink + system_->getUser(1 + (i & 3), user);
+  });
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+void test_get_user_flash() {
+  setupSystem();
+  UserData user;
+  // Stride through every user so the cache misses and the record is read
+  BenchResult r = bench("user.getUser_flash", 100000, 1, [&](uint32_t i) {
+    sink = sink + system_->getUser(1 + (i * 37) % BENCH_USERS, user);
+  });
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+void test_find_by_phone() {
+  setupSystem();
+  uint16_t ids[4];
+  BenchResult r = bench("user.findByPhone", 100000, 1, [&](uint32_t i) {
+    sink = sink + system_->findUsersByPhone(phones[1 + (i * 37) % BENCH_USERS], ids, 4);
+  });
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+void test_display_user() {
+  setupSystem();
+  UserData user;
+  // What a granted scan puts on screen: look the student up, show the toast
+  BenchResult r = bench("display.user", 50000, 1, [&](uint32_t i) {
+    if (system_->getUser(1 + (i * 37) % BENCH_USERS, user)) system_->lcdShowAccessGranted(user.name);
+  });
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+// ----------------------
+// LOG LOOKUP
+// ----------------------
+// Every record of `userId`, oldest first
+static uint32_t findAll(AttendanceLog& log, uint16_t userId) {
+  AccessLog record;
+  uint32_t found = 0;
+  for (uint32_t i = log.findUser(userId, 0, log.count(), record); i != AttendanceLog::NOT_FOUND;
+       i = log.findUser(userId, i + 1, log.count(), record)) {
+    found++;
+  }
+  return found;
+}
+
+void test_log_find_user() {
+  // 20 school days of 399 students, plus one who came on two of them
+  mock::partitionCreate("attlog", 0x40, 0x60000);
+  AttendanceLog log;
+  TEST_ASSERT_TRUE(log.begin("attlog"));
+  uint32_t epoch = 1764288000UL;  // 2025-11-28 00:00
+  for (uint16_t day = 0; day < 20; day++) {
+    for (uint16_t i = 0; i < 400; i++) {
+      uint16_t id = 1 + (i * 37 + day) % 399;
+      if (i == 200 && (day == 5 || day == 15)) id = 400;
+      log.append(epoch + day * 86400UL + 25200 + i * 6, id, ACCESS_GRANTED);
+      if (log.stagedCount() >= AttendanceLog::STAGE_SIZE / 2) log.poll();
+    }
+  }
+  log.poll();
+  TEST_ASSERT_TRUE(log.sectorCount() > 0);
+
+  // Sectors without the student cost one bitmap byte each
+  uint32_t readBefore = mock::partitionBytesRead();
+  TEST_ASSERT_EQUAL_UINT32(2, findAll(log, 400));
+  uint32_t bytesRead = mock::partitionBytesRead() - readBefore;
+  TEST_ASSERT_TRUE(bytesRead <= 2U * AttendanceLog::SECTOR_SIZE + log.sectorCount());
+
+  BenchResult r = bench("log.findUser_rare", 2000, 1, [&](uint32_t) {
+    sink = sink + findAll(log, 400);
+  });
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+// ----------------------
+// LCD RENDERING
+// ----------------------
+void test_lcd_clock() {
+  LiquidCrystal_I2C lcd(0x27, 20, 4);
+  lcd.init();
+  LcdFrame frame(&lcd, 20, 4);
+  LcdCompositor screens(&frame, &lcd, 20, 4);
+  char clock[12];
+  // The idle screen: one second passes, a digit or two change
+  BenchResult r = bench("lcd.clock_tick", 100000, 1, [&](uint32_t i) {
+    snprintf(clock, sizeof(clock), "07:%02u:%02u", (unsigned)(i / 60 % 60), (unsigned)(i % 60));
+    screens.setBaseLine(0, clock);
+    mock::advanceUs(1000000);
+    screens.tick();
+  });
+  sink = sink + lcd.lcdBytes;
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+void test_lcd_redraw() {
+  LiquidCrystal_I2C lcd(0x27, 20, 4);
+  lcd.init();
+  LcdFrame frame(&lcd, 20, 4);
+  LcdCompositor screens(&frame, &lcd, 20, 4);
+  // Alternating result screens rewrite most of the display
+  BenchResult r = bench("lcd.toast_redraw", 100000, 1, [&](uint32_t i) {
+    if (i & 1) screens.toast(3000, "ACCESS GRANTED", "Juan Dela Cruz", "07:15:42", nullptr, true);
+    else screens.toast(3000, "ACCESS DENIED", "Unknown finger", "Try again", nullptr, true);
+  });
+  sink = sink + lcd.lcdBytes;
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)r.allocations);
+}
+
+int main(int argc, char** argv) {
+  // The library logs to Serial; keeping that output would time the mock.
+  // gsmSerial keeps its output for the modem emulator.
+  Serial.captureTx = false;
+  fpSerial.captureTx = false;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_access_event);
+  RUN_TEST(test_format_access_granted_string);
+  RUN_TEST(test_format_pdu);
+  RUN_TEST(test_at_parse);
+  RUN_TEST(test_get_user_cached);
+  RUN_TEST(test_get_user_flash);
+  RUN_TEST(test_find_by_phone);
+  RUN_TEST(test_display_user);
+  RUN_TEST(test_log_find_user);
+  RUN_TEST(test_lcd_clock);
+  RUN_TEST(test_lcd_redraw);
+  return UNITY_END();
+}
@@ -0,0 +1,342 @@
+/**
+ * @file test_main.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief End-to-end gate-rush load test: sensor, modem, RTC and LCD together
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * One FingerprintGSM runs the sketch loop (poll, clock, scan, show, log,
+ * notify) against R30xEmulator, Sim800Emulator and the RTC and LCD
+ * stand-ins, with I2C bus time charged at 100 kHz. Students arrive at
+ * random, queue for the sensor, hold their finger until their name is on
+ * the LCD and step away. Each run prints
+ *   [GATE] <students>/min admitted, touch -> LCD p50/p95/p99, queue depths
+ * and fails when a number misses its budget. Budgets can be overridden
+ * from build_flags, e.g. -D GATE_BUDGET_P99_MS=1500.
+ */
+#include <unity.h>
+#include <algorithm>
+#include <deque>
+#include <math.h>
+#include <vector>
+#include <Arduino.h>
+#include <MockHost.h>
+#include <LiquidCrystal_I2C.h>
+#include <R30xEmulator.h>
+#include <RTClib.h>
+#include <Sim800Emulator.h>
+#include <SystemFixture.h>
+#include <esp_partition.h>
+#include "AttendanceState.h"
+#include "Fingerprint_GSM.h"
+
+// ----------------------
+// BUDGETS
+// ----------------------
+#ifndef GATE_BUDGET_RUSH_PER_MIN
+#define GATE_BUDGET_RUSH_PER_MIN 19.0   // Admitted/min while 20/min arrive
+#endif
+#ifndef GATE_BUDGET_CAPACITY_PER_MIN
+#define GATE_BUDGET_CAPACITY_PER_MIN 30.0  // Admitted/min with a standing queue
+#endif
+#ifndef GATE_BUDGET_P50_MS
+#define GATE_BUDGET_P50_MS 1000
+#endif
+#ifndef GATE_BUDGET_P99_MS
+#define GATE_BUDGET_P99_MS 2000
+#endif
+#ifndef GATE_BUDGET_MAX_WAITING
+#define GATE_BUDGET_MAX_WAITING 12      // Students in line during the rush
+#endif
+#ifndef GATE_BUDGET_MAX_OUTBOX
+#define GATE_BUDGET_MAX_OUTBOX 16       // Of SmsOutbox::capacity(), 48 here
+#endif
+
+// ----------------------
+// FIXTURES
+// ----------------------
+static const char* const ADMIN = "+639170000001";
+static const uint16_t STUDENTS = 400;
+static const uint32_t I2C_BYTE_US = 90;       // 100 kHz
+static const uint32_t STEP_MS = 600;          // Next student reaches the sensor
+static const uint32_t REACTION_MS = 300;      // Name on the LCD -> finger lifted
+static const uint32_t GIVE_UP_MS = 6000;      // Lift and try again
+static const uint32_t MAX_HOLD_MS = 60000;    // Touches end with lift()
+// Guardians who asked for an SMS at every scan. With the admin digest this
+// is what one modem at ~3 s per message keeps up with during the rush.
+static const uint8_t GUARDIAN_SMS_PERCENT = 25;
+
+static HardwareSerial fpSerial(2);
+static HardwareSerial gsmSerial(1);
+static FingerprintGSM* system_ = nullptr;
+static R30xEmulator* sensor_ = nullptr;
+static Sim800Emulator* modem_ = nullptr;
+static AttendanceState* attendance_ = nullptr;
+
+static void boot(uint8_t falseRejectPercent) {
+  mock::freshBoot(system_, &fpSerial, &gsmSerial);
+  mock::partitionCreate("users", 0x41, 0x60000);
+  mock::partitionCreate("attlog", 0x40, 0x60000);
+  mock::partitionCreate("outbox", 0x42, 0x8000);
+  mock::setRtc(DateTime(2025, 11, 28, 6, 30, 0));
+
+  R30xConfig sensorConfig;
+  sensorConfig.falseRejectPercent = falseRejectPercent;
+  delete sensor_;
+  sensor_ = new R30xEmulator(&fpSerial, sensorConfig);
+  sensor_->enrollRange(1, STUDENTS);
+  delete modem_;
+  modem_ = new Sim800Emulator(&gsmSerial, Sim800Config());
+  delete attendance_;
+  attendance_ = new AttendanceState(STUDENTS + 1);
+  attendance_->setCooldown(10000);
+
+  TEST_ASSERT_TRUE(system_->beginLCD(0x27, 16, 2));
+  TEST_ASSERT_TRUE(system_->beginRTC());
+  TEST_ASSERT_TRUE(system_->beginFingerprint(57600, 16, 17));
+  TEST_ASSERT_TRUE(system_->beginUsers("users"));
+  char name[USER_NAME_MAX];
+  char phone[USER_PHONE_MAX];
+  for (uint16_t id = 1; id <= STUDENTS; id++) {
+    snprintf(name, sizeof(name), "Student %03u", id);
+    snprintf(phone, sizeof(phone), "+6391712%05u", id);
+    bool notify = id % 100 < GUARDIAN_SMS_PERCENT;
+    TEST_ASSERT_TRUE(system_->addUser(id, name, phone, notify, "Grade 7"));
+  }
+  TEST_ASSERT_TRUE(system_->beginLog("attlog"));
+  TEST_ASSERT_TRUE(system_->beginPresence(STUDENTS + 1));
+  system_->setAdminPhone(ADMIN);
+  system_->setPduMode(true);
+  system_->setDigestMode(true, 300000, 12);
+  TEST_ASSERT_TRUE(system_->beginGSM(9600, 16, 17));
+  system_->setShowTimeOnLCD(true);
+  mock::setI2cByteUs(I2C_BYTE_US);
+}
+
+// One pass of the sketch's loop(), as the tasks would run it
+static void gateLoop() {
+  system_->poll();
+  system_->lcdUpdateTime();
+  int id = system_->verifyFingerprint();
+  if (id > 0) {
+    // The finger is still down for the next scan: admit it once
+    if (attendance_->decide(id, millis()) == SCAN_DUPLICATE) return;
+    UserData user;
+    if (system_->getUser(id, user)) system_->lcdShowAccessGranted(user.name);
+    system_->logAccess(id, true);
+    system_->sendAccessNotification(id, true);
+  } else if (id == -2) {
+    system_->lcdShowAccessDenied();
+    system_->logAccess(0, false);
+  }
+}
+
+// ----------------------
+// STUDENTS
+// ----------------------
+// Arrivals and the one student at the sensor, driven by the virtual clock
+// (a mock ticker) so touches and lifts land between sensor packets.
+struct Gate {
+  std::vector<uint64_t> arrivalUs;   // Per student, in arrival order
+  std::vector<uint16_t> order;       // Student ids in arrival order
+  size_t arrived;
+  std::deque<size_t> line;           // Indexes into order
+  size_t maxWaiting;
+
+  bool atSensor;
+  size_t current;
+  uint64_t firstTouchUs;
+  uint64_t touchUs;
+  uint64_t liftAtUs;                 // 0 until the student saw their name
+  uint64_t freeAtUs;                 // The next student can step up
+  char expected[17];
+
+  std::vector<uint32_t> latencyUs;   // First touch -> name on the LCD
+  uint32_t retries;
+  uint64_t lastAdmittedUs;
+};
+
+static Gate gate;
+
+// Result toasts are centred
+static bool nameShown(const char* name) {
+  LiquidCrystal_I2C* lcd = mock::lastLcd();
+  if (lcd->rowText(0).find("ACCESS GRANTED") == std::string::npos) return false;
+  return lcd->rowText(1).find(name) != std::string::npos;
+}
+
+static void onGateTick(uint64_t nowUs, void* ctx) {
+  Gate& g = *static_cast<Gate*>(ctx);
+  while (g.arrived < g.order.size() && g.arrivalUs[g.arrived] <= nowUs) {
+    g.line.push_back(g.arrived++);
+    g.maxWaiting = std::max(g.maxWaiting, g.line.size());
+  }
+
+  if (g.atSensor) {
+    if (g.liftAtUs == 0 && nameShown(g.expected)) {
+      g.latencyUs.push_back((uint32_t)(nowUs - g.firstTouchUs));
+      g.lastAdmittedUs = nowUs;
+      g.liftAtUs = nowUs + REACTION_MS * 1000ULL;
+    }
+    if (g.liftAtUs != 0 && nowUs >= g.liftAtUs) {
+      sensor_->lift();
+      g.atSensor = false;
+      g.freeAtUs = nowUs + STEP_MS * 1000ULL;
+    } else if (g.liftAtUs == 0 && nowUs >= g.touchUs + GIVE_UP_MS * 1000ULL) {
+      // Not recognised: lift and press again
+      sensor_->lift();
+      sensor_->touch(R30xEmulator::fingerFor(g.order[g.current]), MAX_HOLD_MS, 200);
+      g.touchUs = nowUs + 200000;
+      g.retries++;
+    }
+    return;
+  }
+
+  if (!g.line.empty() && nowUs >= g.freeAtUs) {
+    g.current = g.line.front();
+    g.line.pop_front();
+    uint16_t id = g.order[g.current];
+    snprintf(g.expected, sizeof(g.expected), "Student %03u", id);
+    sensor_->touch(R30xEmulator::fingerFor(id), MAX_HOLD_MS);
+    g.atSensor = true;
+    g.firstTouchUs = nowUs;
+    g.touchUs = nowUs;
+    g.liftAtUs = 0;
+  }
+}
+
+// `count` students: spread over `windowMs` as a Poisson process, or all
+// waiting at the start when windowMs is 0
+static void scheduleStudents(uint16_t count, uint32_t windowMs, uint32_t seed) {
+  gate = Gate();
+  for (uint16_t id = 1; id <= count; id++) gate.order.push_back(id);
+  uint32_t state = seed;
+  auto uniform = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state + 0.5) / 4294967296.0;
+  };
+  for (size_t i = count - 1; i > 0; i--) std::swap(gate.order[i], gate.order[(size_t)(uniform() * (i + 1))]);
+
+  uint64_t at = mock::nowUs();
+  double meanUs = windowMs * 1000.0 / count;
+  for (uint16_t i = 0; i < count; i++) {
+    if (windowMs > 0) at += (uint64_t)(-log(uniform()) * meanUs);
+    gate.arrivalUs.push_back(at);
+  }
+  mock::addTicker(onGateTick, &gate);
+}
+
+struct GateReport {
+  double admittedPerMin;
+  uint32_t p50Ms;
+  uint32_t p95Ms;
+  uint32_t p99Ms;
+  uint32_t maxMs;
+  size_t maxWaiting;
+  uint16_t maxOutbox;
+  uint8_t maxLogStaged;
+};
+
+static uint32_t percentileMs(std::vector<uint32_t> sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = (size_t)ceil(p * sorted.size()) - 1;
+  return sorted[std::min(index, sorted.size() - 1)] / 1000;
+}
+
+static GateReport runGate(const char* label, uint32_t timeoutMs) {
+  GateReport report;
+  report.maxOutbox = 0;
+  report.maxLogStaged = 0;
+  uint64_t started = mock::nowUs();
+  uint64_t end = started + (uint64_t)timeoutMs * 1000;
+  while (mock::nowUs() < end && gate.latencyUs.size() < gate.order.size()) {
+    gateLoop();
+    report.maxOutbox = std::max(report.maxOutbox, system_->getOutbox()->size());
+    report.maxLogStaged = std::max(report.maxLogStaged, system_->getAccessLog()->stagedCount());
+  }
+  mock::removeTicker(onGateTick, &gate);
+
+  std::vector<uint32_t> sorted = gate.latencyUs;
+  std::sort(sorted.begin(), sorted.end());
+  double minutes = (gate.lastAdmittedUs - started) / 60e6;
+  report.admittedPerMin = minutes > 0 ? gate.latencyUs.size() / minutes : 0;
+  report.p50Ms = percentileMs(sorted, 0.50);
+  report.p95Ms = percentileMs(sorted, 0.95);
+  report.p99Ms = percentileMs(sorted, 0.99);
+  report.maxMs = sorted.empty() ? 0 : sorted.back() / 1000;
+  report.maxWaiting = gate.maxWaiting;
+
+  printf("[GATE] %s: %u/%u admitted, %.1f/min, touch -> LCD p50 %lu ms, p95 %lu ms, p99 %lu ms, "
+         "max %lu ms, %u retries\n",
+         label, (unsigned)gate.latencyUs.size(), (unsigned)gate.order.size(), report.admittedPerMin,
+         (unsigned long)report.p50Ms, (unsigned long)report.p95Ms, (unsigned long)report.p99Ms,
+         (unsigned long)report.maxMs, (unsigned)gate.retries);
+  printf("[GATE] %s: queue max %u waiting, outbox max %u, log staged max %u, "
+         "%u SMS sent, %u SMS refused (outbox full), %u SMS dropped, %u log records dropped\n",
+         label, (unsigned)report.maxWaiting, (unsigned)report.maxOutbox, (unsigned)report.maxLogStaged,
+         (unsigned)modem_->sent().size(), (unsigned)system_->getOutbox()->rejectedCount(),
+         (unsigned)system_->getOutbox()->droppedCount(),
+         (unsigned)system_->getAccessLog()->droppedCount());
+  return report;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+// ----------------------
+// TESTS
+// ----------------------
+void test_single_student() {
+  boot(0);
+  scheduleStudents(1, 0, 7);
+  GateReport report = runGate("single", 10000);
+  TEST_ASSERT_EQUAL_UINT32(1, gate.latencyUs.size());
+  TEST_ASSERT_TRUE(report.p50Ms < GATE_BUDGET_P50_MS);
+  TEST_ASSERT_EQUAL_UINT32(1, system_->getAccessLog()->count());
+}
+
+void test_morning_rush() {
+  // 400 students in 20 minutes; a false reject costs the held finger a second scan
+  boot(2);
+  scheduleStudents(STUDENTS, 20 * 60000UL, 2025);
+  GateReport report = runGate("rush", 30 * 60000UL);
+
+  TEST_ASSERT_EQUAL_UINT32(STUDENTS, gate.latencyUs.size());
+  TEST_ASSERT_TRUE(report.admittedPerMin >= GATE_BUDGET_RUSH_PER_MIN);
+  TEST_ASSERT_TRUE(report.p50Ms <= GATE_BUDGET_P50_MS);
+  TEST_ASSERT_TRUE(report.p99Ms <= GATE_BUDGET_P99_MS);
+  TEST_ASSERT_TRUE(report.maxWaiting <= GATE_BUDGET_MAX_WAITING);
+  TEST_ASSERT_TRUE(report.maxOutbox <= GATE_BUDGET_MAX_OUTBOX);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getOutbox()->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getOutbox()->droppedCount());
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getDigest()->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getAccessLog()->droppedCount());
+  TEST_ASSERT_EQUAL_UINT32(0, sensor_->missedTouches());
+}
+
+void test_capacity() {
+  // Everyone already in line: how fast can one device admit them?
+  boot(0);
+  scheduleStudents(120, 0, 11);
+  GateReport report = runGate("capacity", 15 * 60000UL);
+
+  TEST_ASSERT_EQUAL_UINT32(120, gate.latencyUs.size());
+  TEST_ASSERT_TRUE(report.admittedPerMin >= GATE_BUDGET_CAPACITY_PER_MIN);
+  TEST_ASSERT_TRUE(report.p99Ms <= GATE_BUDGET_P99_MS);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getOutbox()->rejectedCount());
+}
+
+int main(int argc, char** argv) {
+  Serial.captureTx = false;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_single_student);
+  RUN_TEST(test_morning_rush);
+  RUN_TEST(test_capacity);
+  return UNITY_END();
+}
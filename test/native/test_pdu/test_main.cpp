@@ -0,0 +1,108 @@
+/**
+ * @file test_main.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief SmsPdu against known PDU vectors
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * The single-part vector is the usual "hellohello" SMS-SUBMIT example. The
+ * concatenated vectors were packed by hand: a 6-octet header ends on bit
+ * 48, so the text starts after one fill bit at septet 7. Round trips turn
+ * each SMS-SUBMIT into the SMS-DELIVER the recipient would get and decode it.
+ */
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "SmsPdu.h"
+
+static const char* const NUMBER = "+46708251358";
+
+// 32 x "hello" + "hellohello": 170 septets, so 153 + 17 in two parts
+static std::string longText() {
+  std::string text;
+  for (int i = 0; i < 32; i++) text += "hello";
+  return text + "hellohello";
+}
+
+// SMS-SUBMIT hex ("00" SMSC prefix) -> SMS-DELIVER hex from the same number
+static std::string submitToDeliver(const char* submit) {
+  std::string hex(submit + 2);                     // Drop the SMSC prefix
+  bool udhi = hex.compare(0, 2, "41") == 0;
+  size_t digits = std::stoul(hex.substr(4, 2), nullptr, 16);
+  size_t address = 4 + ((digits + 1) / 2) * 2;      // Length, type, BCD digits
+  std::string deliver = "00";                        // No SMSC
+  deliver += udhi ? "44" : "04";                     // SMS-DELIVER, more-messages-to-send off
+  deliver += hex.substr(4, address);                 // OA = the DA
+  deliver += hex.substr(4 + address, 4);             // TP-PID, TP-DCS
+  deliver += "52118270512423";                       // TP-SCTS 25/11/28 07:15:42 +08
+  deliver += hex.substr(8 + address);                // TP-UDL and user data
+  return deliver;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_single_part_vector() {
+  char hex[SMS_PDU_HEX_MAX + 1];
+  TEST_ASSERT_EQUAL_UINT8(1, smsPartCount("hellohello"));
+  TEST_ASSERT_EQUAL_UINT8(22, smsEncodePdu(NUMBER, "hellohello", 0, 1, 0, hex, sizeof(hex)));
+  TEST_ASSERT_EQUAL_STRING("0001000B916407281553F800000AE8329BFD4697D9EC37", hex);
+}
+
+void test_concatenated_fill_bit() {
+  std::string text = longText();
+  char hex[SMS_PDU_HEX_MAX + 1];
+  TEST_ASSERT_EQUAL_UINT8(2, smsPartCount(text.c_str()));
+
+  // Part 1: UDL 160 = 7 header septets + 153; 'h' << 1 is the first text octet
+  TEST_ASSERT_EQUAL_UINT8(153, smsEncodePdu(NUMBER, text.c_str(), 0, 2, 0x2A, hex, sizeof(hex)));
+  TEST_ASSERT_EQUAL_UINT32(2 + 153 * 2, strlen(hex));
+  std::string head(hex, 58);
+  TEST_ASSERT_EQUAL_STRING("0041000B916407281553F80000A00500032A0201D06536FB8D2EB3D96F", head.c_str());
+  TEST_ASSERT_EQUAL_STRING("4697D9", hex + strlen(hex) - 6);
+
+  // Part 2: "lohellohello..." after the same header
+  TEST_ASSERT_EQUAL_UINT8(34, smsEncodePdu(NUMBER, text.c_str(), 1, 2, 0x2A, hex, sizeof(hex)));
+  TEST_ASSERT_EQUAL_STRING("0041000B916407281553F80000180500032A0202D86F7499CD7EA3CB6CF61B5D66B3DF", hex);
+
+  TEST_ASSERT_EQUAL_UINT8(0, smsEncodePdu(NUMBER, text.c_str(), 2, 2, 0x2A, hex, sizeof(hex)));
+}
+
+void test_decode_round_trip() {
+  char hex[SMS_PDU_HEX_MAX + 1];
+  char number[20];
+  char text[400];
+
+  TEST_ASSERT_TRUE(smsEncodePdu(NUMBER, "hellohello", 0, 1, 0, hex, sizeof(hex)) > 0);
+  TEST_ASSERT_TRUE(smsDecodePdu(submitToDeliver(hex).c_str(), number, sizeof(number), text, sizeof(text)));
+  TEST_ASSERT_EQUAL_STRING(NUMBER, number);
+  TEST_ASSERT_EQUAL_STRING("hellohello", text);
+
+  // Each part decodes on its own once its header is skipped
+  std::string joined;
+  std::string original = longText();
+  for (uint8_t i = 0; i < 2; i++) {
+    TEST_ASSERT_TRUE(smsEncodePdu(NUMBER, original.c_str(), i, 2, 0x2A, hex, sizeof(hex)) > 0);
+    TEST_ASSERT_TRUE(smsDecodePdu(submitToDeliver(hex).c_str(), number, sizeof(number), text, sizeof(text)));
+    joined += text;
+  }
+  TEST_ASSERT_EQUAL_STRING(original.c_str(), joined.c_str());
+
+  // Extension-table and UCS2 characters
+  const char* const samples[] = {"Fee: 50\xE2\x82\xAC [paid]", "Pumasok na si Ni\xC3\xB1o \xE2\x9C\x93"};
+  for (const char* sample : samples) {
+    TEST_ASSERT_TRUE(smsEncodePdu(NUMBER, sample, 0, 1, 0, hex, sizeof(hex)) > 0);
+    TEST_ASSERT_TRUE(smsDecodePdu(submitToDeliver(hex).c_str(), number, sizeof(number), text, sizeof(text)));
+    TEST_ASSERT_EQUAL_STRING(sample, text);
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_part_vector);
+  RUN_TEST(test_concatenated_fill_bit);
+  RUN_TEST(test_decode_round_trip);
+  return UNITY_END();
+}
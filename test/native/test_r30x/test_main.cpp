@@ -0,0 +1,286 @@
+/**
+ * @file test_main.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief The scan path of the library against the R30x sensor emulator
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * verifyFingerprint() runs getImage -> image2Tz -> search over the real
+ * packet protocol, with sensor timings on the virtual clock. The gate-rush
+ * test prints
+ *   [SCAN] <touches> touches, <hold> ms down, <gap> ms apart: <n> scans/min, ...
+ * so changes to the scan path can be compared without a sensor.
+ */
+#include <unity.h>
+#include <Arduino.h>
+#include <MockHost.h>
+#include <LittleFS.h>
+#include <R30xEmulator.h>
+#include <SystemFixture.h>
+#include "FingerprintLink.h"
+#include "Fingerprint_GSM.h"
+
+static const uint16_t ENROLLED = 200;
+
+static HardwareSerial fpSerial(2);
+static HardwareSerial gsmSerial(1);
+static FingerprintGSM* system_ = nullptr;
+static R30xEmulator* sensor_ = nullptr;
+
+static void boot(const R30xConfig& config) {
+  mock::freshBoot(system_, &fpSerial, &gsmSerial);
+  delete sensor_;
+  sensor_ = new R30xEmulator(&fpSerial, config);
+  sensor_->enrollRange(1, ENROLLED);
+  TEST_ASSERT_TRUE(system_->beginFingerprint(57600, 16, 17));
+}
+
+// Call verifyFingerprint() until it reports something other than "no finger"
+static int scanUntilResult(uint32_t timeoutMs) {
+  uint64_t end = mock::nowUs() + (uint64_t)timeoutMs * 1000;
+  while (mock::nowUs() < end) {
+    int id = system_->verifyFingerprint();
+    if (id != -1) return id;
+  }
+  return -1;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_parameters() {
+  boot(R30xConfig());
+  TEST_ASSERT_EQUAL_UINT32(ENROLLED, system_->getTemplateCount());
+}
+
+void test_known_finger() {
+  boot(R30xConfig());
+  sensor_->touch(R30xEmulator::fingerFor(42), 1000, 300);
+  TEST_ASSERT_EQUAL_INT(42, scanUntilResult(2000));
+  TEST_ASSERT_EQUAL_UINT32(1, sensor_->stats().served);
+}
+
+void test_stranger() {
+  boot(R30xConfig());
+  sensor_->touch(R30xEmulator::strangerFinger(1), 1000);
+  TEST_ASSERT_EQUAL_INT(-2, scanUntilResult(2000));
+  TEST_ASSERT_EQUAL_UINT32(0, sensor_->stats().matches);
+}
+
+void test_no_finger() {
+  boot(R30xConfig());
+  TEST_ASSERT_EQUAL_INT(-1, system_->verifyFingerprint());
+  TEST_ASSERT_EQUAL_UINT32(1, sensor_->stats().idleImages);
+  TEST_ASSERT_EQUAL_UINT32(0, sensor_->stats().searches);
+}
+
+void test_template_round_trip() {
+  // Upload a captured template, download it to the other buffer and compare
+  boot(R30xConfig());
+  Adafruit_Fingerprint finger(&fpSerial);
+  FingerprintLink link(&fpSerial);
+  link.setPacketSize(128);
+
+  sensor_->touch(R30xEmulator::fingerFor(7), 2000);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, finger.getImage());
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, finger.image2Tz(1));
+
+  uint8_t data[FingerprintLink::TEMPLATE_SIZE];
+  uint16_t length = 0;
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, link.uploadChar(1, data, sizeof(data), &length));
+  TEST_ASSERT_EQUAL_UINT32(R30xEmulator::TEMPLATE_SIZE, length);
+  TEST_ASSERT_EQUAL_UINT32(R30xEmulator::fingerFor(7), R30xEmulator::keyOf(data, length));
+
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, link.downloadChar(2, data, length));
+  uint16_t score = 0;
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, link.match(&score));
+  TEST_ASSERT_TRUE(score > 0);
+
+  // Ranged search only looks where it is told
+  uint16_t slot;
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, link.search(1, 0, 10, &slot, &score));
+  TEST_ASSERT_EQUAL_UINT32(7, slot);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_NOTFOUND, link.search(1, 8, 100, &slot, &score));
+}
+
+void test_false_rejects() {
+  R30xConfig config;
+  config.falseRejectPercent = 30;
+  boot(config);
+  sensor_->scriptRush(100, 1000, 800, 100);
+
+  uint32_t granted = 0;
+  uint32_t denied = 0;
+  while (mock::nowUs() < sensor_->scriptEndUs()) {
+    int id = system_->verifyFingerprint();
+    if (id > 0) granted++;
+    if (id == -2) denied++;
+  }
+  // Every finger was enrolled; the denials are the injected rejects
+  TEST_ASSERT_TRUE(denied > 0);
+  TEST_ASSERT_TRUE(granted > denied);
+}
+
+static void rush(uint32_t touches, uint32_t gapMs, uint32_t holdMs) {
+  boot(R30xConfig());
+  sensor_->scriptRush(touches, gapMs, holdMs, 80);
+  uint64_t started = mock::nowUs();
+  while (mock::nowUs() < sensor_->scriptEndUs()) system_->verifyFingerprint();
+
+  const R30xStats& s = sensor_->stats();
+  double minutes = (sensor_->scriptEndUs() - started) / 60e6;
+  printf("[SCAN] %u touches, %u ms down, %u ms apart: %.1f scans/min, touch -> result avg %lu ms, max %lu ms, "
+         "%u missed\n",
+         (unsigned)touches, (unsigned)holdMs, (unsigned)gapMs, s.served / minutes,
+         (unsigned long)(s.served > 0 ? s.latencySumUs / s.served / 1000 : 0),
+         (unsigned long)(s.latencyMaxUs / 1000), (unsigned)sensor_->missedTouches());
+}
+
+void test_gate_rush() {
+  // A queue of students, one finger every 1.5 s, each held for 0.7 s
+  rush(120, 800, 700);
+  TEST_ASSERT_EQUAL_UINT32(0, sensor_->missedTouches());
+  TEST_ASSERT_EQUAL_UINT32(120, sensor_->stats().served);
+
+  // Quick taps, shorter than one capture: some are never seen
+  rush(120, 300, 100);
+  TEST_ASSERT_TRUE(sensor_->missedTouches() > 0);
+}
+
+// One short touch; returns once the finger has lifted again
+static int scanTouch(uint32_t finger) {
+  sensor_->touch(finger, 600, 200);
+  int id = scanUntilResult(2000);
+  while (mock::nowUs() < sensor_->scriptEndUs()) mock::advanceUs(1000);
+  return id;
+}
+
+// Average STAGE_SEARCH time over one touch of each of first..first+count-1
+static uint32_t searchAverageUs(uint16_t first, uint16_t count) {
+  system_->getLatencyStats()->reset();
+  for (uint16_t id = first; id < first + count; id++) {
+    TEST_ASSERT_EQUAL_INT(id, scanTouch(R30xEmulator::fingerFor(id)));
+  }
+  return system_->getLatencyStats()->averageUs(LatencyStats::STAGE_SEARCH);
+}
+
+void test_hot_range() {
+  boot(R30xConfig());
+  // The class expected now was enrolled as 150..169
+  uint32_t fullUs = searchAverageUs(150, 20);
+  system_->setHotRange(150, 20);
+  uint32_t hotUs = searchAverageUs(150, 20);
+  printf("[SCAN] search avg: whole library %lu ms, 20-slot hot range %lu ms\n",
+         (unsigned long)(fullUs / 1000), (unsigned long)(hotUs / 1000));
+  TEST_ASSERT_TRUE(hotUs * 3 < fullUs);
+
+  // Everyone else is still found, after the hot range missed
+  TEST_ASSERT_EQUAL_INT(5, scanTouch(R30xEmulator::fingerFor(5)));
+  TEST_ASSERT_EQUAL_INT(-2, scanTouch(R30xEmulator::strangerFinger(3)));
+}
+
+// Whether the template of `id` sits in slots 0..count-1
+static bool inHotRegion(uint16_t id, uint16_t count) {
+  for (uint16_t slot = 0; slot < count; slot++) {
+    if (sensor_->slotKey(slot) == R30xEmulator::fingerFor(id)) return true;
+  }
+  return false;
+}
+
+void test_hot_paging() {
+  mock::nvsErase();
+  LittleFS.format();
+  boot(R30xConfig());
+  TEST_ASSERT_TRUE(system_->beginTemplatePaging());
+  system_->setHotRange(0, 32);
+
+  uint16_t expected[20];
+  for (uint16_t i = 0; i < 20; i++) expected[i] = 101 + i;
+  system_->setTemplateSchedule(expected, 20);
+  for (uint16_t i = 0; i < 40; i++) system_->poll();
+  for (uint16_t i = 0; i < 20; i++) TEST_ASSERT_TRUE(inHotRegion(expected[i], 32));
+
+  // A student who was not expected is found, then moved in while idle
+  TEST_ASSERT_EQUAL_INT(50, scanTouch(R30xEmulator::fingerFor(50)));
+  TEST_ASSERT_FALSE(inHotRegion(50, 32));
+  system_->poll();
+  TEST_ASSERT_TRUE(inHotRegion(50, 32));
+
+  TEST_ASSERT_EQUAL_INT(110, scanTouch(R30xEmulator::fingerFor(110)));
+  TEST_ASSERT_EQUAL_INT(50, scanTouch(R30xEmulator::fingerFor(50)));
+}
+
+void test_pager_map_writes() {
+  mock::nvsErase();
+  LittleFS.format();
+  boot(R30xConfig());
+  TEST_ASSERT_TRUE(system_->beginTemplatePaging());
+  system_->setHotRange(0, 32);
+
+  // A piece is marked dirty in NVS before its first slot changes; the map
+  // itself is written once quiet
+  uint32_t writes = mock::nvsWrites();
+  TEST_ASSERT_EQUAL_INT(50, scanTouch(R30xEmulator::fingerFor(50)));
+  system_->poll();
+  TEST_ASSERT_TRUE(inHotRegion(50, 32));
+  uint32_t marked = mock::nvsWrites();
+  TEST_ASSERT_TRUE(marked > writes);
+  system_->poll();
+  TEST_ASSERT_EQUAL_UINT32(marked, mock::nvsWrites());
+  mock::advanceUs(TemplatePager::MAP_FLUSH_MS * 1000ULL);
+  system_->poll();
+  uint32_t flushed = mock::nvsWrites();
+  TEST_ASSERT_TRUE(flushed > marked);
+  system_->poll();
+  TEST_ASSERT_EQUAL_UINT32(flushed, mock::nvsWrites());
+
+  // Power is cut right after a scan pages 60 in, before any poll()
+  TEST_ASSERT_EQUAL_INT(60, scanTouch(R30xEmulator::fingerFor(60)));
+  mock::powerCycle(system_, &fpSerial, &gsmSerial);
+  TEST_ASSERT_TRUE(system_->beginFingerprint(57600, 16, 17));
+  TEST_ASSERT_TRUE(system_->beginTemplatePaging());
+
+  // The slots that changed were emptied: never a wrong ID, and the
+  // fallback reaches 60 over a few tries without writing to NVS
+  writes = mock::nvsWrites();
+  int id = -2;
+  for (uint8_t tries = 0; tries < 10 && id == -2; tries++) {
+    id = scanTouch(R30xEmulator::fingerFor(60));
+  }
+  TEST_ASSERT_EQUAL_INT(60, id);
+  TEST_ASSERT_EQUAL_UINT32(writes, mock::nvsWrites());
+}
+
+void test_touch_pin() {
+  boot(R30xConfig());
+  sensor_->setTouchPin(4, true);
+  system_->enableTouchWake(4, true);
+
+  sensor_->touch(R30xEmulator::fingerFor(9), 800, 5000);
+  TEST_ASSERT_EQUAL_INT(9, scanUntilResult(7000));
+  // While idle the sensor was only asked on the slow safety poll
+  TEST_ASSERT_TRUE(sensor_->stats().idleImages < 10);
+  TEST_ASSERT_EQUAL_UINT32(1, system_->getTouchStats().wakeups);
+}
+
+int main(int argc, char** argv) {
+  Serial.captureTx = false;
+  gsmSerial.captureTx = false;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_parameters);
+  RUN_TEST(test_known_finger);
+  RUN_TEST(test_stranger);
+  RUN_TEST(test_no_finger);
+  RUN_TEST(test_template_round_trip);
+  RUN_TEST(test_false_rejects);
+  RUN_TEST(test_gate_rush);
+  RUN_TEST(test_touch_pin);
+  RUN_TEST(test_hot_range);
+  RUN_TEST(test_hot_paging);
+  RUN_TEST(test_pager_map_writes);
+  return UNITY_END();
+}
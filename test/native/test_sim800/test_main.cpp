@@ -0,0 +1,450 @@
+/**
+ * @file test_main.cpp
+ * @author Jayrold Langcay, Angelo Corpuz
+ * @brief The GSM side of the library against the SIM800L emulator
+ * @version 0.1
+ * @date 2025-11-28
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Each test boots a FingerprintGSM on a fresh emulator and drives poll()
+ * in 1 ms steps of virtual time, so minutes of network latency and retry
+ * backoff run in well under a second. The load test prints
+ *   [LOAD] <offered> msg/min offered, <sent> msg/min sent, ...
+ * for the notification pipeline from sendAccessNotification() to +CMGS.
+ */
+#include <unity.h>
+#include <Arduino.h>
+#include <MockHost.h>
+#include <Preferences.h>
+#include <Sim800Emulator.h>
+#include <SystemFixture.h>
+#include <esp_partition.h>
+#include "Fingerprint_GSM.h"
+
+static const char* const ADMIN = "+639170000001";
+static const uint16_t USERS = 20;
+
+static HardwareSerial fpSerial(2);
+static HardwareSerial gsmSerial(1);
+static FingerprintGSM* system_ = nullptr;
+static Sim800Emulator* modem_ = nullptr;
+
+static void boot(const Sim800Config& config, bool pduMode) {
+  mock::freshBoot(system_, &fpSerial, &gsmSerial);
+  mock::partitionCreate("users", 0x41, 0x60000);
+  mock::partitionCreate("outbox", 0x42, 0x8000);
+  delete modem_;
+  modem_ = new Sim800Emulator(&gsmSerial, config);
+  system_->setPduMode(pduMode);
+  system_->setAdminPhone(ADMIN);
+  TEST_ASSERT_TRUE(system_->beginUsers("users"));
+
+  char name[USER_NAME_MAX];
+  char phone[USER_PHONE_MAX];
+  for (uint16_t id = 1; id <= USERS; id++) {
+    snprintf(name, sizeof(name), "Student %02u", id);
+    snprintf(phone, sizeof(phone), "+6391712%05u", id);
+    TEST_ASSERT_TRUE(system_->addUser(id, name, phone, true, "Grade 7"));
+  }
+  TEST_ASSERT_TRUE(system_->beginGSM(9600, 16, 17));
+}
+
+static void runFor(uint32_t ms) {
+  uint64_t end = mock::nowUs() + (uint64_t)ms * 1000;
+  while (mock::nowUs() < end) {
+    system_->poll();
+    mock::advanceUs(1000);
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_begin_configures_modem() {
+  boot(Sim800Config(), true);
+  TEST_ASSERT_TRUE(modem_->pduMode());
+  TEST_ASSERT_FALSE(modem_->echoOn());
+  TEST_ASSERT_EQUAL_STRING("AT+CNMI=2,2,0,0,0", modem_->lastCommand().c_str());
+}
+
+void test_text_mode_sms() {
+  boot(Sim800Config(), false);
+  TEST_ASSERT_TRUE(system_->sendSMS(ADMIN, "Hello from the gate") != 0);
+  runFor(5000);
+
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->sent().size());
+  TEST_ASSERT_FALSE(modem_->sent()[0].pdu);
+  TEST_ASSERT_EQUAL_STRING(ADMIN, modem_->sent()[0].number.c_str());
+  TEST_ASSERT_EQUAL_STRING("Hello from the gate", modem_->sent()[0].payload.c_str());
+}
+
+void test_pdu_notification() {
+  boot(Sim800Config(), true);
+  // Admin notice plus the student's own
+  TEST_ASSERT_TRUE(system_->sendAccessNotification(3, true));
+  runFor(15000);
+
+  // A wrong AT+CMGS length would have been rejected with +CMS ERROR: 304
+  TEST_ASSERT_EQUAL_UINT32(2, modem_->sent().size());
+  TEST_ASSERT_EQUAL_UINT32(0, modem_->rejectedCount());
+  TEST_ASSERT_TRUE(modem_->sent()[0].pdu);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getPendingSMSCount());
+}
+
+void test_multipart_all_or_nothing() {
+  boot(Sim800Config(), true);
+  std::string text;
+  for (int i = 0; i < 15; i++) text += "Attendance report ";  // 270 septets, two parts
+  // Three single SMS leave one modem slot, too few for the two parts
+  for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(system_->sendSMS(ADMIN, "Hello from the gate") != 0);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->sendSMS(ADMIN, text.c_str()));
+  runFor(20000);
+  TEST_ASSERT_EQUAL_UINT32(3, modem_->sent().size());
+
+  TEST_ASSERT_TRUE(system_->sendSMS(ADMIN, text.c_str()) != 0);
+  runFor(20000);
+  TEST_ASSERT_EQUAL_UINT32(5, modem_->sent().size());
+}
+
+void test_digest_lines() {
+  boot(Sim800Config(), false);
+  system_->setDigestMode(true, 60000, 2);
+  TEST_ASSERT_TRUE(system_->sendAccessNotification(3, true));
+  TEST_ASSERT_TRUE(system_->sendAccessNotification(4, true));
+  runFor(20000);
+
+  // Two events fill the digest: one admin SMS with "name, grade, time" lines
+  bool found = false;
+  for (size_t i = 0; i < modem_->sent().size(); i++) {
+    const std::string& text = modem_->sent()[i].payload;
+    if (modem_->sent()[i].number != ADMIN) continue;
+    found = text.find("Student 03, Grade 7, ") != std::string::npos &&
+            text.find("Student 04, Grade 7, ") != std::string::npos;
+  }
+  TEST_ASSERT_TRUE(found);
+
+  // A full digest goes out before maxEvents; no line is turned away
+  system_->setDigestMode(true, 600000, 20);
+  for (uint16_t id = 1; id <= USERS; id++) TEST_ASSERT_TRUE(system_->sendAccessNotification(id, true));
+  SmsDigest* digest = system_->getDigest();
+  TEST_ASSERT_TRUE(digest->pendingEvents() > 0 && digest->pendingEvents() < USERS);
+  TEST_ASSERT_EQUAL_UINT32(0, digest->rejectedCount());
+}
+
+void test_report_other_grade() {
+  boot(Sim800Config(), false);
+  // Nine more grades: the table keeps eight, Grade 9 and Grade 10 become "Other"
+  const char* const grades[] = {"Grade 1", "Grade 2", "Grade 3", "Grade 4", "Grade 5",
+                                "Grade 6", "Grade 8", "Grade 9", "Grade 10"};
+  char name[USER_NAME_MAX];
+  for (uint16_t i = 0; i < 9; i++) {
+    snprintf(name, sizeof(name), "Student %02u", USERS + 1 + i);
+    TEST_ASSERT_TRUE(system_->addUser(USERS + 1 + i, name, "", false, grades[i]));
+  }
+  TEST_ASSERT_TRUE(system_->beginReport(9, 0, 7, 30));
+  // Without an RTC the epoch is uptime, and PresenceIndex takes day 0 as "no day"
+  mock::advanceUs(86400ULL * 1000000);
+  for (uint16_t id = 1; id <= USERS; id++) system_->getPresence()->mark(id, millis() / 1000);
+  system_->sendReportNow();
+  runFor(20000);
+
+  // Text mode sends it as "(k/n) " parts; join them back
+  std::string report;
+  for (size_t i = 0; i < modem_->sent().size(); i++) {
+    const std::string& part = modem_->sent()[i].payload;
+    report += part[0] == '(' ? part.substr(part.find(") ") + 2) : part;
+  }
+  TEST_ASSERT_TRUE(report.find("Grade 7: 20/20 in") != std::string::npos);
+  TEST_ASSERT_TRUE(report.find("Grade 8: 0/1 in, 0 late\nAbsent: Student 27\n") != std::string::npos);
+  TEST_ASSERT_TRUE(report.find("Other: 0/2 in, 0 late\nAbsent: Student 28, Student 29") != std::string::npos);
+}
+
+void test_report_more_absent() {
+  boot(Sim800Config(), false);
+  // 60 absentees of 14-15 characters each are more than one report holds
+  char name[USER_NAME_MAX];
+  for (uint16_t id = USERS + 1; id <= USERS + 40; id++) {
+    snprintf(name, sizeof(name), "Student %02u", id);
+    TEST_ASSERT_TRUE(system_->addUser(id, name, "", false, "Grade 7"));
+  }
+  TEST_ASSERT_TRUE(system_->beginReport(9, 0, 7, 30));
+  mock::advanceUs(86400ULL * 1000000);
+  system_->sendReportNow();
+  runFor(30000);
+
+  std::string report;
+  for (size_t i = 0; i < modem_->sent().size(); i++) {
+    const std::string& part = modem_->sent()[i].payload;
+    report += part[0] == '(' ? part.substr(part.find(") ") + 2) : part;
+  }
+  TEST_ASSERT_TRUE(report.find("Grade 7: 0/60 in, 0 late\nAbsent: Student 01, Student 02") != std::string::npos);
+  size_t more = report.find(" more");
+  TEST_ASSERT_TRUE(more != std::string::npos);
+  // Listed names and the "+n more" count add up to every absentee
+  size_t listed = 0;
+  for (size_t at = report.find("Student"); at < more; at = report.find("Student", at + 1)) listed++;
+  size_t plus = report.rfind('+', more);
+  TEST_ASSERT_EQUAL_UINT32(60, listed + std::stoul(report.substr(plus + 1, more - plus - 1)));
+}
+
+void test_report_waits_for_outbox() {
+  Sim800Config config;
+  config.networkLatencyMs = 1000;
+  boot(config, false);
+  TEST_ASSERT_TRUE(system_->beginReport(9, 0, 7, 30));
+  mock::advanceUs(86400ULL * 1000000);
+  SmsOutbox* outbox = system_->getOutbox();
+  outbox->setDrainEnabled(false);
+  while (outbox->size() < outbox->capacity()) TEST_ASSERT_TRUE(outbox->append(ADMIN, "Filler"));
+
+  system_->sendReportNow();
+  runFor(5000);
+  TEST_ASSERT_EQUAL_UINT32(0, outbox->rejectedCount());  // Waited rather than tried
+
+  // Once there is room the report follows the backlog
+  outbox->setDrainEnabled(true);
+  runFor(120000);
+  TEST_ASSERT_EQUAL_UINT32(0, outbox->size());
+  // Two "(k/n) " parts in text mode
+  TEST_ASSERT_EQUAL_UINT32(outbox->capacity() + 2, modem_->sent().size());
+  TEST_ASSERT_EQUAL_UINT32(6, modem_->sent()[outbox->capacity()].payload.find("Attendance"));
+}
+
+void test_make_call() {
+  boot(Sim800Config(), true);
+  TEST_ASSERT_TRUE(system_->makeCall("+639171234567"));
+  runFor(1000);
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->dialed().size());
+  TEST_ASSERT_EQUAL_STRING("+639171234567", modem_->dialed()[0].c_str());
+}
+
+void test_incoming_command() {
+  boot(Sim800Config(), true);
+  TEST_ASSERT_TRUE(modem_->deliverSms(ADMIN, "HELP"));
+  runFor(10000);
+
+  TEST_ASSERT_EQUAL_UINT32(1, system_->getSmsCommands()->handledCount());
+  TEST_ASSERT_EQUAL_STRING("HELP", system_->readSMS());
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->sent().size());
+
+  // Strangers are not answered
+  TEST_ASSERT_TRUE(modem_->deliverSms("+639999999999", "STATUS"));
+  runFor(10000);
+  TEST_ASSERT_EQUAL_UINT32(1, system_->getSmsCommands()->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->sent().size());
+
+  // Nor is anything that is not a command, even from a guardian
+  TEST_ASSERT_TRUE(modem_->deliverSms("+639171200001", "Auto-reply: I am away until Monday"));
+  runFor(10000);
+  TEST_ASSERT_EQUAL_UINT32(2, system_->getSmsCommands()->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(1, system_->getSmsCommands()->handledCount());
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->sent().size());
+}
+
+void test_sms_text_is_not_a_reply() {
+  boot(Sim800Config(), false);
+  SmsHandle handle = system_->sendSMS(ADMIN, "Hello from the gate");
+  TEST_ASSERT_TRUE(handle != 0);
+  // Arrives while AT+CMGS waits for the network, and reads like its answer
+  TEST_ASSERT_TRUE(modem_->deliverSms(ADMIN, "hi\n\n+CMGS: 5\n\nOK"));
+  runFor(1000);
+  TEST_ASSERT_EQUAL_UINT8(SMS_SENDING, system_->getSmsStatus(handle));
+
+  runFor(5000);
+  TEST_ASSERT_EQUAL_UINT8(SMS_SENT, system_->getSmsStatus(handle));
+  TEST_ASSERT_EQUAL_STRING("hi\n\n+CMGS: 5\n\nOK", system_->readSMS());
+}
+
+void test_retry_after_cms_error() {
+  Sim800Config config;
+  config.networkLatencyMs = 1000;
+  boot(config, true);
+  modem_->failNext(2);
+  TEST_ASSERT_TRUE(system_->sendSMS(ADMIN, "x") != 0);  // Straight to the modem: no retry
+  TEST_ASSERT_TRUE(system_->sendEnrollmentNotification(5, "Student 05"));
+  runFor(60000);
+
+  // The direct send and the first outbox attempt fail; backoff retries the latter
+  TEST_ASSERT_EQUAL_UINT32(2, modem_->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->sent().size());
+  // Second try after BACKOFF_BASE
+  TEST_ASSERT_TRUE(modem_->sent()[0].acceptedUs >= (uint64_t)SmsOutbox::BACKOFF_BASE * 1000);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getPendingSMSCount());
+}
+
+void test_registration_loss() {
+  Sim800Config config;
+  config.networkLatencyMs = 1000;
+  boot(config, true);
+  modem_->loseRegistrationFor(60000);
+  for (uint16_t id = 1; id <= 3; id++) TEST_ASSERT_TRUE(system_->sendAccessNotification(id, true));
+
+  runFor(50000);
+  TEST_ASSERT_EQUAL_UINT32(0, modem_->sent().size());
+  TEST_ASSERT_TRUE(modem_->rejectedCount() > 0);
+  TEST_ASSERT_FALSE(modem_->deliverSms(ADMIN, "STATUS"));  // Nothing reaches it either
+
+  // Back on the network: the outbox works through its backlog
+  runFor(600000);
+  TEST_ASSERT_TRUE(modem_->registered());
+  TEST_ASSERT_EQUAL_UINT32(6, modem_->sent().size());
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getPendingSMSCount());
+}
+
+void test_outbox_survives_reboot() {
+  Sim800Config config;
+  config.networkLatencyMs = 1000;
+  boot(config, true);
+  // Enough traffic first that the ring has wrapped
+  for (uint16_t i = 0; i < 80; i++) {
+    TEST_ASSERT_TRUE(system_->sendEnrollmentNotification(1 + i % USERS, "Student"));
+    runFor(1500);
+  }
+  runFor(30000);
+  TEST_ASSERT_EQUAL_UINT32(80, modem_->sent().size());
+
+  modem_->setRegistered(false);
+  uint32_t nvsWrites = mock::nvsWrites();
+  for (uint16_t id = 1; id <= 3; id++) TEST_ASSERT_TRUE(system_->sendAccessNotification(id, true));
+  runFor(20000);
+  TEST_ASSERT_EQUAL_UINT32(6, system_->getOutbox()->size());
+  // Queued and retried messages stay out of the shared NVS partition
+  TEST_ASSERT_EQUAL_UINT32(nvsWrites, mock::nvsWrites());
+
+  // Power cycle: the records come back from the outbox partition
+  modem_->setRegistered(true);
+  mock::powerCycle(system_, &fpSerial, &gsmSerial);
+  system_->setPduMode(true);
+  system_->setAdminPhone(ADMIN);
+  TEST_ASSERT_TRUE(system_->beginUsers("users"));
+  TEST_ASSERT_TRUE(system_->beginGSM(9600, 16, 17));
+  TEST_ASSERT_EQUAL_UINT32(6, system_->getOutbox()->size());
+
+  runFor(120000);
+  TEST_ASSERT_EQUAL_UINT32(86, modem_->sent().size());
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getOutbox()->size());
+}
+
+void test_outbox_fills_partition() {
+  Sim800Config config;
+  config.networkLatencyMs = 1000;
+  boot(config, false);
+  SmsOutbox* outbox = system_->getOutbox();
+  // 64 ring entries less the two sectors kept for moving records
+  TEST_ASSERT_EQUAL_UINT32(48, outbox->capacity());
+
+  // Twice, so the second fill wraps the ring while it is nearly full
+  char text[24];
+  for (uint8_t round = 0; round < 2; round++) {
+    outbox->setDrainEnabled(false);
+    for (uint16_t i = 0; i < outbox->capacity(); i++) {
+      snprintf(text, sizeof(text), "Queued %u.%u", round, i);
+      TEST_ASSERT_TRUE(outbox->append(ADMIN, text));
+    }
+    TEST_ASSERT_FALSE(outbox->append(ADMIN, "One too many"));
+
+    // Every text is read back from flash to be sent
+    uint32_t reads = mock::partitionBytesRead();
+    outbox->setDrainEnabled(true);
+    runFor(150000);
+    TEST_ASSERT_EQUAL_UINT32(0, outbox->size());
+    TEST_ASSERT_TRUE(mock::partitionBytesRead() - reads >= 48 * sizeof(OutboxRecord));
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(96, modem_->sent().size());
+  for (uint16_t i = 0; i < 96; i++) {
+    snprintf(text, sizeof(text), "Queued %u.%u", i / 48, i % 48);
+    TEST_ASSERT_EQUAL_STRING(text, modem_->sent()[i].payload.c_str());
+  }
+  TEST_ASSERT_EQUAL_UINT32(2, outbox->rejectedCount());
+  TEST_ASSERT_EQUAL_UINT32(0, outbox->droppedCount());
+}
+
+void test_slow_prompt() {
+  Sim800Config config;
+  config.promptDelayMs = AtEngine::PROMPT_TIMEOUT + 1000;
+  boot(config, true);
+  TEST_ASSERT_TRUE(system_->sendEnrollmentNotification(5, "Student 05"));
+  runFor(30000);
+  // Every attempt is abandoned with ESC before the prompt shows up
+  TEST_ASSERT_EQUAL_UINT32(0, modem_->sent().size());
+  TEST_ASSERT_EQUAL_UINT32(1, system_->getPendingSMSCount());
+
+  modem_->config().promptDelayMs = 20;
+  runFor(SmsOutbox::BACKOFF_MAX + 30000);
+  TEST_ASSERT_EQUAL_UINT32(1, modem_->sent().size());
+}
+
+struct LoadResult {
+  uint32_t offered;
+  uint32_t sent;
+  uint32_t queued;
+  double sentPerMinute;
+};
+
+// One granted scan every `scanIntervalMs` for `windowMs`, two messages each
+static LoadResult runLoad(uint32_t scanIntervalMs, uint32_t windowMs) {
+  Sim800Config config;
+  config.networkLatencyMs = 3000;
+  config.latencyJitterMs = 2000;
+  config.cmsErrorPercent = 5;
+  boot(config, true);
+
+  LoadResult result;
+  result.offered = 0;
+  for (uint32_t at = 0; at < windowMs; at += scanIntervalMs) {
+    if (system_->sendAccessNotification(1 + (at / scanIntervalMs) % USERS, true)) result.offered += 2;
+    runFor(scanIntervalMs);
+  }
+  result.sent = modem_->sent().size();
+  result.queued = system_->getPendingSMSCount();
+
+  double minutes = windowMs / 60000.0;
+  result.sentPerMinute = result.sent / minutes;
+  printf("[LOAD] %.1f msg/min offered, %.1f msg/min sent, %u rejected, %u queued of %u, %u refused\n",
+         result.offered / minutes, result.sentPerMinute, (unsigned)modem_->rejectedCount(),
+         (unsigned)result.queued, (unsigned)system_->getOutbox()->capacity(),
+         (unsigned)system_->getOutbox()->rejectedCount());
+  return result;
+}
+
+void test_notification_throughput() {
+  // Below capacity nothing is lost: what was not sent yet is still queued
+  LoadResult light = runLoad(10000, 600000);
+  TEST_ASSERT_EQUAL_UINT32(light.offered, light.sent + light.queued);
+
+  // Saturated: one SMS at a time, about 3-5 s each on this network. The
+  // backlog grows but stays in the flash ring.
+  LoadResult heavy = runLoad(4000, 120000);
+  TEST_ASSERT_TRUE(heavy.sentPerMinute >= 10);
+  TEST_ASSERT_TRUE(heavy.queued > 0);
+  TEST_ASSERT_EQUAL_UINT32(heavy.offered, heavy.sent + heavy.queued);
+  TEST_ASSERT_EQUAL_UINT32(0, system_->getOutbox()->rejectedCount());
+}
+
+int main(int argc, char** argv) {
+  Serial.captureTx = false;
+  fpSerial.captureTx = false;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_begin_configures_modem);
+  RUN_TEST(test_text_mode_sms);
+  RUN_TEST(test_pdu_notification);
+  RUN_TEST(test_multipart_all_or_nothing);
+  RUN_TEST(test_digest_lines);
+  RUN_TEST(test_report_other_grade);
+  RUN_TEST(test_report_more_absent);
+  RUN_TEST(test_report_waits_for_outbox);
+  RUN_TEST(test_make_call);
+  RUN_TEST(test_incoming_command);
+  RUN_TEST(test_sms_text_is_not_a_reply);
+  RUN_TEST(test_retry_after_cms_error);
+  RUN_TEST(test_registration_loss);
+  RUN_TEST(test_outbox_survives_reboot);
+  RUN_TEST(test_outbox_fills_partition);
+  RUN_TEST(test_slow_prompt);
+  RUN_TEST(test_notification_throughput);
+  return UNITY_END();
+}